@@ -0,0 +1,727 @@
+#pragma once
+/*
+ * Emulation of the subset of the ADF graph API used by the generated graph, to
+ * run a design on the CPU without the Xilinx tools. Building aie/graph.cpp and
+ * the kernel sources against this directory gives a program that behaves
+ * like the x86 simulator:
+ *
+ *   - every kernel runs on its own thread, invoked once per window of its
+ *     inputs, and nets are bounded queues between the threads (aie_emu/
+ *     channel.h);
+ *   - input PLIOs are read from their data file, relative to the working
+ *     directory, in the text format of the simulators: whitespace separated
+ *     values, lines starting with T (timestamps and TLAST) are skipped;
+ *   - output PLIOs are written to the same path under AIEBLAS_EMU_OUTPUT;
+ *   - runtime parameters keep the value of the last update.
+ *
+ * A kernel stops when it ran the requested number of iterations or when an
+ * input has no data left, so run(-1) ends once the data files are consumed.
+ * A graph runs once, the placement and runtime ratio are ignored.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aie_api/aie.hpp"
+#include "aie_api/aie_adf.hpp"
+#include "aie_emu/channel.h"
+
+namespace aie_emu {
+
+// Conversion of an element between its bytes and the text of a PLIO file
+struct element_format {
+    std::size_t size = 0;
+    bool (*parse)(const std::string &token, std::byte *dst) = nullptr;
+    std::string (*print)(const std::byte *src) = nullptr;
+};
+
+template <typename T>
+element_format format_of() {
+    element_format format;
+    format.size = sizeof(T);
+    format.parse = [](const std::string &token, std::byte *dst) {
+        char *end = nullptr;
+        T value;
+        if constexpr (std::is_floating_point_v<T>) {
+            value = static_cast<T>(std::strtod(token.c_str(), &end));
+        } else if constexpr (std::is_signed_v<T>) {
+            value = static_cast<T>(std::strtoll(token.c_str(), &end, 10));
+        } else {
+            value = static_cast<T>(std::strtoull(token.c_str(), &end, 10));
+        }
+        if (end == token.c_str() || *end != '\0') {
+            return false;
+        }
+        std::memcpy(dst, &value, sizeof(T));
+        return true;
+    };
+    format.print = [](const std::byte *src) {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        if constexpr (std::is_floating_point_v<T>) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.9g",
+                          static_cast<double>(value));
+            return std::string(text);
+        } else if constexpr (std::is_signed_v<T>) {
+            return std::to_string(static_cast<long long>(value));
+        } else {
+            return std::to_string(static_cast<unsigned long long>(value));
+        }
+    };
+    return format;
+}
+
+// Latest value of a runtime parameter, zero until it is updated
+class parameter_value {
+public:
+    void set(const void *src, std::size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::byte *bytes = static_cast<const std::byte *>(src);
+        value.assign(bytes, bytes + n);
+    }
+
+    void get(void *dst, std::size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::memset(dst, 0, n);
+        std::memcpy(dst, value.data(), std::min(n, value.size()));
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::byte> value;
+};
+
+enum class port_kind {
+    stream, window, parameter
+};
+
+// Argument of a kernel, in the order of its signature
+struct kernel_port {
+    bool input;
+    port_kind kind;
+    element_format format;
+    std::shared_ptr<channel> in = nullptr;
+    std::vector<std::shared_ptr<channel>> outs = {};
+    std::size_t window_bytes = 0;
+    bool async = false;
+    std::shared_ptr<parameter_value> parameter = nullptr;
+
+    bool connected() const {
+        switch (kind) {
+        case port_kind::parameter:
+            return parameter != nullptr;
+        default:
+            return input ? in != nullptr : !outs.empty();
+        }
+    }
+};
+
+struct kernel_node {
+    std::vector<kernel_port> ports;
+    std::function<void(kernel_node &, long long)> body;
+    std::string source;
+    double ratio = 1.0;
+    std::uint64_t invocations = 0;
+    std::chrono::nanoseconds busy{0};
+
+    // Input or output index of the graph API, counted separately
+    kernel_port &port(bool input, unsigned index) {
+        unsigned i = 0;
+        for (kernel_port &p : ports) {
+            if (p.input == input && i++ == index) {
+                return p;
+            }
+        }
+        throw std::runtime_error("aie emu: kernel " + source + " has no " +
+                                 (input ? "input " : "output ") +
+                                 std::to_string(index));
+    }
+
+    // Ends the nets of the kernel, so its neighbours do not wait for it
+    void finish() {
+        for (kernel_port &p : ports) {
+            if (p.in) {
+                p.in->cancel();
+            }
+            for (const std::shared_ptr<channel> &out : p.outs) {
+                out->close();
+            }
+        }
+    }
+};
+
+struct plio_node {
+    std::string name;
+    unsigned bits;
+    std::string file;
+    bool input;
+    element_format format = {};
+    std::vector<std::shared_ptr<channel>> outs = {};
+    std::shared_ptr<channel> in = nullptr;
+};
+
+// All kernels and PLIOs created by the program, which has a single graph
+struct registry {
+    std::vector<std::shared_ptr<kernel_node>> kernels;
+    std::vector<std::shared_ptr<plio_node>> plios;
+};
+
+inline registry &nodes() {
+    static registry r;
+    return r;
+}
+
+// Side of a net, a port of a kernel or of a PLIO
+struct endpoint {
+    std::shared_ptr<kernel_node> kernel;
+    std::shared_ptr<plio_node> plio;
+    bool input;
+    unsigned index;
+    bool async = false;
+};
+
+inline void wire(const endpoint &src, const endpoint &dst,
+                 std::size_t window_bytes) {
+    const port_kind kind = window_bytes == 0 ? port_kind::stream
+                                             : port_kind::window;
+    const std::size_t capacity = std::max(
+        env_size("AIEBLAS_EMU_FIFO_BYTES", 4096), 2 * window_bytes);
+    auto net = std::make_shared<channel>(capacity);
+
+    element_format format;
+    if (src.kernel) {
+        kernel_port &p = src.kernel->port(false, src.index);
+        if (p.kind != kind) {
+            throw std::runtime_error("aie emu: output " +
+                                     std::to_string(src.index) + " of " +
+                                     src.kernel->source +
+                                     " has a different kind of net");
+        }
+        p.outs.push_back(net);
+        p.window_bytes = window_bytes;
+        p.async = src.async;
+        format = p.format;
+    }
+
+    if (dst.kernel) {
+        kernel_port &p = dst.kernel->port(true, dst.index);
+        if (p.kind != kind || p.in) {
+            throw std::runtime_error("aie emu: input " +
+                                     std::to_string(dst.index) + " of " +
+                                     dst.kernel->source +
+                                     " is connected twice or to a "
+                                     "different kind of net");
+        }
+        p.in = net;
+        p.window_bytes = window_bytes;
+        p.async = dst.async;
+        format = p.format;
+    } else {
+        dst.plio->in = net;
+        dst.plio->format = format;
+    }
+
+    if (src.plio) {
+        src.plio->outs.push_back(net);
+        src.plio->format = format;
+    }
+}
+
+/*
+ * Binding of a kernel argument to its port, for the duration of a run. The
+ * argument is prepared before every invocation and completed after it.
+ */
+template <typename A>
+struct binding {
+    static kernel_port describe() {
+        return {true, port_kind::parameter, format_of<A>()};
+    }
+
+    explicit binding(kernel_port &p) : value(p.parameter) {}
+
+    void before() {
+        value->get(&current, sizeof(A));
+    }
+
+    void after() {}
+
+    A get() {
+        return current;
+    }
+
+    std::shared_ptr<parameter_value> value;
+    A current{};
+};
+
+template <typename T>
+struct binding<input_stream<T> *> {
+    static kernel_port describe() {
+        return {true, port_kind::stream, format_of<T>()};
+    }
+
+    explicit binding(kernel_port &p) : s(source(p.in)) {}
+
+    void before() {}
+    void after() {}
+
+    input_stream<T> *get() {
+        return &s;
+    }
+
+    input_stream<T> s;
+};
+
+template <typename T>
+struct binding<output_stream<T> *> {
+    static kernel_port describe() {
+        return {false, port_kind::stream, format_of<T>()};
+    }
+
+    explicit binding(kernel_port &p) : s(sink(p.outs)) {}
+
+    void before() {}
+    void after() {}
+
+    output_stream<T> *get() {
+        return &s;
+    }
+
+    output_stream<T> s;
+};
+
+template <typename T>
+struct binding<input_window<T> *> {
+    static kernel_port describe() {
+        return {true, port_kind::window, format_of<T>()};
+    }
+
+    explicit binding(kernel_port &p)
+        : w(source(p.in), p.window_bytes / sizeof(T)), async(p.async) {}
+
+    void before() {
+        if (!async) {
+            w.acquire();
+        }
+    }
+
+    void after() {
+        if (!async) {
+            w.release();
+        }
+    }
+
+    input_window<T> *get() {
+        return &w;
+    }
+
+    input_window<T> w;
+    bool async;
+};
+
+template <typename T>
+struct binding<output_window<T> *> {
+    static kernel_port describe() {
+        return {false, port_kind::window, format_of<T>()};
+    }
+
+    explicit binding(kernel_port &p)
+        : w(sink(p.outs), p.window_bytes / sizeof(T)), async(p.async) {}
+
+    void before() {
+        if (!async) {
+            w.acquire();
+        }
+    }
+
+    void after() {
+        if (!async) {
+            w.release();
+        }
+    }
+
+    output_window<T> *get() {
+        return &w;
+    }
+
+    output_window<T> w;
+    bool async;
+};
+
+template <typename... Args, std::size_t... I>
+void run_kernel(void (*fn)(Args...), kernel_node &node, long long iterations,
+                std::index_sequence<I...>) {
+    std::tuple<binding<Args>...> args(node.ports[I]...);
+    try {
+        for (long long i = 0; iterations < 0 || i < iterations; i++) {
+            (std::get<I>(args).before(), ...);
+            const auto start = std::chrono::steady_clock::now();
+            fn(std::get<I>(args).get()...);
+            node.busy += std::chrono::steady_clock::now() - start;
+            (std::get<I>(args).after(), ...);
+            node.invocations++;
+        }
+    } catch (const end_of_data &) {
+        // An input ran out of data, the graph is done
+    }
+}
+
+// Sends the values of an input PLIO file to its nets
+inline void feed(plio_node &plio, std::ifstream &file) {
+    std::vector<std::byte> element(plio.format.size);
+    std::string line, token;
+    bool consumed = true;
+    while (consumed && std::getline(file, line)) {
+        if (line.empty() || line[0] == 'T') {
+            continue;
+        }
+        std::istringstream tokens(line);
+        while (consumed && tokens >> token) {
+            if (!plio.format.parse(token, element.data())) {
+                throw std::runtime_error("aie emu: invalid value " + token +
+                                         " in " + plio.file);
+            }
+            consumed = false;
+            for (const std::shared_ptr<channel> &out : plio.outs) {
+                consumed = out->push(element.data(), element.size()) ||
+                           consumed;
+            }
+        }
+    }
+}
+
+// Writes the values received by an output PLIO, a line per beat
+inline void drain(plio_node &plio, std::ofstream &file) {
+    std::vector<std::byte> element(plio.format.size);
+    const std::size_t per_line = std::max<std::size_t>(
+        1, plio.bits / (8 * element.size()));
+    std::size_t column = 0;
+    try {
+        while (true) {
+            plio.in->pop(element.data(), element.size());
+            file << (column == 0 ? "" : " ") << plio.format.print(
+                element.data());
+            if (++column == per_line) {
+                file << '\n';
+                column = 0;
+            }
+        }
+    } catch (const end_of_data &) {
+        if (column != 0) {
+            file << '\n';
+        }
+    }
+}
+
+} // aie_emu
+
+namespace adf {
+
+enum return_code {
+    ok = 0,
+    error = 1
+};
+
+enum plio_type {
+    plio_32_bits = 32,
+    plio_64_bits = 64,
+    plio_128_bits = 128
+};
+
+// Kinds of nets and ports
+struct stream {};
+template <unsigned N> struct window {};
+struct parameter {};
+struct input {};
+struct output {};
+struct ratio {};
+
+using port_ref = aie_emu::endpoint;
+
+inline port_ref async(port_ref p) {
+    p.async = true;
+    return p;
+}
+
+class port_list {
+public:
+    port_list() = default;
+    port_list(std::shared_ptr<aie_emu::kernel_node> kernel,
+              std::shared_ptr<aie_emu::plio_node> plio, bool input)
+        : kernel(std::move(kernel)), plio(std::move(plio)), input(input) {}
+
+    port_ref operator[](unsigned index) const {
+        return {kernel, plio, input, index};
+    }
+
+private:
+    std::shared_ptr<aie_emu::kernel_node> kernel;
+    std::shared_ptr<aie_emu::plio_node> plio;
+    bool input = true;
+};
+
+class kernel {
+public:
+    template <typename... Args>
+    static kernel create(void (*fn)(Args...)) {
+        auto node = std::make_shared<aie_emu::kernel_node>();
+        node->ports = {aie_emu::binding<Args>::describe()...};
+        node->body = [fn](aie_emu::kernel_node &n, long long iterations) {
+            aie_emu::run_kernel(fn, n, iterations,
+                                std::index_sequence_for<Args...>());
+        };
+        aie_emu::nodes().kernels.push_back(node);
+
+        kernel k;
+        k.node = node;
+        k.in = port_list(node, nullptr, true);
+        k.out = port_list(node, nullptr, false);
+        return k;
+    }
+
+    port_list in;
+    port_list out;
+    std::shared_ptr<aie_emu::kernel_node> node;
+};
+
+class input_plio {
+public:
+    static input_plio create(std::string name, plio_type bits,
+                             std::string file) {
+        auto node = std::make_shared<aie_emu::plio_node>(
+            std::move(name), bits, std::move(file), true);
+        aie_emu::nodes().plios.push_back(node);
+
+        input_plio plio;
+        plio.out = port_list(nullptr, node, false);
+        return plio;
+    }
+
+    port_list out;
+};
+
+class output_plio {
+public:
+    static output_plio create(std::string name, plio_type bits,
+                              std::string file) {
+        auto node = std::make_shared<aie_emu::plio_node>(
+            std::move(name), bits, std::move(file), false);
+        aie_emu::nodes().plios.push_back(node);
+
+        output_plio plio;
+        plio.in = port_list(nullptr, node, true);
+        return plio;
+    }
+
+    port_list in;
+};
+
+template <typename Dir>
+class port {
+public:
+    std::shared_ptr<aie_emu::parameter_value> value =
+        std::make_shared<aie_emu::parameter_value>();
+};
+
+template <typename Kind>
+class connect;
+
+template <>
+class connect<stream> {
+public:
+    connect(port_ref src, port_ref dst) {
+        aie_emu::wire(src, dst, 0);
+    }
+};
+
+template <unsigned N>
+class connect<window<N>> {
+public:
+    connect(port_ref src, port_ref dst) {
+        aie_emu::wire(src, dst, N);
+    }
+};
+
+template <>
+class connect<parameter> {
+public:
+    connect(port<input> &src, port_ref dst) {
+        dst.kernel->port(true, dst.index).parameter = src.value;
+    }
+};
+
+struct location_constraint {};
+
+inline location_constraint tile(int, int) {
+    return {};
+}
+
+template <typename T>
+location_constraint &location(const kernel &) {
+    static location_constraint ignored;
+    return ignored;
+}
+
+inline std::string &source(kernel &k) {
+    return k.node->source;
+}
+
+template <typename T>
+double &runtime(kernel &k) {
+    return k.node->ratio;
+}
+
+class graph {
+public:
+    graph() = default;
+    graph(const graph &) = delete;
+    graph &operator=(const graph &) = delete;
+
+    // A graph that is still running is ended, e.g. after run(-1)
+    ~graph() {
+        if (!threads.empty()) {
+            end();
+        }
+    }
+
+    return_code init() {
+        aie_emu::registry &r = aie_emu::nodes();
+        for (const auto &k : r.kernels) {
+            for (const aie_emu::kernel_port &p : k->ports) {
+                if (!p.connected()) {
+                    std::cerr << "aie emu: kernel " << k->source
+                              << " has an unconnected port\n";
+                    return error;
+                }
+            }
+        }
+        for (const auto &plio : r.plios) {
+            if (plio->format.size == 0) {
+                std::cerr << "aie emu: PLIO " << plio->name
+                          << " is not connected\n";
+                return error;
+            }
+        }
+        return ok;
+    }
+
+    return_code run(int iterations = -1) {
+        if (started) {
+            std::cerr << "aie emu: a graph can only run once\n";
+            return error;
+        }
+        started = true;
+
+        const std::filesystem::path output_dir = aie_emu::env_string(
+            "AIEBLAS_EMU_OUTPUT", "aie_emu_output");
+        aie_emu::registry &r = aie_emu::nodes();
+        std::vector<std::function<void()>> tasks;
+        for (const auto &plio : r.plios) {
+            if (plio->input) {
+                auto file = std::make_shared<std::ifstream>(plio->file);
+                if (!*file) {
+                    std::cerr << "aie emu: cannot open " << plio->file << "\n";
+                    return error;
+                }
+                tasks.push_back([this, plio, file] {
+                    guard([&] { aie_emu::feed(*plio, *file); });
+                    for (const auto &out : plio->outs) {
+                        out->close();
+                    }
+                });
+            } else {
+                const std::filesystem::path path = output_dir / plio->file;
+                std::filesystem::create_directories(path.parent_path());
+                auto file = std::make_shared<std::ofstream>(path);
+                if (!*file) {
+                    std::cerr << "aie emu: cannot create " << path << "\n";
+                    return error;
+                }
+                tasks.push_back([this, plio, file] {
+                    guard([&] { aie_emu::drain(*plio, *file); });
+                    plio->in->cancel();
+                });
+            }
+        }
+        for (const auto &k : r.kernels) {
+            tasks.push_back([this, k, iterations] {
+                guard([&] { k->body(*k, iterations); });
+                k->finish();
+            });
+        }
+
+        for (std::function<void()> &task : tasks) {
+            threads.emplace_back(std::move(task));
+        }
+        return ok;
+    }
+
+    return_code wait() {
+        for (std::thread &t : threads) {
+            t.join();
+        }
+        threads.clear();
+
+        if (std::getenv("AIEBLAS_EMU_STATS") != nullptr) {
+            const auto &kernels = aie_emu::nodes().kernels;
+            for (std::size_t i = 0; i < kernels.size(); i++) {
+                std::cerr << "aie emu: kernel " << i << " ("
+                          << kernels[i]->source << "): "
+                          << kernels[i]->invocations << " invocations, "
+                          << std::chrono::duration<double, std::micro>(
+                                 kernels[i]->busy).count()
+                          << " us busy\n";
+            }
+        }
+        return failed ? error : ok;
+    }
+
+    return_code end() {
+        return wait();
+    }
+
+    template <typename T>
+    return_code update(port<input> &p, T value) {
+        p.value->set(&value, sizeof(T));
+        return ok;
+    }
+
+private:
+    // Runs f, an error ends the run but not the program
+    template <typename F>
+    void guard(F f) {
+        try {
+            f();
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << "\n";
+            failed = true;
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> failed = false;
+    bool started = false;
+};
+
+} // adf
@@ -0,0 +1,239 @@
+#pragma once
+/*
+ * Functional emulation of the subset of the AIE API used by the generated
+ * kernels, to build and run them on the CPU without the Xilinx tools. Vectors
+ * are plain arrays and accumulators keep their elements in a wider type, the
+ * results match the hardware, the timing does not.
+ *
+ * Kernel state declared with chess_storage is thread local, every kernel of
+ * the emulated graph runs on its own thread so replicas of a kernel do not
+ * share their state, like on separate tiles.
+ */
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+typedef std::int8_t int8;
+typedef std::int16_t int16;
+typedef std::int32_t int32;
+typedef std::int64_t int64;
+typedef std::uint8_t uint8;
+typedef std::uint16_t uint16;
+typedef std::uint32_t uint32;
+typedef std::uint64_t uint64;
+
+// The alignment argument is dropped, static keeps the state of every kernel
+// source to itself when they are linked into a single program.
+#define chess_storage(x) static thread_local
+
+namespace aie {
+
+template <typename T, unsigned N>
+class vector {
+public:
+    using value_type = T;
+
+    vector() : elems{} {}
+
+    static constexpr unsigned size() {
+        return N;
+    }
+
+    T get(unsigned i) const {
+        return elems[i];
+    }
+
+    void set(T value, unsigned i) {
+        elems[i] = value;
+    }
+
+    T &operator[](unsigned i) {
+        return elems[i];
+    }
+
+    T operator[](unsigned i) const {
+        return elems[i];
+    }
+
+    T *data() {
+        return elems.data();
+    }
+
+    const T *data() const {
+        return elems.data();
+    }
+
+private:
+    std::array<T, N> elems;
+};
+
+namespace detail {
+
+// Element type of an accumulator holding products of T
+template <typename T>
+using acc_t = std::conditional_t<std::is_floating_point_v<T>, float,
+                                 std::int64_t>;
+
+} // detail
+
+template <typename T, unsigned N>
+class accum {
+public:
+    using value_type = detail::acc_t<T>;
+
+    accum() : elems{} {}
+
+    static constexpr unsigned size() {
+        return N;
+    }
+
+    value_type get(unsigned i) const {
+        return elems[i];
+    }
+
+    void set(value_type value, unsigned i) {
+        elems[i] = value;
+    }
+
+    // The shift of integer accumulators is applied before narrowing.
+    template <typename U>
+    vector<U, N> to_vector(int shift = 0) const {
+        vector<U, N> out;
+        for (unsigned i = 0; i < N; i++) {
+            if constexpr (std::is_floating_point_v<value_type>) {
+                out[i] = static_cast<U>(elems[i]);
+            } else {
+                out[i] = static_cast<U>(elems[i] >> shift);
+            }
+        }
+        return out;
+    }
+
+private:
+    std::array<value_type, N> elems;
+};
+
+template <typename T, unsigned N>
+vector<T, N> broadcast(T value) {
+    vector<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out[i] = value;
+    }
+    return out;
+}
+
+template <typename T, unsigned N>
+vector<T, N> zeros() {
+    return vector<T, N>();
+}
+
+template <typename T, unsigned N>
+vector<T, N> add(const vector<T, N> &a, const vector<T, N> &b) {
+    vector<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out[i] = a[i] + b[i];
+    }
+    return out;
+}
+
+template <typename T, unsigned N>
+accum<T, N> add(const accum<T, N> &acc, const vector<T, N> &v) {
+    accum<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out.set(acc.get(i) + v[i], i);
+    }
+    return out;
+}
+
+template <typename T, unsigned N>
+vector<T, N> sub(const vector<T, N> &a, const vector<T, N> &b) {
+    vector<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out[i] = a[i] - b[i];
+    }
+    return out;
+}
+
+template <typename T, unsigned N>
+accum<T, N> mul(const vector<T, N> &a, const vector<T, N> &b) {
+    accum<T, N> out;
+    using acc = typename accum<T, N>::value_type;
+    for (unsigned i = 0; i < N; i++) {
+        out.set(static_cast<acc>(a[i]) * static_cast<acc>(b[i]), i);
+    }
+    return out;
+}
+
+template <typename T, unsigned N>
+accum<T, N> mul(const vector<T, N> &a, T b) {
+    return mul(a, broadcast<T, N>(b));
+}
+
+template <typename T, unsigned N>
+accum<T, N> mul(T a, const vector<T, N> &b) {
+    return mul(broadcast<T, N>(a), b);
+}
+
+template <typename T, unsigned N>
+accum<T, N> mul_square(const vector<T, N> &v) {
+    return mul(v, v);
+}
+
+// acc + a * b
+template <typename T, unsigned N>
+accum<T, N> mac(const accum<T, N> &acc, const vector<T, N> &a,
+                const vector<T, N> &b) {
+    accum<T, N> prod = mul(a, b);
+    accum<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out.set(acc.get(i) + prod.get(i), i);
+    }
+    return out;
+}
+
+// acc - a * b
+template <typename T, unsigned N>
+accum<T, N> msc(const accum<T, N> &acc, const vector<T, N> &a,
+                const vector<T, N> &b) {
+    accum<T, N> prod = mul(a, b);
+    accum<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out.set(acc.get(i) - prod.get(i), i);
+    }
+    return out;
+}
+
+template <typename T, unsigned N>
+vector<T, N> abs(const vector<T, N> &v) {
+    vector<T, N> out;
+    for (unsigned i = 0; i < N; i++) {
+        out[i] = v[i] < 0 ? -v[i] : v[i];
+    }
+    return out;
+}
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+T abs(T value) {
+    return value < 0 ? -value : value;
+}
+
+template <typename T, unsigned N>
+T reduce_add(const vector<T, N> &v) {
+    T sum = 0;
+    for (unsigned i = 0; i < N; i++) {
+        sum += v[i];
+    }
+    return sum;
+}
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+T sqrt(T value) {
+    return static_cast<T>(std::sqrt(value));
+}
+
+} // aie
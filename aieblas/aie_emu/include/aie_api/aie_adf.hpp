@@ -0,0 +1,217 @@
+#pragma once
+/*
+ * Emulation of the window and stream interface of AIE kernels. A kernel of the
+ * emulated graph gets windows and streams bound to the nets of the graph, see
+ * adf.h. Kernels can also be called directly, e.g. in a unit test:
+ *
+ *   input_stream<float> alpha({2.0f});
+ *   input_window<float> x(xs), y(ys);
+ *   output_window<float> out(xs.size());
+ *   axpy(&alpha, &x, &y, &out);
+ *
+ * after which out.data holds the result. Stream results are kept by the
+ * output stream and returned by values().
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aie_api/aie.hpp"
+#include "aie_emu/channel.h"
+
+template <typename T>
+class input_stream {
+public:
+    input_stream() = default;
+    explicit input_stream(aie_emu::source port) : port(std::move(port)) {}
+
+    // Stream of the given values, after which it ends
+    input_stream(std::initializer_list<T> values)
+        : input_stream(std::vector<T>(values)) {}
+
+    explicit input_stream(const std::vector<T> &values) {
+        auto net = std::make_shared<aie_emu::channel>(
+            values.size() * sizeof(T));
+        net->push(values.data(), values.size() * sizeof(T));
+        net->close();
+        port = aie_emu::source(std::move(net));
+    }
+
+    aie_emu::source port;
+};
+
+template <typename T>
+class output_stream {
+public:
+    output_stream() = default;
+    explicit output_stream(aie_emu::sink port) : port(std::move(port)) {}
+
+    // Values written to a stream that is not connected to a net
+    std::vector<T> values() const {
+        std::vector<T> out(port.kept.size() / sizeof(T));
+        std::memcpy(out.data(), port.kept.data(), out.size() * sizeof(T));
+        return out;
+    }
+
+    aie_emu::sink port;
+};
+
+/*
+ * Windows wrap around at their end, like the address generator of the tile.
+ * Windows bound to a net are filled from it (or flushed to it) by acquiring
+ * (or releasing) them, which the graph does around every invocation unless
+ * the window is asynchronous.
+ */
+template <typename T>
+class input_window {
+public:
+    input_window() = default;
+    explicit input_window(std::vector<T> values) : data(std::move(values)) {}
+    input_window(aie_emu::source port, std::size_t size)
+        : data(size), port(std::move(port)) {}
+
+    void acquire() {
+        if (port.connected()) {
+            port.read(data.data(), data.size() * sizeof(T));
+        }
+        position = 0;
+    }
+
+    void release() {}
+
+    std::vector<T> data;
+    std::size_t position = 0;
+    aie_emu::source port;
+};
+
+template <typename T>
+class output_window {
+public:
+    output_window() = default;
+    explicit output_window(std::size_t size) : data(size) {}
+    output_window(aie_emu::sink port, std::size_t size)
+        : data(size), port(std::move(port)) {}
+
+    void acquire() {
+        position = 0;
+    }
+
+    void release() {
+        if (port.connected()) {
+            port.write(data.data(), data.size() * sizeof(T));
+        }
+        position = 0;
+    }
+
+    std::vector<T> data;
+    std::size_t position = 0;
+    aie_emu::sink port;
+};
+
+template <typename W>
+void window_acquire(W *w) {
+    w->acquire();
+}
+
+template <typename W>
+void window_release(W *w) {
+    w->release();
+}
+
+template <typename W>
+void window_incr(W *w, long long count) {
+    const long long size = static_cast<long long>(w->data.size());
+    const long long next = static_cast<long long>(w->position) + count;
+    w->position = static_cast<std::size_t>(((next % size) + size) % size);
+}
+
+template <typename W>
+void window_decr(W *w, long long count) {
+    window_incr(w, -count);
+}
+
+template <typename W>
+void window_decr_v4(W *w, long long count) {
+    window_decr(w, 4 * count);
+}
+
+template <typename W>
+void window_decr_v8(W *w, long long count) {
+    window_decr(w, 8 * count);
+}
+
+template <typename W>
+void window_decr_v16(W *w, long long count) {
+    window_decr(w, 16 * count);
+}
+
+template <typename W>
+void window_decr_v32(W *w, long long count) {
+    window_decr(w, 32 * count);
+}
+
+template <typename W>
+void window_decr_v64(W *w, long long count) {
+    window_decr(w, 64 * count);
+}
+
+template <typename T>
+T window_readincr(input_window<T> *w) {
+    T value = w->data[w->position];
+    window_incr(w, 1);
+    return value;
+}
+
+template <unsigned N, typename T>
+aie::vector<T, N> window_readincr_v(input_window<T> *w) {
+    aie::vector<T, N> v;
+    for (unsigned i = 0; i < N; i++) {
+        v[i] = window_readincr(w);
+    }
+    return v;
+}
+
+template <typename T>
+void window_writeincr(output_window<T> *w, std::type_identity_t<T> value) {
+    w->data[w->position] = value;
+    window_incr(w, 1);
+}
+
+template <typename T, unsigned N>
+void window_writeincr(output_window<T> *w, const aie::vector<T, N> &v) {
+    for (unsigned i = 0; i < N; i++) {
+        window_writeincr(w, v[i]);
+    }
+}
+
+template <typename T>
+T readincr(input_stream<T> *s) {
+    T value;
+    s->port.read(&value, sizeof(T));
+    return value;
+}
+
+template <unsigned N, typename T>
+aie::vector<T, N> readincr_v(input_stream<T> *s) {
+    aie::vector<T, N> v;
+    s->port.read(v.data(), N * sizeof(T));
+    return v;
+}
+
+// The end of a packet is not modelled, tlast is ignored.
+template <typename T>
+void writeincr(output_stream<T> *s, std::type_identity_t<T> value,
+               bool tlast = false) {
+    s->port.write(&value, sizeof(T));
+}
+
+template <typename T, unsigned N>
+void writeincr(output_stream<T> *s, const aie::vector<T, N> &v,
+               bool tlast = false) {
+    s->port.write(v.data(), N * sizeof(T));
+}
@@ -0,0 +1,171 @@
+#pragma once
+/*
+ * Connections of the emulated AIE graph. Every net of the graph is a bounded
+ * byte queue between its producer and consumer, which block when the queue is
+ * full or empty, like the stream switches and ping-pong buffers of the array.
+ *
+ * The emulation is configured through the environment variables:
+ *   AIEBLAS_EMU_FIFO_BYTES: capacity of a net, a window net holds at least
+ *                           two windows (default 4096)
+ *   AIEBLAS_EMU_OUTPUT:     directory the output PLIO files are written to
+ *                           (default aie_emu_output)
+ *   AIEBLAS_EMU_STATS:      if set, print the invocations and busy time of
+ *                           every kernel when the graph ends
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aie_emu {
+
+// Thrown by a read of a net whose producer finished and that has no data left,
+// ends the kernel reading it.
+struct end_of_data {};
+
+inline std::size_t env_size(const char *name, std::size_t fallback) {
+    const char *value = std::getenv(name);
+    return value == nullptr ? fallback : std::strtoull(value, nullptr, 10);
+}
+
+inline std::string env_string(const char *name, const char *fallback) {
+    const char *value = std::getenv(name);
+    return value == nullptr ? fallback : value;
+}
+
+class channel {
+public:
+    explicit channel(std::size_t capacity)
+        : buffer(std::max<std::size_t>(capacity, 1)) {}
+
+    // Returns false if the consumer is gone, the remaining bytes are dropped.
+    bool push(const void *src, std::size_t n) {
+        const std::byte *bytes = static_cast<const std::byte *>(src);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (n > 0) {
+            cv.wait(lock, [this] {
+                return cancelled || used < buffer.size();
+            });
+            if (cancelled) {
+                return false;
+            }
+            const std::size_t tail = (head + used) % buffer.size();
+            const std::size_t count = std::min({n, buffer.size() - used,
+                                                buffer.size() - tail});
+            std::memcpy(buffer.data() + tail, bytes, count);
+            used += count;
+            bytes += count;
+            n -= count;
+            cv.notify_all();
+        }
+        return true;
+    }
+
+    void pop(void *dst, std::size_t n) {
+        std::byte *bytes = static_cast<std::byte *>(dst);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (n > 0) {
+            cv.wait(lock, [this] { return used > 0 || closed || cancelled; });
+            if (used == 0) {
+                throw end_of_data{};
+            }
+            const std::size_t count = std::min({n, used,
+                                                buffer.size() - head});
+            std::memcpy(bytes, buffer.data() + head, count);
+            head = (head + count) % buffer.size();
+            used -= count;
+            bytes += count;
+            n -= count;
+            cv.notify_all();
+        }
+    }
+
+    // The producer finished, reads fail once the queue is empty
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        cv.notify_all();
+    }
+
+    // The consumer finished, writes fail from now on
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        cv.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::byte> buffer;
+    std::size_t head = 0;
+    std::size_t used = 0;
+    bool closed = false;
+    bool cancelled = false;
+};
+
+// Consumer side of a net, a source without a net has no data.
+class source {
+public:
+    source() = default;
+    explicit source(std::shared_ptr<channel> net) : net(std::move(net)) {}
+
+    bool connected() const {
+        return net != nullptr;
+    }
+
+    void read(void *dst, std::size_t n) {
+        if (!net) {
+            throw end_of_data{};
+        }
+        net->pop(dst, n);
+    }
+
+private:
+    std::shared_ptr<channel> net;
+};
+
+/*
+ * Producer side of one or more nets, data is broadcast to all of them. Bytes
+ * written to a sink without nets are kept, so tests can inspect them.
+ */
+class sink {
+public:
+    sink() = default;
+    explicit sink(std::vector<std::shared_ptr<channel>> nets)
+        : nets(std::move(nets)) {}
+
+    bool connected() const {
+        return !nets.empty();
+    }
+
+    void write(const void *src, std::size_t n) {
+        if (nets.empty()) {
+            const std::byte *bytes = static_cast<const std::byte *>(src);
+            kept.insert(kept.end(), bytes, bytes + n);
+            return;
+        }
+        for (const std::shared_ptr<channel> &net : nets) {
+            net->push(src, n);
+        }
+    }
+
+    void close() {
+        for (const std::shared_ptr<channel> &net : nets) {
+            net->close();
+        }
+    }
+
+    std::vector<std::byte> kept;
+
+private:
+    std::vector<std::shared_ptr<channel>> nets;
+};
+
+} // aie_emu
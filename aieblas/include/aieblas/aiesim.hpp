@@ -0,0 +1,76 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace aieblas {
+namespace aiesim {
+
+struct report_options {
+    // design generated by codegen, containing aie/graph.hpp
+    std::filesystem::path design;
+    // output of the simulator and the expected output, relative to design
+    std::filesystem::path output = "aiesimulator_output";
+    std::filesystem::path golden = "data/golden";
+    // allowed error of a value, see golden_diff
+    double tolerance = 1e-5;
+    // intervals longer than this many times the median interval are stalls
+    double gap_factor = 4.0;
+    // calibrated profile to compare the simulation against, if not empty
+    std::filesystem::path profile;
+};
+
+/*
+ * Print the throughput, first output latency and stalls of every output PLIO
+ * of a simulated design, and compare its values against the expected output
+ * if present. Returns false if an output is missing or differs.
+ */
+bool report(const report_options &options);
+
+struct calibrate_options {
+    // simulated designs, with their output in output relative to a design
+    std::vector<std::filesystem::path> designs;
+    std::filesystem::path output = "aiesimulator_output";
+    // JSON lines written by benchmark/util/include/write_results.hpp or the
+    // benchmark driver of a design
+    std::vector<std::filesystem::path> results;
+    double gap_factor = 4.0;
+    // profile to update, created if it does not exist
+    std::filesystem::path profile;
+};
+
+/*
+ * Fit the coefficients of the throughput model to simulated designs and
+ * benchmark results, and store them in a profile: the cycles per vector and
+ * per window of every operation and type, the cycles per beat of the data
+ * movers and the setup time of a call from the host. Returns false if there
+ * was nothing to fit.
+ */
+bool calibrate(const calibrate_options &options);
+
+struct roofline_options {
+    // designs generated by codegen, matched to results by their design JSON
+    std::vector<std::filesystem::path> designs;
+    // JSON lines written by benchmark/util/include/write_results.hpp or the
+    // benchmark driver of a design
+    std::vector<std::filesystem::path> results;
+    // bandwidth of a DDR memory controller (MC_NOC port of link.cfg), GB/s
+    double ddr_channel_gbps = 25.6;
+    // calibrated profile for the clocks and cycles per beat of the movers,
+    // if not empty
+    std::filesystem::path profile;
+    // plot to write, if not empty
+    std::filesystem::path svg;
+};
+
+/*
+ * Compare the benchmark results of designs against the ceilings of their
+ * design: the DDR bandwidth of the memory controllers the movers use
+ * (transfer), the bandwidth of the PLIOs at the PL clock (mover) and the
+ * MAC peak of the AIE tiles for the type (compute). Prints per result the
+ * ceiling it is closest to. Returns false if no result matched a design.
+ */
+bool roofline(const roofline_options &options);
+
+} // aiesim
+} // aieblas
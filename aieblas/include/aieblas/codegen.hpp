@@ -5,7 +5,10 @@
 namespace aieblas {
 namespace codegen {
 
-void codegen(std::filesystem::path json, std::filesystem::path output);
+// emit_sim_data: also generate sim/sim_data.cpp, which writes aiesimulator
+// stimulus and golden output for a problem size
+void codegen(std::filesystem::path json, std::filesystem::path output,
+             bool emit_sim_data = false);
 
 } // codegen
 } // aieblas
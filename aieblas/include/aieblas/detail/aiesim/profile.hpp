@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "aieblas/detail/util.hpp"
+
+namespace aieblas {
+namespace aiesim {
+
+/*
+ * Cost of a kernel per window of a BLAS operation and data type: the window
+ * takes window_overhead + cycles_per_vector * (samples / vector_size) AIE
+ * cycles, with samples the elements of a window. Kernels without a vector
+ * size count one cycle per element.
+ */
+struct op_cost {
+    double cycles_per_vector = 1.0;
+    double window_overhead = 0.0;
+    std::size_t samples = 0;
+};
+
+/*
+ * Calibrated coefficients of the throughput model, stored as JSON. Files of
+ * another version than profile::version are rejected.
+ */
+struct profile {
+    static constexpr unsigned version = 2;
+
+    double aie_clock_mhz = 1250.0;
+    double pl_clock_mhz = 500.0;
+
+    // ops[blas_op][type], e.g. ops["axpy"]["float"]
+    std::map<std::string, std::map<std::string, op_cost>> ops;
+
+    // PL cycles per PLIO beat of the data movers
+    double mover_ii = 1.0;
+    std::size_t mover_samples = 0;
+
+    // fixed cost of a call from the host: transfer setup and graph launch
+    double host_setup_us = 0.0;
+    std::size_t host_samples = 0;
+
+    // end-to-end time per element of every benchmark in the results
+    std::map<std::string, double> benchmark_ns_per_element;
+
+    const op_cost &cost(const std::string &op, const std::string &type) const;
+};
+
+profile load_profile(const fs::path &file);
+void save_profile(const profile &p, const fs::path &file);
+
+// Kernel of a design as far as the model is concerned
+struct kernel_shape {
+    std::string op;
+    std::string user_name;
+    std::string type;
+    unsigned type_bits;
+    unsigned vsize;
+    // window size in bytes
+    unsigned wsize;
+    unsigned replicas;
+    // elements are packed into PLIO beats of this width, 0: one element per
+    // beat
+    unsigned plio_width;
+
+    // elements per window, NUM_SAMPLES of the generated kernel
+    unsigned samples() const {
+        return std::max(1u, wsize * 8 / type_bits);
+    }
+
+    double vectors_per_window() const {
+        return static_cast<double>(samples()) / (vsize == 0 ? 1 : vsize);
+    }
+};
+
+// Design JSON a design directory was generated from, as in its
+// manifest.json
+fs::path design_json(const fs::path &design);
+
+// Kernels of the design JSON a design directory was generated from
+std::vector<kernel_shape> parse_design_kernels(const fs::path &design);
+
+// Kernel of a PLIO port, nullptr if none
+const kernel_shape *find_kernel(const std::vector<kernel_shape> &kernels,
+                                const std::string &port);
+
+/*
+ * Estimated time in ns of a call of a kernel on size elements. The AIE kernel
+ * and its data movers run concurrently, so the slowest of the two counts.
+ */
+struct estimate {
+    double setup_ns;
+    double aie_ns;
+    double mover_ns;
+
+    double stream_ns() const {
+        return std::max(aie_ns, mover_ns);
+    }
+
+    double total_ns() const {
+        return setup_ns + stream_ns();
+    }
+};
+
+estimate estimate_call(const profile &p, const kernel_shape &k,
+                       std::uint64_t size);
+
+} // aiesim
+} // aieblas
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "aieblas/detail/util.hpp"
+
+namespace aieblas {
+namespace aiesim {
+
+class trace_error : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+/*
+ * Line of values of a PLIO file, one beat of the PLIO. The simulator
+ * precedes beats with the time they were transferred ("T 1234 ns"), and
+ * marks the end of a packet with TLAST. Stimulus and golden files have no
+ * times.
+ */
+struct beat {
+    std::optional<double> time_ns;
+    std::vector<double> values;
+    bool tlast = false;
+};
+
+struct plio_trace {
+    fs::path file;
+    std::vector<beat> beats;
+
+    bool timed() const;
+};
+
+plio_trace parse_plio_file(const fs::path &file);
+
+// PLIO of the graph, as created in aie/graph.hpp of a design
+struct plio_port {
+    std::string name;
+    bool input;
+    unsigned bits;
+    fs::path file;
+};
+
+std::vector<plio_port> parse_graph_plios(const fs::path &graph_hdr);
+
+/*
+ * Timing of an output PLIO. Latency is the time of the first beat since the
+ * start of the simulation, throughput is measured from the first to the last
+ * beat. Intervals between beats longer than gap_factor times the median
+ * interval are stalls, e.g. while the next window is computed.
+ */
+struct port_timing {
+    std::size_t beats = 0;
+    std::size_t bytes = 0;
+    double first_ns = 0;
+    double last_ns = 0;
+    double median_interval_ns = 0;
+    std::size_t stalls = 0;
+    double stall_ns = 0;
+    double max_stall_ns = 0;
+
+    double throughput_gbps() const {
+        return last_ns > first_ns ? bytes / (last_ns - first_ns) : 0.0;
+    }
+};
+
+port_timing analyze_timing(const plio_trace &trace, unsigned bits,
+                           double gap_factor);
+
+/*
+ * Comparison of an output against its expected values. A value matches if it
+ * is within tolerance of the expected value, relative to the magnitude of
+ * the expected value if that is larger than 1.
+ */
+struct golden_diff {
+    std::size_t values = 0;
+    std::size_t expected = 0;
+    std::size_t mismatches = 0;
+    std::optional<std::size_t> first_mismatch;
+    double max_error = 0;
+
+    bool ok() const {
+        return mismatches == 0 && values == expected;
+    }
+};
+
+golden_diff compare_golden(const plio_trace &trace, const plio_trace &golden,
+                           double tolerance);
+
+} // aiesim
+} // aieblas
@@ -35,8 +35,9 @@ struct kernel_arg {
     bool async = false;
 };
 
+// rtp: scalar set by the host as a runtime parameter of the graph
 enum class connection_type : unsigned {
-    none, host, kernel
+    none, host, kernel, rtp
 };
 
 struct connection {
@@ -67,15 +68,46 @@ struct kernel {
     unsigned tile_x;
     unsigned tile_y;
 
+    // number of data-parallel copies of this kernel
+    unsigned replicas;
+
+    // width in bits of the PLIOs carrying vector data from/to the host,
+    // elements are packed into a single beat. 0: one element per beat
+    unsigned plio_width;
+
     // maps parameter (of this kernel) to outside data port
     std::unordered_map<std::string, connection> connections;
 
     std::unique_ptr<kernel_options> extra_options;
 };
 
+struct mover_options {
+    // width in bits of the memory accesses of the PL movers, 0: one element
+    // per access
+    unsigned mem_width;
+    // maximum AXI burst length (in memory words)
+    unsigned burst_length;
+    // maximum number of outstanding AXI transactions
+    unsigned outstanding;
+    // generate a single mover for all kernels instead of one per kernel
+    bool merge;
+    // number of memory controller NoC ports (MC_NOC<i>) to spread the memory
+    // arguments of the movers over
+    unsigned noc_ports;
+};
+
 struct data {
     bool profile;
+    // run the graph forever instead of once per call, kernels reset their
+    // state at the end of every job
+    bool persistent;
+    // scalars from the host are runtime parameters instead of stream tokens
+    bool rtp;
+    // generate the aiesimulator stimulus program sim/sim_data.cpp, set by
+    // the --emit-sim-data option of the code generator
+    bool sim_data;
     std::string platform;
+    mover_options movers;
     std::vector<kernel> kernels;
 };
 
@@ -149,6 +181,32 @@ constexpr inline const char *datatype_to_str(dtype type) {
     }
 }
 
+// Type of an element on the host
+constexpr inline const char *datatype_to_host_type(dtype type) {
+    switch (type) {
+    case dtype::int8:
+        return "std::int8_t";
+    case dtype::int16:
+        return "std::int16_t";
+    case dtype::int32:
+        return "std::int32_t";
+    case dtype::int64:
+        return "std::int64_t";
+    case dtype::uint8:
+        return "std::uint8_t";
+    case dtype::uint16:
+        return "std::uint16_t";
+    case dtype::uint32:
+        return "std::uint32_t";
+    case dtype::uint64:
+        return "std::uint64_t";
+    case dtype::float32:
+        return "float";
+    default:
+        return "unknown";
+    }
+}
+
 inline dtype datatype_from_str(const std::string_view str) {
     if (str == "int8") {
         return dtype::int8;
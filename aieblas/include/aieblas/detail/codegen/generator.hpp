@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
-#include <fstream>
+#include <sstream>
+#include <vector>
 
 #include "aieblas/detail/util.hpp"
 #include "aieblas/detail/codegen/datastructures.hpp"
@@ -13,11 +16,17 @@ namespace codegen {
 
 class generator {
     public:
-    generator(fs::path json, fs::path output);
+    generator(fs::path json, fs::path output, bool sim_data = false);
 
+    // Writes the open file, if any. A failure is logged, not thrown
     ~generator() {
-        if (cur_file_.is_open()) {
-            this->close();
+        if (!cur_filename.empty()) {
+            try {
+                this->close();
+            } catch (const std::exception &e) {
+                log(log_level::error, "Could not write '{}': {}",
+                    cur_filename.native(), e.what());
+            }
         }
     }
 
@@ -25,11 +34,18 @@ class generator {
         return this->d;
     }
 
+    const fs::path &get_json_path() const {
+        return this->json_path;
+    }
+
     void generate_kernels();
     void generate_graph();
     void generate_pl_kernels();
     void generate_config();
+    void generate_host();
+    void generate_sim_data();
     void generate_cmake();
+    void generate_manifest();
 
     enum comment_type : unsigned {
         NO_COMMENT = 0U,
@@ -37,14 +53,19 @@ class generator {
         HASHTAG = 2U
     };
 
+    /*
+     * Files are generated in memory, closing a file only writes it when its
+     * content hash differs from the existing file. Unchanged files keep their
+     * modification time, so the build of the design only redoes what changed.
+     */
     void open(fs::path filename, comment_type comment_type = C_STYLE);
     void close();
 
-    std::ofstream &cur_file() {
+    std::ostringstream &cur_file() {
         return cur_file_;
     }
 
-    const std::ofstream &cur_file() const {
+    const std::ostringstream &cur_file() const {
         return cur_file_;
     }
 
@@ -123,7 +144,16 @@ class generator {
     std::vector<fs::path> kernel_hdrs;
     std::vector<fs::path> pl_kernels;
 
-    std::ofstream cur_file_;
+    // File generated by this run, with the hash of its content
+    struct emitted_file {
+        fs::path path;
+        std::uint64_t hash;
+        bool changed;
+    };
+    std::vector<emitted_file> emitted;
+
+    fs::path json_path;
+    std::ostringstream cur_file_;
     fs::path cur_filename;
     std::size_t indent_;
     bool indented;
@@ -4,6 +4,7 @@
 
 #include "aieblas/detail/util.hpp"
 #include "aieblas/detail/codegen/generator.hpp"
+#include "aieblas/detail/codegen/pl_kernels.hpp"
 
 namespace aieblas {
 namespace codegen {
@@ -61,11 +62,62 @@ public:
         return ::aieblas::codegen::get_kernel_args(k.operation);
     }
 
-    virtual std::vector<pl_kernel_generator> get_pl_generators() = 0;
+    virtual std::vector<pl_mover> get_pl_movers() = 0;
 
-    virtual void gen_link(generator &gen) = 0;
+    /*
+     * Generate the CPU implementation of this kernel for the mock XRT
+     * backend. Arguments are available as variables named after the kernel
+     * arguments (pointers for vectors), and size holds the number of elements
+     * (rows for matrices). Arguments fixed by options must be declared here.
+     */
+    virtual void gen_mock(generator &gen) = 0;
+
+    /*
+     * Number of iterations of the graph in a run of this kernel, used by the
+     * simulation data, as an expression of the size arguments of its movers.
+     * By default one iteration per window of the first padded input, empty if
+     * it has none.
+     */
+    virtual std::string get_graph_iterations();
+
+    virtual std::vector<pl_kernel_generator> get_pl_generators();
+
+    virtual void gen_link(generator &gen);
 
 protected:
+    /*
+     * Latch scalars read from streams, given as (stream, store) pairs, until
+     * the end of a job. Graphs that run once latch them on the first
+     * invocation, marked by setting the zero initialized element flag_storage
+     * of the kernel type. Persistent graphs send the number of invocations of
+     * the job after every scalar, counted down in the storage of gen_job_glob.
+     */
+    void gen_scalar_latch(generator &gen, const std::string &flag,
+                          const std::string &flag_storage,
+                          const std::vector<std::pair<std::string,
+                                                      std::string>> &scalars);
+    // Elements consumed by one iteration of all replicas, vectors moved by
+    // the PL are padded to a multiple of it.
+    unsigned job_block() const {
+        const unsigned num_samples = k.wsize * 8 / datatype_to_bits(k.type);
+        return std::max(1u, num_samples * k.replicas);
+    }
+    // Scalars read from a stream are latched, runtime parameters and
+    // constants are not.
+    static bool latched(const connection &conn) {
+        return conn.type == connection_type::host ||
+               conn.type == connection_type::kernel;
+    }
+    // Kernel parameter of scalar name, a stream or a runtime parameter.
+    std::string scalar_param(const std::string &name, const connection &conn);
+    // Storage of the remaining invocations of a job in persistent graphs.
+    void gen_job_glob(generator &gen);
+    // Clear the counters and results, vectors of vsize elements or scalars if
+    // 0, of a reduction at the end of a job in persistent graphs. The next job
+    // then starts with reading its size.
+    void gen_job_reset(generator &gen, const std::vector<std::string> &results,
+                       unsigned vsize);
+
     const kernel &k;
     std::unique_ptr<kernel_options> o;
 };
@@ -78,5 +130,10 @@ void generate_kernel_src(generator &gen, kernel_generator &kernel_gen,
 void generate_kernel_hdr(generator &gen, kernel_generator &kernel_gen,
                          const kernel &kernel);
 
+// Name of the runtime parameter arg of a replica of kernel, as passed to
+// xrt::graph::update (e.g. mygraph.axpyk.in[0]).
+std::string rtp_port_name(const kernel &kernel, const std::string &arg,
+                          unsigned replica);
+
 } // codegen
 } // aieblas
@@ -45,14 +45,11 @@ public:
     void gen_kernel_args(generator &gen) override;
     void gen_kernel_body(generator &gen) override;
 
-    std::vector<pl_kernel_generator> get_pl_generators() override;
-    void gen_mm2s_A(generator &gen);
-    void gen_mm2s_scalar(generator &gen);
-    void gen_mm2s_x(generator &gen);
-    void gen_mm2s_y(generator &gen);
-    void gen_s2mm(generator &gen);
-
-    void gen_link(generator &gen) override;
+    std::vector<pl_mover> get_pl_movers() override;
+
+    void gen_mock(generator &gen) override;
+
+    std::string get_graph_iterations() override;
 
 private:
     const std::string dtype;
@@ -44,13 +44,9 @@ public:
     void gen_kernel_args(generator &gen) override;
     void gen_kernel_body(generator &gen) override;
 
-    std::vector<pl_kernel_generator> get_pl_generators() override;
-    bool need_mm2s() const;
-    void gen_mm2s(generator &gen);
-    bool need_s2mm() const;
-    void gen_s2mm(generator &gen);
+    std::vector<pl_mover> get_pl_movers() override;
 
-    void gen_link(generator &gen) override;
+    void gen_mock(generator &gen) override;
 
 private:
     const std::string dtype;
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/codegen/datastructures.hpp"
+#include "aieblas/detail/codegen/generator.hpp"
+
+namespace aieblas {
+namespace codegen {
+
+/**
+ * Host-visible argument of a PL data mover. The order in which arguments are
+ * added is the order of the generated kernel signature, and therefore the
+ * argument index used by xrt::run::set_arg on the host.
+ */
+enum class pl_arg_type : unsigned {
+    unknown, memory, scalar, size, flag
+};
+
+struct pl_arg {
+    pl_arg_type type;
+    std::string name;
+    unsigned bits;
+};
+
+/**
+ * Stream between a PL data mover and the AIE graph.
+ *
+ * mem_to_stream:    copy `length` elements from memory argument `host_arg`
+ * stream_to_mem:    copy `length` elements to memory argument `host_arg`
+ * scalar_to_stream: send scalar argument `host_arg` as a single beat
+ * size_to_stream:   send size argument `host_arg` as a single 64 bit beat
+ *
+ * A port with multiple replicas is split over `replicas` streams, where
+ * element i is sent to (or received from) stream i % replicas.
+ *
+ * Vector memory ports of a kernel with a plio_width set are packed: every
+ * beat carries plio_width / bits consecutive elements.
+ *
+ * Data ports with a block larger than 1 move their length rounded up to a
+ * multiple of block elements, so the kernel always gets whole windows. The
+ * tail is padded with zeros when sending and dropped when receiving. Every
+ * invocation pads its own length, so only the last chunk of a vector moved
+ * in chunks (see mover_args) may have a length that is not a multiple of
+ * block.
+ */
+enum class pl_port_type : unsigned {
+    unknown, mem_to_stream, stream_to_mem, scalar_to_stream, size_to_stream
+};
+
+struct pl_port {
+    pl_port_type type;
+    std::string arg;
+    std::string host_arg;
+    unsigned bits;
+    std::string length;
+    unsigned replicas;
+    unsigned block;
+};
+
+struct pl_mover {
+    std::string name;
+    std::vector<pl_arg> args;
+    std::vector<pl_port> ports;
+    std::vector<std::string> defines;
+
+    pl_mover(std::string name_) : name(std::move(name_)) {}
+
+    void add_arg(pl_arg_type type, std::string arg_name, unsigned bits = 0) {
+        args.emplace_back(type, std::move(arg_name), bits);
+    }
+
+    void add_port(pl_port_type type, std::string arg, std::string host_arg,
+                  unsigned bits, std::string length = "1",
+                  unsigned replicas = 1, unsigned block = 1) {
+        ports.emplace_back(type, std::move(arg), std::move(host_arg), bits,
+                           std::move(length), replicas, block);
+    }
+
+    bool empty() const {
+        return ports.empty();
+    }
+};
+
+/*
+ * All host arguments of a mover. Movers sending tokens get extra trailing
+ * arguments, so a vector can be moved in chunks by multiple invocations while
+ * the AIE kernel keeps running (e.g. accumulating a reduction):
+ *   <size>_total: size sent in the size token, if 0 the size of this
+ *                 invocation is sent
+ *   continued:    do not send any tokens, a previous chunk already did
+ * Both are 0 unless set by the host, which moves the vector in one go. All
+ * chunks but the last must be a multiple of the block of the data ports
+ * (kernel_generator::job_block), otherwise their padding ends up in the
+ * middle of the vector and the kernel receives more windows than the size
+ * token announces.
+ */
+inline std::vector<pl_arg> mover_args(const pl_mover &mover) {
+    std::vector<pl_arg> args = mover.args;
+    bool tokens = false;
+    for (const pl_port &port : mover.ports) {
+        if (port.type == pl_port_type::size_to_stream) {
+            args.emplace_back(pl_arg_type::size,
+                              std::format("{}_total", port.host_arg), 64);
+        }
+        tokens = tokens || port.type == pl_port_type::scalar_to_stream ||
+                 port.type == pl_port_type::size_to_stream;
+    }
+    if (tokens) {
+        args.emplace_back(pl_arg_type::flag, "continued", 1);
+    }
+    return args;
+}
+
+// Number of elements on the streams of port, including the padding.
+inline std::string padded_length(const pl_port &port) {
+    if (port.block <= 1) {
+        return port.length;
+    }
+    return std::format("(({}) + {}) / {} * {}", port.length, port.block - 1,
+                       port.block, port.block);
+}
+
+constexpr inline bool pl_port_is_input(pl_port_type type) {
+    return type != pl_port_type::stream_to_mem;
+}
+
+// Only vector arguments are split over replicas, scalars are broadcast.
+inline unsigned arg_replicas(const kernel &kernel, const kernel_arg &arg) {
+    return arg.dimensions == 0 ? 1 : kernel.replicas;
+}
+
+inline std::string replica_name(const std::string &base, unsigned replicas,
+                                unsigned replica) {
+    if (replicas <= 1) {
+        return base;
+    }
+    return std::format("{}_{}", base, replica);
+}
+
+// Width of the PLIO connecting argument arg of kernel to the host.
+inline unsigned plio_bits(const kernel &kernel, const kernel_arg &arg) {
+    // Manual override to keep index variables 64 bits
+    if (arg.type == karg_type::input_index) {
+        return 64;
+    } else if (arg.dimensions != 0 && kernel.plio_width != 0) {
+        return kernel.plio_width;
+    }
+    return std::max(32u, datatype_to_bits(kernel.type));
+}
+
+// Number of elements carried by a single beat of port. Only vector data is
+// packed, single element results (e.g. of reductions) are not.
+inline unsigned elements_per_beat(const kernel &kernel, const pl_port &port) {
+    if (kernel.plio_width == 0 || port.length == "1" ||
+        (port.type != pl_port_type::mem_to_stream &&
+         port.type != pl_port_type::stream_to_mem)) {
+        return 1;
+    }
+    return kernel.plio_width / port.bits;
+}
+
+// Name of the AIE kernel object of a replica in the generated graph.
+inline std::string kernel_object(const kernel &kernel, unsigned replica) {
+    if (kernel.replicas <= 1) {
+        return std::format("{}k", kernel.user_name);
+    }
+    return std::format("{}k[{}]", kernel.user_name, replica);
+}
+
+/*
+ * Host argument of a generated PL kernel. index is the position of the
+ * argument in the signature of pl_kernel, streams included, as used by
+ * xrt::run::set_arg and xrt::kernel::group_id. Arguments added by mover_args
+ * are implicit.
+ */
+struct pl_kernel_arg {
+    std::string pl_kernel;
+    std::string mover;
+    pl_arg arg;
+    unsigned index;
+    bool implicit;
+};
+
+// Host arguments of the PL kernels moving the data of kernel. When movers are
+// merged, arguments shared by movers are only listed for the first mover.
+std::vector<pl_kernel_arg> get_pl_kernel_args(generator &gen,
+                                              const kernel &kernel);
+
+// Name of the PL kernel containing all movers when movers are merged.
+constexpr inline const char *merged_mover_name = "movers";
+
+// Generate a mover, as a top-level PL kernel or as a function of the merged
+// mover.
+void gen_pl_mover(generator &gen, const kernel &kernel, const pl_mover &mover,
+                  bool top);
+void gen_pl_link(generator &gen, const kernel &kernel,
+                 const std::vector<pl_mover> &movers);
+
+/*
+ * Generate a single PL kernel moving the data of all kernels of the design.
+ * Every argument and stream of a mover is prefixed with its kernel name, e.g.
+ * axpy_size and axpy_stream_x. Memory arguments are also prefixed with the
+ * mover name (e.g. axpy_mm2s_mem_x), as movers of a kernel may reuse names.
+ */
+void gen_pl_merged_mover(generator &gen);
+void gen_pl_merged_link(generator &gen);
+
+} // codegen
+} // aieblas
@@ -0,0 +1,60 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <xrt/xrt_bo.h>
+#include <xrt/xrt_device.h>
+
+/*
+ * Fixed size device buffers to move a vector that does not fit in device
+ * memory through a PL data mover in chunks. Chunk i uses buffer i % 2, so the
+ * host can fill (or drain) one buffer while the mover works on the other.
+ */
+template <typename T>
+class ChunkBuffers {
+public:
+    ChunkBuffers(xrt::device &device, xrtMemoryGroup bank,
+                 std::uint64_t chunk_size)
+        : chunk_size(chunk_size),
+          buffers{xrt::bo{device, chunk_size * sizeof(T), bank},
+                  xrt::bo{device, chunk_size * sizeof(T), bank}} { }
+
+    inline std::uint64_t chunks(std::uint64_t size) const {
+        return (size + chunk_size - 1) / chunk_size;
+    }
+
+    // Number of elements of a vector of size elements in chunk.
+    inline std::uint64_t length(std::uint64_t size,
+                                std::uint64_t chunk) const {
+        return std::min(chunk_size, size - chunk * chunk_size);
+    }
+
+    inline xrt::bo &buffer(std::uint64_t chunk) {
+        return buffers[chunk % buffers.size()];
+    }
+
+    // Copy chunk of data to its buffer. The previous run using the buffer
+    // must have finished.
+    inline xrt::bo &upload(const T *data, std::uint64_t size,
+                           std::uint64_t chunk) {
+        xrt::bo &bo = buffer(chunk);
+        const std::uint64_t bytes = length(size, chunk) * sizeof(T);
+        std::memcpy(bo.map<T *>(), data + chunk * chunk_size, bytes);
+        bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+        return bo;
+    }
+
+    // Copy the buffer of chunk back to data, after the run writing it
+    // finished.
+    inline void download(T *data, std::uint64_t size, std::uint64_t chunk) {
+        xrt::bo &bo = buffer(chunk);
+        const std::uint64_t bytes = length(size, chunk) * sizeof(T);
+        bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE, bytes, 0);
+        std::memcpy(data + chunk * chunk_size, bo.map<T *>(), bytes);
+    }
+
+private:
+    const std::uint64_t chunk_size;
+    std::array<xrt::bo, 2> buffers;
+};
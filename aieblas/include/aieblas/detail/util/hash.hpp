@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/*
+ * 64-bit FNV-1a hash, used for the content of generated files and to identify
+ * the design of a benchmark result. The benchmarks write it as 16 hex digits,
+ * which the aiesim tools compare against, so all of them must use this one.
+ */
+constexpr std::uint64_t fnv1a_basis = 0xcbf29ce484222325;
+
+constexpr std::uint64_t fnv1a(std::string_view content,
+                              std::uint64_t hash = fnv1a_basis) {
+    for (char c : content) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// Hash of the content of a file, nothing if it cannot be read.
+inline std::optional<std::uint64_t>
+fnv1a_file(const std::filesystem::path &file) {
+    std::ifstream in{file, std::ios::binary};
+    if (!in) {
+        return std::nullopt;
+    }
+    const std::string content{std::istreambuf_iterator<char>{in},
+                              std::istreambuf_iterator<char>{}};
+    return fnv1a(content);
+}
+
+inline std::string fnv1a_hex(std::uint64_t hash) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(hash));
+    return hex;
+}
@@ -1,12 +1,26 @@
 #pragma once
 
+#include <cstddef>
 #include <source_location>
 
 #include "aieblas/detail/util/cxx_compat.hpp"
 
+// Lowest log level compiled in, as a value of log_level, set by CMake through
+// AIEBLAS_LOG_MIN_LEVEL. Defaults to debug, keeping all messages.
+#ifndef AIEBLAS_LOG_MIN_LEVEL
+#define AIEBLAS_LOG_MIN_LEVEL 1
+#endif
+
+#define AIEBLAS_LOG_FIRST(first, ...) first
+
 // Use macro since we cannot combine source_location::current with variable
-// arguments
-#define log(...) aieblas::log_impl(std::source_location::current(), __VA_ARGS__)
+// arguments. The level is checked before the arguments are evaluated, so
+// messages with a constant level below AIEBLAS_LOG_MIN_LEVEL are removed by
+// the compiler.
+#define log(...) \
+    (aieblas::log_enabled(AIEBLAS_LOG_FIRST(__VA_ARGS__, 0)) \
+         ? aieblas::log_impl(std::source_location::current(), __VA_ARGS__) \
+         : void())
 
 namespace aieblas {
     enum class log_level : unsigned {
@@ -19,17 +33,44 @@ namespace aieblas {
         error
     };
 
+    constexpr log_level compiled_log_level =
+        static_cast<log_level>(AIEBLAS_LOG_MIN_LEVEL);
+
     void set_log_level(log_level level);
     log_level get_log_level();
     std::string log_header(log_level level, const std::source_location& loc);
 
+    inline bool log_enabled(log_level level) {
+        return level >= compiled_log_level && level >= get_log_level();
+    }
+
+    // Messages without a level are status messages
+    template <typename T>
+    inline bool log_enabled(const T &) {
+        return log_enabled(log_level::status);
+    }
+
+    /*
+     * Write log messages from a background thread, so that logging only
+     * formats a message and adds it to a queue. Messages keep their order,
+     * warnings and errors return once they are written, and the queue is
+     * written when the program exits or terminates. Enable and disable it
+     * while no other thread logs.
+     */
+    void enable_async_log(std::size_t capacity = 4096);
+    // Write the queued messages and stop the background thread
+    void disable_async_log();
+    // Write a formatted message, directly or through the background thread
+    void log_write(log_level level, std::string line);
+
     template <typename... Args>
     inline void log_impl(const std::source_location& loc, log_level level,
                          std::format_string<Args...> fmt, Args &&...args) {
         if (level >= get_log_level()) {
-            std::string message = std::format(std::runtime_format(fmt),
-                                            std::forward<Args>(args)...);
-            std::println("{}{}", log_header(level, loc), message);
+            std::string line = log_header(level, loc);
+            line.append(std::format(std::runtime_format(fmt),
+                                    std::forward<Args>(args)...));
+            log_write(level, std::move(line));
         }
     }
 
@@ -1,15 +1,28 @@
 #pragma once
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <exception>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <time.h>
+#endif
+
 template <class Clock>
 class Event {
 public:
     Event(std::string name, std::chrono::time_point<Clock> time_point)
-        : name(name), time_point(time_point) { }
+        : name(std::move(name)), time_point(time_point) { }
 
     const std::string name;
     const std::chrono::time_point<Clock> time_point;
@@ -29,7 +42,8 @@ public:
     Timer() { }
 
     inline const Event<Clock> &time_point(std::string name) {
-        return events.emplace_back(name, Clock::now());
+        const auto now = Clock::now();
+        return events.emplace_back(std::move(name), now);
     }
 
     inline const Event<Clock> &time_point() {
@@ -65,7 +79,7 @@ public:
     }
 
 private:
-    inline const Event<Clock> &get_event(std::string name) const {
+    inline const Event<Clock> &get_event(const std::string &name) const {
         auto it = std::find(events.begin(), events.end(), name);
         if (it == events.end()) {
             throw std::runtime_error("Timer does not contain event \"" + name
@@ -77,3 +91,285 @@ private:
 
     std::vector<Event<Clock>> events;
 };
+
+/*
+ * Tick sources of RegionTimer. ticks() is read at the start and end of every
+ * region, ns_per_tick() only when the ticks are converted.
+ */
+template <class Clock = std::chrono::steady_clock>
+struct ChronoTicks {
+    static inline std::uint64_t ticks() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+    }
+
+    static inline double ns_per_tick() {
+        return 1.0;
+    }
+};
+
+#ifdef __linux__
+// CLOCK_MONOTONIC_RAW, which is not slewed by NTP
+struct RawTicks {
+    static inline std::uint64_t ticks() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000 +
+               ts.tv_nsec;
+    }
+
+    static inline double ns_per_tick() {
+        return 1.0;
+    }
+};
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+/*
+ * Time stamp counter of the CPU, the cheapest to read. Assumes an invariant
+ * TSC, as on current x86 CPUs. The tick rate is measured against the steady
+ * clock the first time it is needed, which takes about 10 ms.
+ */
+struct TscTicks {
+    static inline std::uint64_t ticks() {
+        return __rdtsc();
+    }
+
+    static inline double ns_per_tick() {
+        static const double rate = [] {
+            using clock = std::chrono::steady_clock;
+            const auto start = clock::now();
+            const std::uint64_t start_ticks = __rdtsc();
+            while (clock::now() - start < std::chrono::milliseconds(10)) { }
+            const std::uint64_t end_ticks = __rdtsc();
+            const auto end = clock::now();
+            return std::chrono::duration<double, std::nano>(end - start)
+                       .count() / (end_ticks - start_ticks);
+        }();
+        return rate;
+    }
+};
+#endif
+
+/*
+ * Timer of nested regions, for timing hot paths. A region is registered once
+ * by name, and timed by the Scope returned by scope(), from its construction
+ * to its destruction. Regions are aggregated per path from the outermost
+ * region, so the same region opened in two places is counted separately.
+ *
+ * Opening and closing a region reads the tick source and appends to a ring
+ * of the last events, both without allocating, except for the first time a
+ * path is seen. Not thread safe, use a timer per thread.
+ */
+template <class Ticks = ChronoTicks<>>
+class RegionTimer {
+public:
+    static constexpr unsigned max_depth = 64;
+
+    struct RegionEvent {
+        std::uint64_t ticks;
+        // path of the region, see path()
+        std::uint32_t node;
+        bool begin;
+    };
+
+    struct RegionStats {
+        // names of the regions from the outermost, separated by '/'
+        std::string path;
+        unsigned depth;
+        std::uint64_t count;
+        double total_ns;
+        double min_ns;
+        double max_ns;
+
+        inline double mean_ns() const {
+            return count == 0 ? 0.0 : total_ns / count;
+        }
+    };
+
+    class Scope {
+    public:
+        inline ~Scope() {
+            if (timer) {
+                timer->end();
+            }
+        }
+
+        inline Scope(Scope &&other) noexcept
+            : timer(std::exchange(other.timer, nullptr)) { }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        Scope &operator=(Scope &&) = delete;
+
+    private:
+        friend class RegionTimer;
+        inline explicit Scope(RegionTimer *timer) : timer(timer) { }
+
+        RegionTimer *timer;
+    };
+
+    // ring_size events are kept, rounded up to a power of two
+    explicit RegionTimer(std::size_t ring_size = 4096) {
+        std::size_t size = 1;
+        while (size < ring_size) {
+            size *= 2;
+        }
+        ring.resize(size);
+        nodes.reserve(64);
+        nodes.push_back({root_region, 0, 0, {}, 0, 0, 0, 0});
+    }
+
+    // Id of the region with name, registered if new
+    inline std::uint32_t region(std::string_view name) {
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it != names.end()) {
+            return static_cast<std::uint32_t>(it - names.begin());
+        }
+        names.emplace_back(name);
+        return static_cast<std::uint32_t>(names.size() - 1);
+    }
+
+    [[nodiscard]] inline Scope scope(std::uint32_t region) {
+        if (depth == max_depth) {
+            throw std::runtime_error("RegionTimer regions nested deeper than "
+                                     + std::to_string(max_depth));
+        }
+        const std::uint32_t node = child(stack[depth].node, region);
+        stack[++depth].node = node;
+        const std::uint64_t now = Ticks::ticks();
+        stack[depth].start = now;
+        record(now, node, true);
+        return Scope(this);
+    }
+
+    // Aggregates of every path, parents before their children
+    std::vector<RegionStats> stats() const {
+        const double ns = Ticks::ns_per_tick();
+        std::vector<RegionStats> result;
+        visit(0, ns, result);
+        return result;
+    }
+
+    // Names of the regions of the path of an event, separated by '/'
+    std::string path(std::uint32_t node) const {
+        std::string result;
+        for (; node != 0; node = nodes[node].parent) {
+            const std::string &name = names[nodes[node].region];
+            result = result.empty() ? name : name + "/" + result;
+        }
+        return result;
+    }
+
+    // Events still in the ring, oldest first
+    std::vector<RegionEvent> events() const {
+        std::vector<RegionEvent> result;
+        const std::uint64_t kept = std::min<std::uint64_t>(recorded,
+                                                           ring.size());
+        for (std::uint64_t i = recorded - kept; i < recorded; ++i) {
+            result.push_back(ring[i & (ring.size() - 1)]);
+        }
+        return result;
+    }
+
+    // Nanoseconds of a number of ticks of the tick source
+    inline double ns(std::uint64_t ticks) const {
+        return ticks * Ticks::ns_per_tick();
+    }
+
+    /*
+     * Time an empty region adds to its parent, to correct times of regions
+     * that contain many short regions. Measured on a separate timer.
+     */
+    static double overhead_ns(unsigned samples = 10000) {
+        RegionTimer timer(16);
+        const std::uint32_t outer = timer.region("outer");
+        const std::uint32_t inner = timer.region("inner");
+        {
+            Scope scope = timer.scope(outer);
+            for (unsigned i = 0; i < samples; ++i) {
+                Scope empty = timer.scope(inner);
+            }
+        }
+        const std::vector<RegionStats> stats = timer.stats();
+        return stats[0].total_ns / samples;
+    }
+
+    // Forget all times and events, keeping the registered regions
+    void clear() {
+        if (depth != 0) {
+            throw std::runtime_error("RegionTimer cleared in a region");
+        }
+        nodes.resize(1);
+        nodes[0].children.clear();
+        recorded = 0;
+    }
+
+private:
+    static constexpr std::uint32_t root_region =
+        std::numeric_limits<std::uint32_t>::max();
+
+    struct Node {
+        std::uint32_t region;
+        std::uint32_t parent;
+        unsigned depth;
+        // (region, node) of every child
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> children;
+        std::uint64_t count;
+        std::uint64_t total;
+        std::uint64_t min;
+        std::uint64_t max;
+    };
+
+    struct Open {
+        std::uint32_t node;
+        std::uint64_t start;
+    };
+
+    inline std::uint32_t child(std::uint32_t parent, std::uint32_t region) {
+        for (const auto &[child_region, node] : nodes[parent].children) {
+            if (child_region == region) {
+                return node;
+            }
+        }
+        const std::uint32_t node = static_cast<std::uint32_t>(nodes.size());
+        nodes.push_back({region, parent, nodes[parent].depth + 1, {}, 0, 0,
+                         std::numeric_limits<std::uint64_t>::max(), 0});
+        nodes[parent].children.emplace_back(region, node);
+        return node;
+    }
+
+    inline void record(std::uint64_t ticks, std::uint32_t node, bool begin) {
+        ring[recorded++ & (ring.size() - 1)] = {ticks, node, begin};
+    }
+
+    inline void end() {
+        const std::uint64_t now = Ticks::ticks();
+        const Open open = stack[depth--];
+        const std::uint64_t elapsed = now - open.start;
+        Node &node = nodes[open.node];
+        node.count++;
+        node.total += elapsed;
+        node.min = std::min(node.min, elapsed);
+        node.max = std::max(node.max, elapsed);
+        record(now, open.node, false);
+    }
+
+    void visit(std::uint32_t index, double ns,
+               std::vector<RegionStats> &result) const {
+        for (const auto &[region, child] : nodes[index].children) {
+            const Node &node = nodes[child];
+            result.push_back({path(child), node.depth - 1, node.count,
+                              node.total * ns,
+                              node.count == 0 ? 0.0 : node.min * ns,
+                              node.max * ns});
+            visit(child, ns, result);
+        }
+    }
+
+    std::vector<std::string> names;
+    std::vector<Node> nodes;
+    std::array<Open, max_depth + 1> stack{};
+    unsigned depth = 0;
+    std::vector<RegionEvent> ring;
+    std::uint64_t recorded = 0;
+};
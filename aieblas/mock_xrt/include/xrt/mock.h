@@ -0,0 +1,302 @@
+#pragma once
+/*
+ * Mock of the subset of XRT used by the aieblas host programs, to run them
+ * without a card. Buffers live in host memory, with separate host and device
+ * copies so missing syncs are noticed. The routines of a design are executed
+ * on the CPU by handlers registered with add_routine, which the code generator
+ * emits in host/mock.cpp. Graph runtime parameters are kept by port name.
+ *
+ * Transfer and launch latency is modelled by waiting, configured through
+ * costs() or the environment variables:
+ *   AIEBLAS_MOCK_ALLOC_US:   latency of allocating a buffer
+ *   AIEBLAS_MOCK_SYNC_US:    fixed latency of a sync
+ *   AIEBLAS_MOCK_SYNC_GBPS:  bandwidth of a sync
+ *   AIEBLAS_MOCK_LAUNCH_US:  latency of starting a run
+ *   AIEBLAS_MOCK_UPDATE_US:  latency of updating a runtime parameter
+ *   AIEBLAS_MOCK_STREAM_GBPS: bandwidth at which routines move their buffers
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef unsigned int xrtMemoryGroup;
+
+enum xclBOSyncDirection {
+    XCL_BO_SYNC_BO_TO_DEVICE = 0,
+    XCL_BO_SYNC_BO_FROM_DEVICE
+};
+
+enum ert_cmd_state {
+    ERT_CMD_STATE_NEW = 1,
+    ERT_CMD_STATE_QUEUED = 2,
+    ERT_CMD_STATE_RUNNING = 3,
+    ERT_CMD_STATE_COMPLETED = 4,
+    ERT_CMD_STATE_ERROR = 5,
+    ERT_CMD_STATE_ABORT = 6,
+    ERT_CMD_STATE_TIMEOUT = 10
+};
+
+namespace xrt {
+namespace mock {
+
+struct cost_model {
+    double alloc_us;
+    double sync_us;
+    double sync_gbps;
+    double launch_us;
+    double update_us;
+    double stream_gbps;
+};
+
+// Atomic, as host programs may sync and launch from multiple threads
+struct counters {
+    std::atomic<std::uint64_t> allocs = 0;
+    std::atomic<std::uint64_t> syncs = 0;
+    std::atomic<std::uint64_t> sync_bytes = 0;
+    std::atomic<std::uint64_t> launches = 0;
+    std::atomic<std::uint64_t> updates = 0;
+    std::atomic<std::uint64_t> routines = 0;
+};
+
+inline double env_cost(const char *name, double fallback) {
+    const char *value = std::getenv(name);
+    return value == nullptr ? fallback : std::strtod(value, nullptr);
+}
+
+inline cost_model &costs() {
+    static cost_model model{env_cost("AIEBLAS_MOCK_ALLOC_US", 50.0),
+                            env_cost("AIEBLAS_MOCK_SYNC_US", 10.0),
+                            env_cost("AIEBLAS_MOCK_SYNC_GBPS", 12.0),
+                            env_cost("AIEBLAS_MOCK_LAUNCH_US", 5.0),
+                            env_cost("AIEBLAS_MOCK_UPDATE_US", 2.0),
+                            env_cost("AIEBLAS_MOCK_STREAM_GBPS", 25.0)};
+    return model;
+}
+
+inline counters &stats() {
+    static counters c;
+    return c;
+}
+
+/*
+ * Sleeping overshoots by tens of microseconds, more than most modelled
+ * latencies, so the last spin_us of a delay are spent spinning on the clock.
+ */
+constexpr double spin_us = 100.0;
+
+inline void delay(double us) {
+    if (us <= 0) {
+        return;
+    }
+    using clock = std::chrono::steady_clock;
+    const clock::time_point end = clock::now() +
+        std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double, std::micro>(us));
+    if (us > spin_us) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(
+            us - spin_us));
+    }
+    while (clock::now() < end) { }
+}
+
+// Time in microseconds to move bytes at gbps GB/s.
+inline double transfer_us(std::uint64_t bytes, double gbps) {
+    return gbps > 0 ? static_cast<double>(bytes) / (gbps * 1e3) : 0.0;
+}
+
+struct buffer {
+    std::vector<std::byte> host;
+    std::vector<std::byte> device;
+    std::uint64_t address;
+};
+
+// Device address of a new buffer of size bytes, aligned like XRT buffers.
+inline std::uint64_t allocate_address(std::uint64_t size) {
+    static std::atomic<std::uint64_t> next = 0x1000;
+    return next.fetch_add((size + 0xfff) & ~std::uint64_t{0xfff});
+}
+
+// Argument of a run, either (a part of) a buffer or the bytes of a scalar.
+struct argument {
+    std::shared_ptr<buffer> bo;
+    std::size_t offset;
+    std::size_t size;
+    std::vector<std::byte> bytes;
+};
+
+// Latest value of every runtime parameter port, updated through xrt::graph.
+class parameters {
+public:
+    static void set(const std::string &port, std::vector<std::byte> bytes) {
+        std::lock_guard<std::mutex> lock(mutex());
+        values()[port] = std::move(bytes);
+    }
+
+    static std::vector<std::byte> get(const std::string &port) {
+        std::lock_guard<std::mutex> lock(mutex());
+        auto value = values().find(port);
+        if (value == values().end()) {
+            throw std::runtime_error("mock XRT: runtime parameter " + port +
+                                     " was not set");
+        }
+        return value->second;
+    }
+
+private:
+    static std::mutex &mutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    static std::map<std::string, std::vector<std::byte>> &values() {
+        static std::map<std::string, std::vector<std::byte>> v;
+        return v;
+    }
+};
+
+struct run_state {
+    std::string kernel;
+    std::map<int, argument> args;
+    ert_cmd_state state = ERT_CMD_STATE_NEW;
+};
+
+/*
+ * Arguments of the runs taking part in one execution of a routine, looked up
+ * by PL kernel name and argument index.
+ */
+class routine {
+public:
+    explicit routine(std::map<std::string, std::shared_ptr<run_state>> runs)
+        : runs(std::move(runs)) { }
+
+    template <typename T>
+    T *buffer(const std::string &kernel, int index) {
+        const argument &arg = get(kernel, index);
+        if (!arg.bo) {
+            throw std::runtime_error("mock XRT: argument " +
+                                     std::to_string(index) + " of " + kernel +
+                                     " is not a buffer");
+        }
+        moved += arg.size;
+        return reinterpret_cast<T *>(arg.bo->device.data() + arg.offset);
+    }
+
+    template <typename T>
+    T scalar(const std::string &kernel, int index) {
+        const argument &arg = get(kernel, index);
+        T value{};
+        std::memcpy(&value, arg.bytes.data(),
+                    std::min(sizeof(T), arg.bytes.size()));
+        return value;
+    }
+
+    template <typename T>
+    T parameter(const std::string &port) {
+        const std::vector<std::byte> bytes = parameters::get(port);
+        T value{};
+        std::memcpy(&value, bytes.data(), std::min(sizeof(T), bytes.size()));
+        return value;
+    }
+
+    // Bytes of all buffers accessed by the routine
+    std::uint64_t moved = 0;
+
+private:
+    const argument &get(const std::string &kernel, int index) {
+        auto run = runs.find(kernel);
+        if (run == runs.end()) {
+            throw std::runtime_error("mock XRT: routine has no kernel " +
+                                     kernel);
+        }
+        auto arg = run->second->args.find(index);
+        if (arg == run->second->args.end()) {
+            throw std::runtime_error("mock XRT: argument " +
+                                     std::to_string(index) + " of " + kernel +
+                                     " was not set");
+        }
+        return arg->second;
+    }
+
+    std::map<std::string, std::shared_ptr<run_state>> runs;
+};
+
+using handler = std::function<void(routine &)>;
+
+/*
+ * A routine executes once a run of each of its PL kernels was started, like
+ * the AIE graph only makes progress when all its movers are running.
+ */
+struct registered_routine {
+    std::vector<std::string> kernels;
+    handler execute;
+};
+
+inline std::vector<registered_routine> &routines() {
+    static std::vector<registered_routine> r;
+    return r;
+}
+
+// Started runs per kernel that did not execute yet
+inline std::map<std::string, std::deque<std::shared_ptr<run_state>>> &
+pending() {
+    static std::map<std::string, std::deque<std::shared_ptr<run_state>>> p;
+    return p;
+}
+
+// Returns a value so it can initialize a static in the generated code.
+inline bool add_routine(std::vector<std::string> kernels, handler execute) {
+    routines().emplace_back(std::move(kernels), std::move(execute));
+    return true;
+}
+
+inline void dispatch(const std::shared_ptr<run_state> &run) {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (registered_routine &r : routines()) {
+        if (std::find(r.kernels.begin(), r.kernels.end(), run->kernel) ==
+            r.kernels.end()) {
+            continue;
+        }
+
+        pending()[run->kernel].push_back(run);
+        const bool ready = std::all_of(r.kernels.begin(), r.kernels.end(),
+            [](const std::string &k) { return !pending()[k].empty(); });
+        if (!ready) {
+            return;
+        }
+
+        std::map<std::string, std::shared_ptr<run_state>> runs;
+        for (const std::string &k : r.kernels) {
+            runs.emplace(k, pending()[k].front());
+            pending()[k].pop_front();
+        }
+        routine ctx{runs};
+        r.execute(ctx);
+        delay(transfer_us(ctx.moved, costs().stream_gbps));
+        stats().routines++;
+        for (auto &[k, state] : runs) {
+            state->state = ERT_CMD_STATE_COMPLETED;
+        }
+        return;
+    }
+
+    // Kernels outside of any routine finish immediately
+    run->state = ERT_CMD_STATE_COMPLETED;
+}
+
+} // mock
+} // xrt
@@ -0,0 +1,77 @@
+#pragma once
+#include "mock.h"
+#include "xrt_device.h"
+
+namespace xrt {
+
+class bo {
+public:
+    bo() { }
+
+    bo(const device &, std::size_t size, xrtMemoryGroup)
+        : buffer(std::make_shared<mock::buffer>()), size_(size) {
+        buffer->host.resize(size);
+        buffer->device.resize(size);
+        buffer->address = mock::allocate_address(size);
+        mock::stats().allocs++;
+        mock::delay(mock::costs().alloc_us);
+    }
+
+    // Sub-buffer sharing the memory of parent, which is not an allocation
+    bo(const bo &parent, std::size_t size, std::size_t offset)
+        : buffer(parent.buffer), offset_(parent.offset_ + offset),
+          size_(size) {
+        if (offset + size > parent.size_) {
+            throw std::runtime_error("mock XRT: sub-buffer exceeds its "
+                                     "parent");
+        }
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    std::uint64_t address() const {
+        return buffer ? buffer->address + offset_ : 0;
+    }
+
+    template <typename T>
+    T map() {
+        return reinterpret_cast<T>(buffer->host.data() + offset_);
+    }
+
+    void sync(xclBOSyncDirection dir, std::size_t size, std::size_t offset) {
+        offset += offset_;
+        if (dir == XCL_BO_SYNC_BO_TO_DEVICE) {
+            std::memcpy(buffer->device.data() + offset,
+                        buffer->host.data() + offset, size);
+        } else {
+            std::memcpy(buffer->host.data() + offset,
+                        buffer->device.data() + offset, size);
+        }
+        mock::stats().syncs++;
+        mock::stats().sync_bytes += size;
+        mock::delay(mock::costs().sync_us +
+                    mock::transfer_us(size, mock::costs().sync_gbps));
+    }
+
+    void sync(xclBOSyncDirection dir) {
+        sync(dir, size(), 0);
+    }
+
+    // Shared state, used by xrt::run to access the device copy
+    const std::shared_ptr<mock::buffer> &state() const {
+        return buffer;
+    }
+
+    std::size_t offset() const {
+        return offset_;
+    }
+
+private:
+    std::shared_ptr<mock::buffer> buffer;
+    std::size_t offset_ = 0;
+    std::size_t size_ = 0;
+};
+
+} // xrt
@@ -0,0 +1,21 @@
+#pragma once
+#include "mock.h"
+#include "xrt_uuid.h"
+
+namespace xrt {
+
+class device {
+public:
+    device() { }
+    explicit device(unsigned int index) : index(index) { }
+
+    // The mock does not read the xclbin, routines are registered instead
+    uuid load_xclbin(const std::string &xclbin) {
+        return uuid{xclbin};
+    }
+
+private:
+    unsigned int index = 0;
+};
+
+} // xrt
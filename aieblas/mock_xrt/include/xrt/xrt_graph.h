@@ -0,0 +1,34 @@
+#pragma once
+#include <type_traits>
+#include "mock.h"
+#include "xrt_device.h"
+#include "xrt_uuid.h"
+
+namespace xrt {
+
+class graph {
+public:
+    graph() { }
+    graph(const device &, const uuid &, const std::string &name)
+        : name_(name) { }
+
+    // Like XRT, port is the full name of the port, e.g. mygraph.k.in[0]
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    void update(const std::string &port, const T &value) {
+        std::vector<std::byte> bytes(sizeof(T));
+        std::memcpy(bytes.data(), &value, sizeof(T));
+        mock::parameters::set(port, std::move(bytes));
+        mock::stats().updates++;
+        mock::delay(mock::costs().update_us);
+    }
+
+    const std::string &name() const {
+        return name_;
+    }
+
+private:
+    std::string name_;
+};
+
+} // xrt
@@ -0,0 +1,88 @@
+#pragma once
+#include <type_traits>
+#include "mock.h"
+#include "xrt_bo.h"
+#include "xrt_device.h"
+#include "xrt_uuid.h"
+
+namespace xrt {
+
+class kernel {
+public:
+    kernel() { }
+    kernel(const device &, const uuid &, const std::string &name)
+        : name_(name) { }
+
+    // All buffers share host memory, any bank will do
+    xrtMemoryGroup group_id(int) const {
+        return 0;
+    }
+
+    const std::string &name() const {
+        return name_;
+    }
+
+private:
+    std::string name_;
+};
+
+class run {
+public:
+    run() { }
+    explicit run(const kernel &kernel)
+        : state_(std::make_shared<mock::run_state>()) {
+        state_->kernel = kernel.name();
+    }
+
+    void set_arg(int index, const bo &buffer) {
+        state_->args[index] = mock::argument{buffer.state(), buffer.offset(),
+                                             buffer.size(), {}};
+    }
+
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    void set_arg(int index, const T &value) {
+        std::vector<std::byte> bytes(sizeof(T));
+        std::memcpy(bytes.data(), &value, sizeof(T));
+        state_->args[index] = mock::argument{nullptr, 0, 0, std::move(bytes)};
+    }
+
+    void start() {
+        if (state_->state == ERT_CMD_STATE_RUNNING) {
+            throw std::runtime_error("mock XRT: run of " + state_->kernel +
+                                     " started while running");
+        }
+        // Later set_arg calls must not change the arguments of this run
+        state_ = std::make_shared<mock::run_state>(*state_);
+        state_->state = ERT_CMD_STATE_RUNNING;
+        mock::stats().launches++;
+        mock::delay(mock::costs().launch_us);
+        mock::dispatch(state_);
+    }
+
+    /*
+     * The mock runs routines synchronously, so a run that did not finish
+     * waits for kernels that were never started. That only times out on
+     * hardware, so without a timeout this throws instead of hanging.
+     */
+    ert_cmd_state wait(const std::chrono::milliseconds &timeout =
+                           std::chrono::milliseconds{0}) {
+        if (state_->state == ERT_CMD_STATE_COMPLETED) {
+            return ERT_CMD_STATE_COMPLETED;
+        } else if (timeout.count() == 0) {
+            throw std::runtime_error("mock XRT: run of " + state_->kernel +
+                                     " can not finish, not all kernels of "
+                                     "its routine were started");
+        }
+        return ERT_CMD_STATE_TIMEOUT;
+    }
+
+    ert_cmd_state state() const {
+        return state_->state;
+    }
+
+private:
+    std::shared_ptr<mock::run_state> state_;
+};
+
+} // xrt
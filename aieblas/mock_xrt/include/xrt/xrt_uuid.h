@@ -0,0 +1,19 @@
+#pragma once
+#include "mock.h"
+
+namespace xrt {
+
+class uuid {
+public:
+    uuid() { }
+    explicit uuid(std::string xclbin) : xclbin(std::move(xclbin)) { }
+
+    std::string to_string() const {
+        return xclbin;
+    }
+
+private:
+    std::string xclbin;
+};
+
+} // xrt
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "aieblas/aiesim.hpp"
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/aiesim/profile.hpp"
+#include "aieblas/detail/aiesim/trace.hpp"
+
+using json = nlohmann::json;
+
+namespace aieblas {
+namespace aiesim {
+
+struct sample {
+    double x;
+    double y;
+};
+
+struct line_fit {
+    double slope;
+    double intercept;
+};
+
+// Least squares fit of y = slope * x + intercept, nullopt if x is constant
+static std::optional<line_fit> fit_line(const std::vector<sample> &samples) {
+    double mean_x = 0, mean_y = 0;
+    for (const sample &s : samples) {
+        mean_x += s.x;
+        mean_y += s.y;
+    }
+    mean_x /= samples.size();
+    mean_y /= samples.size();
+
+    double cov = 0, var = 0;
+    for (const sample &s : samples) {
+        cov += (s.x - mean_x) * (s.y - mean_y);
+        var += (s.x - mean_x) * (s.x - mean_x);
+    }
+    if (var == 0) {
+        return std::nullopt;
+    }
+    return line_fit{cov / var, mean_y - cov / var * mean_x};
+}
+
+/*
+ * Fit the cost of an operation to (vectors per window, cycles per window)
+ * samples. With a single window size, only the cycles per vector can be
+ * fitted and the window overhead of the profile is kept.
+ */
+static void fit_op(op_cost &cost, const std::vector<sample> &samples) {
+    const std::optional<line_fit> fit = fit_line(samples);
+    if (fit && fit->intercept >= 0) {
+        cost.cycles_per_vector = fit->slope;
+        cost.window_overhead = fit->intercept;
+    } else {
+        double sum = 0;
+        for (const sample &s : samples) {
+            sum += (s.y - cost.window_overhead) / s.x;
+        }
+        cost.cycles_per_vector = sum / samples.size();
+    }
+    cost.samples = samples.size();
+}
+
+struct sim_samples {
+    // per op and type: vectors per window, AIE cycles per window
+    std::map<std::string, std::map<std::string, std::vector<sample>>> windows;
+    // PL cycles per beat
+    std::vector<double> beats;
+};
+
+/*
+ * Collect the samples of the output PLIOs of a simulated design. The
+ * interval between beats gives the cycles per beat of the movers, the gaps
+ * between windows the cycles per window of the kernel.
+ */
+static void collect_design(const calibrate_options &options,
+                           const profile &p, const fs::path &design,
+                           sim_samples &samples) {
+    const std::vector<kernel_shape> kernels = parse_design_kernels(design);
+    for (const plio_port &port :
+         parse_graph_plios(design / "aie" / "graph.hpp")) {
+        if (port.input) {
+            continue;
+        }
+
+        const kernel_shape *k = find_kernel(kernels, port.name);
+        const fs::path output_file = design / options.output / port.file;
+        if (!k) {
+            log(log_level::warning, "No kernel for port {} of '{}'",
+                port.name, design.native());
+            continue;
+        } else if (!fs::exists(output_file)) {
+            log(log_level::warning, "No output for {} in '{}'", port.name,
+                output_file.native());
+            continue;
+        }
+
+        const plio_trace trace = parse_plio_file(output_file);
+        if (!trace.timed()) {
+            log(log_level::verbose, "Output of {} has no times", port.name);
+            continue;
+        }
+        const port_timing timing = analyze_timing(trace, port.bits,
+                                                  options.gap_factor);
+        if (timing.median_interval_ns == 0) {
+            continue;
+        }
+        samples.beats.push_back(timing.median_interval_ns *
+                                p.pl_clock_mhz / 1000.0);
+
+        if (timing.stalls == 0) {
+            continue;
+        }
+        // The span from the first to the last beat covers a period per
+        // stall, and the beats of the last window
+        const double windows = timing.stalls + 1;
+        const double beats_per_window = timing.beats / windows;
+        const double period_ns = (timing.last_ns - timing.first_ns -
+                                  (beats_per_window - 1) *
+                                  timing.median_interval_ns) / timing.stalls;
+        samples.windows[k->op][k->type].push_back(
+            {k->vectors_per_window(), period_ns * p.aie_clock_mhz / 1000.0});
+    }
+}
+
+/*
+ * Records of benchmark/util/include/write_results.hpp and of the benchmark
+ * driver of a design. Results of the same routine on different designs are
+ * fitted separately, as <routine>@<design hash>.
+ */
+static void collect_jsonl(std::ifstream &in, const fs::path &file,
+                          std::map<std::string, std::vector<sample>> &results) {
+    std::string line;
+    std::size_t line_nr = 0;
+    while (std::getline(in, line)) {
+        line_nr++;
+        if (line.empty()) {
+            continue;
+        }
+
+        try {
+            const json record = json::parse(line);
+            std::string name = record.at("routine").get<std::string>();
+            const std::string hash =
+                record.at("design").at("hash").get<std::string>();
+            if (!hash.empty()) {
+                name += "@" + hash.substr(0, 8);
+            }
+            // Matrices count every element
+            const double n = record.at("n").get<double>();
+            const double m = record.at("m").get<double>();
+            const json &median = record.at("stats_ms").at("median");
+            if (median.is_number()) {
+                results[name].push_back({m == 0 ? n : n * m,
+                                         median.get<double>()});
+            }
+        } catch (const json::exception &e) {
+            throw trace_error(std::format("invalid result on line {} of "
+                                          "'{}': {}", line_nr, file.native(),
+                                          e.what()));
+        }
+    }
+}
+
+bool calibrate(const calibrate_options &options) {
+    profile p;
+    if (fs::exists(options.profile)) {
+        p = load_profile(options.profile);
+    }
+
+    sim_samples sim;
+    for (const fs::path &design : options.designs) {
+        collect_design(options, p, design, sim);
+    }
+    std::map<std::string, std::vector<sample>> results;
+    for (const fs::path &file : options.results) {
+        std::ifstream in{file};
+        if (!in) {
+            throw trace_error(std::format("cannot open '{}'", file.native()));
+        }
+        collect_jsonl(in, file, results);
+    }
+
+    std::println("{:<8} {:<8} {:>8} {:>12} {:>12} {:>10}", "op", "type",
+                 "samples", "cycles/vec", "overhead", "max error");
+    for (const auto &[op, types] : sim.windows) {
+        for (const auto &[type, samples] : types) {
+            op_cost &cost = p.ops[op][type];
+            fit_op(cost, samples);
+
+            double max_error = 0;
+            for (const sample &s : samples) {
+                const double fitted = cost.window_overhead +
+                                      cost.cycles_per_vector * s.x;
+                max_error = std::max(max_error, std::abs(fitted - s.y) / s.y);
+            }
+            std::println("{:<8} {:<8} {:>8} {:>12.2f} {:>12.1f} {:>9.1f}%",
+                         op, type, samples.size(), cost.cycles_per_vector,
+                         cost.window_overhead, max_error * 100);
+        }
+    }
+
+    if (!sim.beats.empty()) {
+        std::sort(sim.beats.begin(), sim.beats.end());
+        p.mover_ii = sim.beats[sim.beats.size() / 2];
+        p.mover_samples = sim.beats.size();
+        std::println("movers: {:.2f} cycles per beat from {} ports",
+                     p.mover_ii, p.mover_samples);
+    }
+
+    // The intercept of time against size is the fixed cost of a call
+    std::vector<double> setups;
+    for (const auto &[name, samples] : results) {
+        const std::optional<line_fit> fit = fit_line(samples);
+        if (!fit) {
+            log(log_level::warning, "Results of {} need at least two sizes",
+                name);
+            continue;
+        }
+        p.benchmark_ns_per_element[name] = fit->slope * 1e6;
+        setups.push_back(std::max(0.0, fit->intercept * 1000.0));
+        std::println("{}: {:.3f} ns per element, {:.1f} us setup", name,
+                     fit->slope * 1e6, fit->intercept * 1000.0);
+    }
+    if (!setups.empty()) {
+        double sum = 0;
+        for (double setup : setups) {
+            sum += setup;
+        }
+        p.host_setup_us = sum / setups.size();
+        p.host_samples = setups.size();
+    }
+
+    if (sim.windows.empty() && sim.beats.empty() && setups.empty()) {
+        log(log_level::warning, "No timing data to calibrate from");
+        return false;
+    }
+    save_profile(p, options.profile);
+    return true;
+}
+
+} // aiesim
+} // aieblas
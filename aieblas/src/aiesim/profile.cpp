@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/aiesim/profile.hpp"
+#include "aieblas/detail/aiesim/trace.hpp"
+
+using json = nlohmann::json;
+
+namespace aieblas {
+namespace aiesim {
+
+const op_cost &profile::cost(const std::string &op,
+                             const std::string &type) const {
+    static const op_cost uncalibrated;
+    const auto op_it = ops.find(op);
+    if (op_it == ops.end()) {
+        return uncalibrated;
+    }
+    const auto type_it = op_it->second.find(type);
+    if (type_it == op_it->second.end()) {
+        return uncalibrated;
+    }
+    return type_it->second;
+}
+
+profile load_profile(const fs::path &file) {
+    std::ifstream in{file};
+    if (!in) {
+        throw trace_error(std::format("cannot open '{}'", file.native()));
+    }
+
+    profile p;
+    try {
+        const json data = json::parse(in);
+        const unsigned version = data.at("version").get<unsigned>();
+        if (version != profile::version) {
+            throw trace_error(std::format("'{}' is a version {} profile, "
+                                          "expected version {}",
+                                          file.native(), version,
+                                          profile::version));
+        }
+
+        p.aie_clock_mhz = data.at("clocks").at("aie_mhz").get<double>();
+        p.pl_clock_mhz = data.at("clocks").at("pl_mhz").get<double>();
+        for (const auto &[op, types] : data.at("ops").items()) {
+            for (const auto &[type, cost] : types.items()) {
+                p.ops[op][type] = {
+                    cost.at("cycles_per_vector").get<double>(),
+                    cost.at("window_overhead").get<double>(),
+                    cost.at("samples").get<std::size_t>()};
+            }
+        }
+        p.mover_ii = data.at("movers").at("ii").get<double>();
+        p.mover_samples = data.at("movers").at("samples").get<std::size_t>();
+        p.host_setup_us = data.at("host").at("setup_us").get<double>();
+        p.host_samples = data.at("host").at("samples").get<std::size_t>();
+        for (const auto &[name, bench] : data.at("benchmarks").items()) {
+            p.benchmark_ns_per_element[name] =
+                bench.at("ns_per_element").get<double>();
+        }
+    } catch (const json::exception &e) {
+        throw trace_error(std::format("invalid profile '{}': {}",
+                                      file.native(), e.what()));
+    }
+    return p;
+}
+
+void save_profile(const profile &p, const fs::path &file) {
+    json data;
+    data["version"] = profile::version;
+    data["clocks"] = {{"aie_mhz", p.aie_clock_mhz},
+                      {"pl_mhz", p.pl_clock_mhz}};
+    data["ops"] = json::object();
+    for (const auto &[op, types] : p.ops) {
+        for (const auto &[type, cost] : types) {
+            data["ops"][op][type] = {
+                {"cycles_per_vector", cost.cycles_per_vector},
+                {"window_overhead", cost.window_overhead},
+                {"samples", cost.samples}};
+        }
+    }
+    data["movers"] = {{"ii", p.mover_ii}, {"samples", p.mover_samples}};
+    data["host"] = {{"setup_us", p.host_setup_us},
+                    {"samples", p.host_samples}};
+    data["benchmarks"] = json::object();
+    for (const auto &[name, ns] : p.benchmark_ns_per_element) {
+        data["benchmarks"][name] = {{"ns_per_element", ns}};
+    }
+
+    std::ofstream out{file};
+    if (!out) {
+        throw trace_error(std::format("cannot write '{}'", file.native()));
+    }
+    out << data.dump(4) << '\n';
+    log(log_level::status, "Wrote profile to '{}'", file.native());
+}
+
+static unsigned type_bits(const std::string &type) {
+    if (type == "int8" || type == "uint8") {
+        return 8;
+    } else if (type == "int16" || type == "uint16") {
+        return 16;
+    } else if (type == "int64" || type == "uint64") {
+        return 64;
+    }
+    return 32;
+}
+
+fs::path design_json(const fs::path &design) {
+    const fs::path manifest_file = design / "manifest.json";
+    std::ifstream manifest_in{manifest_file};
+    if (!manifest_in) {
+        throw trace_error(std::format("cannot open '{}'",
+                                      manifest_file.native()));
+    }
+
+    try {
+        return json::parse(manifest_in).at("design").get<std::string>();
+    } catch (const json::exception &e) {
+        throw trace_error(std::format("invalid manifest '{}': {}",
+                                      manifest_file.native(), e.what()));
+    }
+}
+
+std::vector<kernel_shape> parse_design_kernels(const fs::path &design) {
+    const fs::path json_file = design_json(design);
+    std::vector<kernel_shape> kernels;
+    try {
+        std::ifstream json_in{json_file};
+        if (!json_in) {
+            throw trace_error(std::format("cannot open design '{}' of '{}'",
+                                          json_file.native(),
+                                          design.native()));
+        }
+
+        // Defaults as in the code generator
+        const json data = json::parse(json_in);
+        for (const json &item : data.at("kernels")) {
+            kernel_shape k;
+            k.op = item.at("blas_op").get<std::string>();
+            k.user_name = item.at("user_name").get<std::string>();
+            k.type = item.at("type").get<std::string>();
+            k.type_bits = type_bits(k.type);
+            k.vsize = item.value("vector_size", 0u);
+            k.wsize = item.value("window_size", 128u);
+            k.replicas = item.value("replicas", 1u);
+            k.plio_width = item.value("plio_width", 0u);
+            kernels.push_back(std::move(k));
+        }
+    } catch (const json::exception &e) {
+        throw trace_error(std::format("invalid design '{}': {}",
+                                      design.native(), e.what()));
+    }
+    return kernels;
+}
+
+const kernel_shape *find_kernel(const std::vector<kernel_shape> &kernels,
+                                const std::string &port) {
+    // Ports are named <user_name>_<parameter>, user names may contain '_'
+    const kernel_shape *found = nullptr;
+    for (const kernel_shape &k : kernels) {
+        if (port.starts_with(k.user_name + "_") &&
+            (!found || k.user_name.size() > found->user_name.size())) {
+            found = &k;
+        }
+    }
+    return found;
+}
+
+estimate estimate_call(const profile &p, const kernel_shape &k,
+                       std::uint64_t size) {
+    const op_cost &cost = p.cost(k.op, k.type);
+    const std::uint64_t per_replica = (size + k.replicas - 1) / k.replicas;
+    const std::uint64_t windows = (per_replica + k.samples() - 1) /
+                                  k.samples();
+    const double aie_ns = windows * (cost.window_overhead +
+                                     cost.cycles_per_vector *
+                                     k.vectors_per_window()) /
+                          (p.aie_clock_mhz / 1000.0);
+
+    const std::uint64_t elements_per_beat =
+        k.plio_width == 0 ? 1 : k.plio_width / k.type_bits;
+    const std::uint64_t beats = (per_replica + elements_per_beat - 1) /
+                                elements_per_beat;
+    const double mover_ns = beats * p.mover_ii / (p.pl_clock_mhz / 1000.0);
+
+    return {p.host_setup_us * 1000.0, aie_ns, mover_ns};
+}
+
+} // aiesim
+} // aieblas
@@ -0,0 +1,103 @@
+#include "aieblas/aiesim.hpp"
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/aiesim/profile.hpp"
+#include "aieblas/detail/aiesim/trace.hpp"
+
+namespace aieblas {
+namespace aiesim {
+
+// Value of a timing measure, if the output has times
+static std::string format_timed(bool timed, double value, int precision) {
+    if (!timed) {
+        return "-";
+    }
+    return std::format("{:.{}f}", value, precision);
+}
+
+static std::string format_diff(const golden_diff &diff) {
+    if (diff.ok()) {
+        return "ok";
+    } else if (diff.values != diff.expected) {
+        return std::format("{} of {} values", diff.values, diff.expected);
+    }
+    return std::format("{} differ, first at {}, max error {:.3g}",
+                       diff.mismatches, *diff.first_mismatch,
+                       diff.max_error);
+}
+
+bool report(const report_options &options) {
+    const fs::path graph_hdr = options.design / "aie" / "graph.hpp";
+    bool ok = true;
+
+    std::optional<profile> model;
+    std::vector<kernel_shape> kernels;
+    if (!options.profile.empty()) {
+        model = load_profile(options.profile);
+        kernels = parse_design_kernels(options.design);
+    }
+
+    std::println("{:<24} {:>8} {:>12} {:>8} {:>12} {:>7} {:>12} {:>12} "
+                 "{:>12} {:>12}  {}", "port", "beats", "latency(ns)", "GB/s",
+                 "interval(ns)", "stalls", "stall(ns)", "max gap(ns)",
+                 "span(ns)", "model(ns)", "golden");
+    for (const plio_port &port : parse_graph_plios(graph_hdr)) {
+        if (port.input) {
+            continue;
+        }
+
+        const fs::path output_file = options.design / options.output /
+                                     port.file;
+        if (!fs::exists(output_file)) {
+            log(log_level::warning, "No output for {} in '{}'", port.name,
+                output_file.native());
+            ok = false;
+            continue;
+        }
+        const plio_trace trace = parse_plio_file(output_file);
+        const port_timing timing = analyze_timing(trace, port.bits,
+                                                  options.gap_factor);
+
+        std::string golden = "-";
+        const fs::path golden_file = options.design / options.golden /
+                                     port.file.filename();
+        if (fs::exists(golden_file)) {
+            const golden_diff diff = compare_golden(
+                trace, parse_plio_file(golden_file), options.tolerance);
+            golden = format_diff(diff);
+            ok = ok && diff.ok();
+        }
+
+        // Time the model expects from the first to the last output beat
+        std::string modelled = "-";
+        if (model) {
+            const kernel_shape *k = find_kernel(kernels, port.name);
+            if (k) {
+                std::size_t values = 0;
+                for (const beat &b : trace.beats) {
+                    values += b.values.size();
+                }
+                const estimate e = estimate_call(*model, *k,
+                                                 values * k->replicas);
+                modelled = std::format("{:.1f}", e.stream_ns());
+            }
+        }
+
+        // Rates need at least two beats with times
+        const bool timed = trace.timed();
+        const bool rated = timed && timing.last_ns > timing.first_ns;
+        std::println("{:<24} {:>8} {:>12} {:>8} {:>12} {:>7} {:>12} {:>12} "
+                     "{:>12} {:>12}  {}", port.name, timing.beats,
+                     format_timed(timed, timing.first_ns, 1),
+                     format_timed(rated, timing.throughput_gbps(), 3),
+                     format_timed(rated, timing.median_interval_ns, 2),
+                     rated ? std::to_string(timing.stalls) : "-",
+                     format_timed(rated, timing.stall_ns, 1),
+                     format_timed(rated, timing.max_stall_ns, 1),
+                     format_timed(rated, timing.last_ns - timing.first_ns, 1),
+                     modelled, golden);
+    }
+    return ok;
+}
+
+} // aiesim
+} // aieblas
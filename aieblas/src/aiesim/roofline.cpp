@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <regex>
+#include <set>
+#include <tuple>
+
+#include "aieblas/aiesim.hpp"
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/util/hash.hpp"
+#include "aieblas/detail/aiesim/profile.hpp"
+#include "aieblas/detail/aiesim/trace.hpp"
+
+using json = nlohmann::json;
+
+namespace aieblas {
+namespace aiesim {
+
+// Length of a vector argument, for a matrix of m rows and n columns
+enum class extent { n, m, nm };
+
+struct vector_arg {
+    std::string name;
+    extent length;
+};
+
+/*
+ * Vector arguments of an operation, moved through a PLIO unless connected
+ * to another kernel, and the multiply-accumulates per element. Other ports
+ * carry scalars, which are ignored.
+ */
+struct op_traffic {
+    std::vector<vector_arg> args;
+    extent elements;
+    double macs_per_element;
+};
+
+static const op_traffic *find_traffic(const std::string &op) {
+    static const std::map<std::string, op_traffic> ops = {
+        {"asum", {{{"x", extent::n}}, extent::n, 1}},
+        {"axpy", {{{"x", extent::n}, {"y", extent::n}, {"out", extent::n}},
+                  extent::n, 1}},
+        {"dot", {{{"x", extent::n}, {"y", extent::n}}, extent::n, 1}},
+        {"gemv", {{{"A", extent::nm}, {"x", extent::n}, {"y", extent::m},
+                   {"out", extent::m}}, extent::nm, 1}},
+        {"iamax", {{{"x", extent::n}}, extent::n, 1}},
+        {"nrm2", {{{"x", extent::n}}, extent::n, 1}},
+        {"rot", {{{"x", extent::n}, {"y", extent::n}, {"out_x", extent::n},
+                  {"out_y", extent::n}}, extent::n, 4}},
+        {"scal", {{{"x", extent::n}, {"out", extent::n}}, extent::n, 1}},
+    };
+    const auto it = ops.find(op);
+    return it == ops.end() ? nullptr : &it->second;
+}
+
+static double length(extent e, std::uint64_t n, std::uint64_t m) {
+    switch (e) {
+    case extent::n: return n;
+    case extent::m: return m;
+    case extent::nm: return static_cast<double>(n) * m;
+    }
+    return 0;
+}
+
+// Multiply-accumulates per cycle of an AIE tile
+static unsigned macs_per_cycle(const std::string &type) {
+    if (type == "int8" || type == "uint8") {
+        return 128;
+    } else if (type == "int16" || type == "uint16") {
+        return 32;
+    }
+    return 8;
+}
+
+// Hash of a file, as written to the results
+static std::string hash_file(const fs::path &file) {
+    const std::optional<std::uint64_t> hash = fnv1a_file(file);
+    if (!hash) {
+        throw trace_error(std::format("cannot open '{}'", file.native()));
+    }
+    return fnv1a_hex(*hash);
+}
+
+struct design_roof {
+    fs::path dir;
+    fs::path json_file;
+    std::vector<kernel_shape> kernels;
+    std::vector<plio_port> ports;
+    double pl_mhz;
+    unsigned ddr_channels;
+};
+
+static design_roof parse_design(const fs::path &dir, const profile &p) {
+    design_roof d{dir, design_json(dir), parse_design_kernels(dir),
+                  parse_graph_plios(dir / "aie" / "graph.hpp"),
+                  p.pl_clock_mhz, 0};
+
+    // set(PL_FREQ 500)
+    std::ifstream cmake{dir / "CMakeLists.txt"};
+    const std::regex pl_freq{R"re(set\(PL_FREQ ([0-9.]+)\))re"};
+    std::string line;
+    bool found = false;
+    while (!found && std::getline(cmake, line)) {
+        std::smatch match;
+        if (std::regex_search(line, match, pl_freq)) {
+            d.pl_mhz = std::stod(match[1]);
+            found = true;
+        }
+    }
+    if (!found) {
+        log(log_level::warning, "No PL_FREQ in '{}', using {} MHz",
+            (dir / "CMakeLists.txt").native(), d.pl_mhz);
+    }
+
+    // sp=axpy_mm2s.m_axi_gmem0:MC_NOC0
+    std::ifstream link{dir / "link.cfg"};
+    const std::regex sp{R"re(^sp=.*:(MC_NOC\d+))re"};
+    std::set<std::string> channels;
+    while (std::getline(link, line)) {
+        std::smatch match;
+        if (std::regex_search(line, match, sp)) {
+            channels.insert(match[1].str());
+        }
+    }
+    if (channels.empty()) {
+        log(log_level::warning, "No memory controllers in '{}', assuming one",
+            (dir / "link.cfg").native());
+    }
+    d.ddr_channels = std::max<std::size_t>(1, channels.size());
+    return d;
+}
+
+// Lower bounds of the time of a call on every ceiling
+struct roof_times {
+    double bytes = 0;
+    double macs = 0;
+    double transfer_ns = 0;
+    double mover_ns = 0;
+    double compute_ns = 0;
+
+    double roof_ns() const {
+        return std::max({transfer_ns, mover_ns, compute_ns});
+    }
+
+    std::string bound() const {
+        if (compute_ns >= mover_ns && compute_ns >= transfer_ns) {
+            return "compute";
+        }
+        return mover_ns >= transfer_ns ? "mover" : "transfer";
+    }
+};
+
+/*
+ * Kernels of a design run concurrently, so the slowest kernel and the
+ * slowest PLIO bound a call. A routine named after a kernel only runs that
+ * kernel, other routines run all of them. Replicated ports, named
+ * <port>_<replica>, each carry their share of the vector.
+ */
+static roof_times roof(const design_roof &d, const profile &p,
+                       double ddr_channel_gbps, const std::string &routine,
+                       std::uint64_t n, std::uint64_t m) {
+    const bool single = std::any_of(
+        d.kernels.begin(), d.kernels.end(),
+        [&](const kernel_shape &k) { return k.user_name == routine; });
+
+    roof_times t;
+    for (const kernel_shape &k : d.kernels) {
+        const op_traffic *traffic = find_traffic(k.op);
+        if (!traffic || (single && k.user_name != routine)) {
+            continue;
+        }
+
+        for (const plio_port &port : d.ports) {
+            if (find_kernel(d.kernels, port.name) != &k) {
+                continue;
+            }
+            std::string param = port.name.substr(k.user_name.size() + 1);
+            unsigned shares = 1;
+            const std::size_t split = param.find_last_of('_');
+            if (k.replicas > 1 && split != std::string::npos &&
+                std::all_of(param.begin() + split + 1, param.end(),
+                            ::isdigit)) {
+                param.resize(split);
+                shares = k.replicas;
+            }
+            const auto arg = std::find_if(
+                traffic->args.begin(), traffic->args.end(),
+                [&](const vector_arg &a) { return a.name == param; });
+            if (arg == traffic->args.end()) {
+                continue;
+            }
+
+            const double elements = std::ceil(length(arg->length, n, m) /
+                                              shares);
+            const double per_beat = std::max(1u, port.bits / k.type_bits);
+            t.bytes += elements * k.type_bits / 8;
+            t.mover_ns = std::max(t.mover_ns,
+                                  std::ceil(elements / per_beat) *
+                                  p.mover_ii / (d.pl_mhz / 1000.0));
+        }
+
+        const double macs = length(traffic->elements, n, m) *
+                            traffic->macs_per_element;
+        t.macs += macs;
+        t.compute_ns = std::max(t.compute_ns,
+                                macs / (k.replicas * macs_per_cycle(k.type) *
+                                        p.aie_clock_mhz / 1000.0));
+    }
+    t.transfer_ns = t.bytes / (d.ddr_channels * ddr_channel_gbps);
+    return t;
+}
+
+// Latest median time of every routine and size, per design hash
+using result_key = std::tuple<std::string, std::uint64_t, std::uint64_t>;
+using design_results = std::map<result_key, double>;
+
+static void collect_results(const fs::path &file,
+                            std::map<std::string, design_results> &results) {
+    std::ifstream in{file};
+    if (!in) {
+        throw trace_error(std::format("cannot open '{}'", file.native()));
+    }
+
+    std::string line;
+    std::size_t line_nr = 0;
+    while (std::getline(in, line)) {
+        line_nr++;
+        if (line.empty()) {
+            continue;
+        }
+
+        try {
+            const json record = json::parse(line);
+            const std::string hash =
+                record.at("design").at("hash").get<std::string>();
+            const json &median = record.at("stats_ms").at("median");
+            if (hash.empty() || !median.is_number()) {
+                continue;
+            }
+            const result_key key{record.at("routine").get<std::string>(),
+                                 record.at("n").get<std::uint64_t>(),
+                                 record.at("m").get<std::uint64_t>()};
+            results[hash][key] = median.get<double>();
+        } catch (const json::exception &e) {
+            throw trace_error(std::format("invalid result on line {} of "
+                                          "'{}': {}", line_nr, file.native(),
+                                          e.what()));
+        }
+    }
+}
+
+// Point of a design in the plot, in GB/s of the traffic of the model
+struct plot_point {
+    std::string routine;
+    double elements;
+    double measured_gbps;
+    roof_times roof;
+};
+
+struct plot_panel {
+    std::string title;
+    std::vector<plot_point> points;
+};
+
+/*
+ * Panel per design of the bandwidth of every result against the size, with
+ * the ceilings as lines. Both axes are logarithmic.
+ */
+static void write_svg(const fs::path &file,
+                      const std::vector<plot_panel> &panels) {
+    std::ofstream out{file};
+    if (!out) {
+        throw trace_error(std::format("cannot write '{}'", file.native()));
+    }
+
+    constexpr double width = 720, height = 360, margin = 60;
+    constexpr const char *colors[] = {"#1f77b4", "#ff7f0e", "#2ca02c",
+                                      "#d62728", "#9467bd", "#8c564b"};
+    std::println(out, R"(<svg xmlns="http://www.w3.org/2000/svg" )"
+                 R"(width="{}" height="{}" font-family="sans-serif" )"
+                 R"(font-size="12">)", width, height * panels.size());
+
+    for (std::size_t i = 0; i < panels.size(); ++i) {
+        const plot_panel &panel = panels[i];
+        const double top = height * i;
+
+        double min_x = INFINITY, max_x = 0, min_y = INFINITY, max_y = 0;
+        for (const plot_point &pt : panel.points) {
+            min_x = std::min(min_x, std::log2(pt.elements));
+            max_x = std::max(max_x, std::log2(pt.elements));
+            for (double gbps : {pt.measured_gbps,
+                                pt.roof.bytes / pt.roof.transfer_ns,
+                                pt.roof.bytes / pt.roof.mover_ns,
+                                pt.roof.bytes / pt.roof.compute_ns}) {
+                if (std::isfinite(gbps) && gbps > 0) {
+                    min_y = std::min(min_y, std::floor(std::log10(gbps)));
+                    max_y = std::max(max_y, std::ceil(std::log10(gbps)));
+                }
+            }
+        }
+        max_x = std::max(max_x, min_x + 1);
+        max_y = std::max(max_y, min_y + 1);
+        const auto x = [&](double elements) {
+            return margin + (std::log2(elements) - min_x) / (max_x - min_x) *
+                            (width - 2 * margin);
+        };
+        const auto y = [&](double gbps) {
+            return top + height - margin -
+                   (std::log10(gbps) - min_y) / (max_y - min_y) *
+                   (height - 2 * margin);
+        };
+
+        std::println(out, R"(<text x="{}" y="{}">{}</text>)", margin,
+                     top + margin / 2, panel.title);
+        std::println(out, R"(<rect x="{}" y="{}" width="{}" height="{}" )"
+                     R"(fill="none" stroke="black"/>)", margin, top + margin,
+                     width - 2 * margin, height - 2 * margin);
+        for (double e = std::ceil(min_x); e <= max_x; ++e) {
+            std::println(out, R"(<text x="{:.1f}" y="{}" text-anchor="middle">)"
+                         R"(2^{}</text>)", x(std::exp2(e)),
+                         top + height - margin + 16, e);
+        }
+        for (double e = min_y; e <= max_y; ++e) {
+            std::println(out, R"(<text x="{}" y="{:.1f}" text-anchor="end">)"
+                         R"({:g} GB/s</text>)", margin - 4,
+                         y(std::pow(10, e)) + 4, std::pow(10, e));
+        }
+
+        // Ceilings, as the bandwidth they allow at every size
+        const std::pair<const char *, double roof_times::*> ceilings[] = {
+            {"transfer", &roof_times::transfer_ns},
+            {"mover", &roof_times::mover_ns},
+            {"compute", &roof_times::compute_ns}};
+        for (std::size_t c = 0; c < std::size(ceilings); ++c) {
+            const auto &[name, ns] = ceilings[c];
+            std::map<double, double> line;
+            for (const plot_point &pt : panel.points) {
+                const double gbps = pt.roof.bytes / (pt.roof.*ns);
+                if (std::isfinite(gbps)) {
+                    line[pt.elements] = gbps;
+                }
+            }
+            if (line.empty()) {
+                continue;
+            }
+            std::string points;
+            for (const auto &[elements, gbps] : line) {
+                points += std::format("{:.1f},{:.1f} ", x(elements), y(gbps));
+            }
+            std::println(out, R"(<polyline points="{}" fill="none" )"
+                         R"(stroke="gray" stroke-dasharray="{}"/>)", points,
+                         c == 0 ? "8,4" : c == 1 ? "4,4" : "1,3");
+            std::println(out, R"(<text x="{}" y="{:.1f}" fill="gray">)"
+                         R"({}</text>)",
+                         width - margin + 4,
+                         y(line.rbegin()->second) + 4, name);
+        }
+
+        std::map<std::string, std::string> routines;
+        for (const plot_point &pt : panel.points) {
+            routines.emplace(pt.routine,
+                             colors[routines.size() % std::size(colors)]);
+        }
+        std::size_t legend = 0;
+        for (const auto &[routine, color] : routines) {
+            std::string points;
+            for (const plot_point &pt : panel.points) {
+                if (pt.routine != routine) {
+                    continue;
+                }
+                points += std::format("{:.1f},{:.1f} ", x(pt.elements),
+                                      y(pt.measured_gbps));
+                std::println(out, R"(<circle cx="{:.1f}" cy="{:.1f}" r="3" )"
+                             R"(fill="{}"/>)", x(pt.elements),
+                             y(pt.measured_gbps), color);
+            }
+            std::println(out, R"(<polyline points="{}" fill="none" )"
+                         R"(stroke="{}"/>)", points, color);
+            std::println(out, R"(<text x="{}" y="{}" fill="{}">{}</text>)",
+                         margin + 8, top + margin + 16 * ++legend, color,
+                         routine);
+        }
+    }
+    std::println(out, "</svg>");
+    log(log_level::status, "Wrote roofline plot to '{}'", file.native());
+}
+
+bool roofline(const roofline_options &options) {
+    profile p;
+    if (!options.profile.empty()) {
+        p = load_profile(options.profile);
+    }
+
+    std::map<std::string, design_results> results;
+    for (const fs::path &file : options.results) {
+        collect_results(file, results);
+    }
+
+    bool matched = false;
+    std::vector<plot_panel> panels;
+    for (const fs::path &dir : options.designs) {
+        const design_roof d = parse_design(dir, p);
+        const auto found = results.find(hash_file(d.json_file));
+        if (found == results.end()) {
+            log(log_level::warning, "No results of design '{}'",
+                d.json_file.native());
+            continue;
+        }
+        matched = true;
+
+        std::println("{} ({}): {} memory controllers of {:.1f} GB/s, "
+                     "{} PLIOs at {:.0f} MHz, AIE at {:.0f} MHz",
+                     dir.native(), d.json_file.native(), d.ddr_channels,
+                     options.ddr_channel_gbps, d.ports.size(), d.pl_mhz,
+                     p.aie_clock_mhz);
+        std::println("{:<24} {:>10} {:>6} {:>12} {:>8} {:>8} {:>12} "
+                     "{:>12} {:>12} {:<9} {:>6}", "routine", "n", "m",
+                     "median(us)", "GB/s", "GMAC/s", "transfer(us)",
+                     "mover(us)", "compute(us)", "bound", "roof");
+
+        plot_panel panel{dir.native(), {}};
+        // Largest size of every routine, which counts for its summary
+        std::map<std::string, std::string> summary;
+        for (const auto &[key, median_ms] : found->second) {
+            const auto &[routine, n, m] = key;
+            const roof_times t = roof(d, p, options.ddr_channel_gbps,
+                                      routine, n, m);
+            const double ns = median_ms * 1e6;
+            const double gbps = t.bytes / ns;
+            const double percent = t.roof_ns() / ns * 100;
+            std::println("{:<24} {:>10} {:>6} {:>12.1f} {:>8.3f} {:>8.3f} "
+                         "{:>12.1f} {:>12.1f} {:>12.1f} {:<9} {:>5.1f}%",
+                         routine, n, m, ns / 1000, gbps, t.macs / ns,
+                         t.transfer_ns / 1000, t.mover_ns / 1000,
+                         t.compute_ns / 1000, t.bound(), percent);
+
+            const double elements = m == 0 ? n : static_cast<double>(n) * m;
+            summary[routine] = std::format(
+                "{} at n = {}{}: {}-bound, at {:.1f}% of the roof", routine,
+                n, m == 0 ? "" : std::format(", m = {}", m), t.bound(),
+                percent);
+            if (t.bytes > 0 && elements > 0) {
+                panel.points.push_back({routine, elements, gbps, t});
+            }
+        }
+        for (const auto &[routine, line] : summary) {
+            std::println("{}", line);
+        }
+        std::println("");
+
+        if (!panel.points.empty()) {
+            panels.push_back(std::move(panel));
+        }
+    }
+
+    if (!options.svg.empty() && !panels.empty()) {
+        write_svg(options.svg, panels);
+    }
+    return matched;
+}
+
+} // aiesim
+} // aieblas
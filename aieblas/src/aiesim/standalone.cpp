@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cctype>
+#include <cxxopts.hpp>
+
+#include "aieblas/aiesim.hpp"
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/aiesim/trace.hpp"
+
+namespace sim = aieblas::aiesim;
+
+namespace {
+inline void error(const std::string_view message) {
+    std::println("Argument error: {}", message);
+    std::fflush(stdout);
+    exit(1);
+}
+
+struct arguments {
+    sim::report_options report;
+    // calibrate the profile in calibrate.profile instead of reporting
+    bool calibrate;
+    sim::calibrate_options calibrate_options;
+    // compare the results against the ceilings of the designs instead
+    bool roofline;
+    sim::roofline_options roofline_options;
+};
+
+arguments parse_args(int argc, const char* const* argv) {
+    arguments args;
+    sim::report_options &options = args.report;
+    try {
+        cxxopts::Options cli("aiesim_report",
+                             "Throughput and golden comparison of the "
+                             "aiesimulator output of an aieblas design");
+
+        cli.add_options()
+            ("design", "Design directories generated by codegen",
+             cxxopts::value<std::vector<std::string>>())
+            ("o,output", "Simulator output directory, relative to the design",
+             cxxopts::value<std::string>()->default_value(
+                options.output.string()))
+            ("g,golden", "Expected output directory, relative to the design",
+             cxxopts::value<std::string>()->default_value(
+                options.golden.string()))
+            ("t,tolerance", "Allowed error of a value",
+             cxxopts::value<double>()->default_value(
+                std::to_string(options.tolerance)))
+            ("gap-factor", "Intervals longer than this many times the median "
+             "interval are stalls", cxxopts::value<double>()->default_value(
+                std::to_string(options.gap_factor)))
+            ("p,profile", "Compare against the model of a calibrated profile",
+             cxxopts::value<std::string>())
+            ("calibrate", "Fit the profile to the designs and benchmark "
+             "results, and write it to this file",
+             cxxopts::value<std::string>())
+            ("results", "Benchmark results (.jsonl) to calibrate from or "
+             "compare against the roofline",
+             cxxopts::value<std::vector<std::string>>())
+            ("roofline", "Compare the results of the designs against the "
+             "DDR, PLIO and AIE ceilings of the designs")
+            ("ddr-gbps", "Bandwidth of a DDR memory controller in GB/s",
+             cxxopts::value<double>()->default_value("25.6"))
+            ("svg", "Plot the roofline of every design to this file",
+             cxxopts::value<std::string>())
+            ("l,log-level", "Set the logging level",
+             cxxopts::value<std::string>())
+            ("h,help", "Print usage");
+
+        cli.positional_help("<design>...");
+        cli.parse_positional({"design"});
+        auto results = cli.parse(argc, argv);
+
+        if (results.count("help")) {
+            std::println("{}", cli.help());
+            std::fflush(stdout);
+            exit(0);
+        }
+
+        if (results.count("log-level")) {
+            std::string level_str = results["log-level"].as<std::string>();
+            std::transform(level_str.begin(), level_str.end(),
+                           level_str.begin(), ::tolower);
+            aieblas::log_level level = aieblas::log_level_from_str(level_str);
+            if (level == aieblas::log_level::unknown) {
+                error(std::format("'{}' is not a supported log level",
+                                  level_str));
+            }
+            aieblas::set_log_level(level);
+        }
+
+        std::vector<std::string> designs;
+        if (results.count("design")) {
+            designs = results["design"].as<std::vector<std::string>>();
+        }
+        for (const std::string &design : designs) {
+            if (!fs::is_directory(design)) {
+                error(std::format("'{}' is not a directory", design));
+            }
+        }
+
+        std::vector<std::string> result_files;
+        if (results.count("results")) {
+            result_files = results["results"].as<std::vector<std::string>>();
+        }
+
+        args.roofline = results.count("roofline");
+        if (args.roofline) {
+            sim::roofline_options &roofline = args.roofline_options;
+            roofline.designs.assign(designs.begin(), designs.end());
+            roofline.results.assign(result_files.begin(),
+                                    result_files.end());
+            roofline.ddr_channel_gbps = results["ddr-gbps"].as<double>();
+            if (results.count("profile")) {
+                roofline.profile = results["profile"].as<std::string>();
+            }
+            if (results.count("svg")) {
+                roofline.svg = results["svg"].as<std::string>();
+            }
+            if (roofline.designs.empty() || roofline.results.empty()) {
+                error("roofline needs a design and --results\n"
+                      "Run with -h to show usage.");
+            }
+            return args;
+        }
+
+        args.calibrate = results.count("calibrate");
+        if (args.calibrate) {
+            sim::calibrate_options &calibrate = args.calibrate_options;
+            calibrate.designs.assign(designs.begin(), designs.end());
+            calibrate.output = results["output"].as<std::string>();
+            calibrate.results.assign(result_files.begin(),
+                                     result_files.end());
+            calibrate.gap_factor = results["gap-factor"].as<double>();
+            calibrate.profile = results["calibrate"].as<std::string>();
+            if (calibrate.designs.empty() && calibrate.results.empty()) {
+                error("calibrate needs a design or --results\n"
+                      "Run with -h to show usage.");
+            }
+            return args;
+        }
+
+        if (designs.size() != 1) {
+            error("expected a single positional argument design\n"
+                  "Run with -h to show usage.");
+        }
+
+        options.design = designs.front();
+        options.output = results["output"].as<std::string>();
+        options.golden = results["golden"].as<std::string>();
+        options.tolerance = results["tolerance"].as<double>();
+        options.gap_factor = results["gap-factor"].as<double>();
+        if (results.count("profile")) {
+            options.profile = results["profile"].as<std::string>();
+        }
+    } catch (const std::exception &e) {
+        error(std::format("Unexpected exception: {}", e.what()));
+    }
+
+    return args;
+}
+} // namespace
+
+
+int main(int argc, char *argv[]) {
+    arguments args = parse_args(argc, argv);
+
+    try {
+        if (args.roofline) {
+            return sim::roofline(args.roofline_options) ? 0 : 2;
+        } else if (args.calibrate) {
+            return sim::calibrate(args.calibrate_options) ? 0 : 2;
+        }
+        return sim::report(args.report) ? 0 : 2;
+    } catch (const sim::trace_error &e) {
+        std::println("Trace error: {}", e.what());
+        return 1;
+    }
+}
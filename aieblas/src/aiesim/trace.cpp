@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/aiesim/trace.hpp"
+
+namespace aieblas {
+namespace aiesim {
+
+bool plio_trace::timed() const {
+    return !beats.empty() && beats.front().time_ns.has_value();
+}
+
+static double time_unit_ns(const std::string &unit, const fs::path &file) {
+    if (unit == "ps") {
+        return 1e-3;
+    } else if (unit == "ns") {
+        return 1.0;
+    } else if (unit == "us") {
+        return 1e3;
+    } else if (unit == "ms") {
+        return 1e6;
+    } else if (unit == "s") {
+        return 1e9;
+    }
+    throw trace_error(std::format("unknown time unit '{}' in '{}'", unit,
+                                  file.native()));
+}
+
+plio_trace parse_plio_file(const fs::path &file) {
+    std::ifstream in{file};
+    if (!in) {
+        throw trace_error(std::format("cannot open '{}'", file.native()));
+    }
+
+    plio_trace trace{file, {}};
+    std::optional<double> time;
+    std::string line;
+    std::size_t line_nr = 0;
+    while (std::getline(in, line)) {
+        line_nr++;
+        std::istringstream tokens(line);
+        std::string token;
+        if (!(tokens >> token)) {
+            continue;
+        }
+
+        if (token == "T") {
+            double value;
+            std::string unit;
+            if (!(tokens >> value >> unit)) {
+                throw trace_error(std::format("invalid time on line {} of "
+                                              "'{}'", line_nr, file.native()));
+            }
+            time = value * time_unit_ns(unit, file);
+            continue;
+        } else if (token == "TLAST") {
+            // Marks the beat that follows it
+            trace.beats.emplace_back();
+            trace.beats.back().tlast = true;
+            trace.beats.back().time_ns = time;
+            continue;
+        }
+
+        beat *b;
+        if (!trace.beats.empty() && trace.beats.back().tlast &&
+            trace.beats.back().values.empty()) {
+            b = &trace.beats.back();
+        } else {
+            b = &trace.beats.emplace_back();
+        }
+        b->time_ns = time;
+        do {
+            char *end = nullptr;
+            const double value = std::strtod(token.c_str(), &end);
+            if (end == token.c_str() || *end != '\0') {
+                throw trace_error(std::format("invalid value '{}' on line {} "
+                                              "of '{}'", token, line_nr,
+                                              file.native()));
+            }
+            b->values.push_back(value);
+        } while (tokens >> token);
+        time.reset();
+    }
+
+    // A trailing TLAST without values
+    if (!trace.beats.empty() && trace.beats.back().values.empty()) {
+        trace.beats.pop_back();
+    }
+
+    log(log_level::verbose, "Parsed {} beats from '{}'", trace.beats.size(),
+        file.native());
+    return trace;
+}
+
+std::vector<plio_port> parse_graph_plios(const fs::path &graph_hdr) {
+    std::ifstream in{graph_hdr};
+    if (!in) {
+        throw trace_error(std::format("cannot open '{}'",
+                                      graph_hdr.native()));
+    }
+
+    // e.g. axpy_x = input_plio::create("axpy_x", plio_32_bits, "data/x.txt");
+    const std::regex create{R"re((input|output)_plio::create\("(\w+)", )re"
+                            R"re(plio_(\d+)_bits, "([^"]+)"\))re"};
+    std::vector<plio_port> ports;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::smatch match;
+        if (std::regex_search(line, match, create)) {
+            ports.emplace_back(match[2].str(), match[1].str() == "input",
+                               static_cast<unsigned>(std::stoul(match[3])),
+                               fs::path(match[4].str()));
+        }
+    }
+    return ports;
+}
+
+port_timing analyze_timing(const plio_trace &trace, unsigned bits,
+                           double gap_factor) {
+    port_timing timing;
+    std::vector<double> times;
+    for (const beat &b : trace.beats) {
+        if (b.time_ns) {
+            times.push_back(*b.time_ns);
+        }
+    }
+    timing.beats = trace.beats.size();
+    timing.bytes = trace.beats.size() * bits / 8;
+    if (times.empty()) {
+        return timing;
+    }
+
+    timing.first_ns = times.front();
+    timing.last_ns = times.back();
+    std::vector<double> intervals;
+    for (std::size_t i = 1; i < times.size(); ++i) {
+        intervals.push_back(times[i] - times[i - 1]);
+    }
+    if (intervals.empty()) {
+        return timing;
+    }
+
+    std::vector<double> sorted = intervals;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2,
+                     sorted.end());
+    timing.median_interval_ns = sorted[sorted.size() / 2];
+    for (double interval : intervals) {
+        if (interval > gap_factor * timing.median_interval_ns) {
+            timing.stalls++;
+            timing.stall_ns += interval - timing.median_interval_ns;
+            timing.max_stall_ns = std::max(timing.max_stall_ns, interval);
+        }
+    }
+    return timing;
+}
+
+golden_diff compare_golden(const plio_trace &trace, const plio_trace &golden,
+                           double tolerance) {
+    std::vector<double> values, expected;
+    for (const beat &b : trace.beats) {
+        values.insert(values.end(), b.values.begin(), b.values.end());
+    }
+    for (const beat &b : golden.beats) {
+        expected.insert(expected.end(), b.values.begin(), b.values.end());
+    }
+
+    golden_diff diff;
+    diff.values = values.size();
+    diff.expected = expected.size();
+    for (std::size_t i = 0; i < std::min(values.size(), expected.size());
+         ++i) {
+        const double error = std::abs(values[i] - expected[i]);
+        const double scale = std::max(1.0, std::abs(expected[i]));
+        // NaN never compares equal, also not to an expected NaN
+        if (!(error <= tolerance * scale)) {
+            diff.mismatches++;
+            if (!diff.first_mismatch) {
+                diff.first_mismatch = i;
+            }
+        }
+        if (!std::isnan(error)) {
+            diff.max_error = std::max(diff.max_error, error);
+        }
+    }
+    return diff;
+}
+
+} // aiesim
+} // aieblas
@@ -6,6 +6,132 @@
 namespace aieblas {
 namespace codegen {
 
+/*
+ * CMake script running a build step through the build cache, so the
+ * generated build can skip v++ and aiecompiler for inputs built before by any
+ * design. The output file of a step is cached, together with the other files
+ * and directories it produces when listed in CACHE_PRODUCTS (e.g. the work
+ * directory of aiecompiler, which aiesimulator needs).
+ */
+static void generate_build_cache(generator &gen) {
+    gen.println("# Run a build step through a content-addressed cache:");
+    gen.println("#   cmake -DCACHE_DIR=<dir> -DCACHE_ROOT=<dir> -P "
+                "build_cache.cmake");
+    gen.println("#         <output> <inputs...> -- <command...>");
+    gen.println("# The key hashes the command, with CACHE_ROOT masked so "
+                "designs share");
+    gen.println("# entries, and the content of the inputs. On a hit the "
+                "output is copied");
+    gen.println("# from the cache, otherwise the command runs and its output "
+                "is stored.");
+    gen.println("# CACHE_PRODUCTS lists other files and directories made by "
+                "the command,");
+    gen.println("# separated by commas, which are archived with the output "
+                "and restored on a");
+    gen.println("# hit. Without a CACHE_DIR the command always runs.");
+    gen.println("cmake_minimum_required(VERSION 3.22)");
+    gen.println();
+    gen.println("set(output)");
+    gen.println("set(inputs)");
+    gen.println("set(command)");
+    gen.println("set(part script)");
+    gen.println("math(EXPR last \"${{CMAKE_ARGC}} - 1\")");
+    gen.println<generator::INCREASE_AFTER>("foreach(i RANGE ${{last}})");
+    gen.println("set(arg \"${{CMAKE_ARGV${{i}}}}\")");
+    gen.println<generator::INCREASE_AFTER>("if (part STREQUAL \"script\")");
+    gen.println<generator::INCREASE_AFTER>("if (arg STREQUAL \"-P\")");
+    gen.println("set(part path)");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println<generator::DECREASE_BEFORE>("elseif (part STREQUAL \"path\")");
+    gen.indent_incr();
+    gen.println("set(part output)");
+    gen.println<generator::DECREASE_BEFORE>("elseif (part STREQUAL "
+                                            "\"output\")");
+    gen.indent_incr();
+    gen.println("set(output \"${{arg}}\")");
+    gen.println("set(part inputs)");
+    gen.println<generator::DECREASE_BEFORE>("elseif (part STREQUAL \"inputs\" "
+                                            "AND arg STREQUAL \"--\")");
+    gen.indent_incr();
+    gen.println("set(part command)");
+    gen.println<generator::DECREASE_BEFORE>("elseif (part STREQUAL "
+                                            "\"inputs\")");
+    gen.indent_incr();
+    gen.println("list(APPEND inputs \"${{arg}}\")");
+    gen.println<generator::DECREASE_BEFORE>("else ()");
+    gen.indent_incr();
+    gen.println("list(APPEND command \"${{arg}}\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println<generator::DECREASE_BEFORE>("endforeach()");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("if (output STREQUAL \"\" OR "
+                                           "command STREQUAL \"\")");
+    gen.println("message(FATAL_ERROR \"Usage: build_cache.cmake <output> "
+                "<inputs...> -- <command...>\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println("string(REPLACE \",\" \";\" products "
+                "\"${{CACHE_PRODUCTS}}\")");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("if (CACHE_DIR)");
+    gen.println("set(key \"\")");
+    gen.println<generator::INCREASE_AFTER>("foreach(arg IN LISTS command)");
+    gen.println("string(REPLACE \"${{CACHE_ROOT}}\" \"<root>\" arg "
+                "\"${{arg}}\")");
+    gen.println("string(APPEND key \"${{arg}}\\n\")");
+    gen.println<generator::DECREASE_BEFORE>("endforeach()");
+    gen.println<generator::INCREASE_AFTER>("foreach(input IN LISTS inputs)");
+    gen.println("file(SHA256 \"${{input}}\" hash)");
+    gen.println("string(REPLACE \"${{CACHE_ROOT}}\" \"<root>\" input "
+                "\"${{input}}\")");
+    gen.println("string(APPEND key \"${{input}}=${{hash}}\\n\")");
+    gen.println<generator::DECREASE_BEFORE>("endforeach()");
+    gen.println("string(SHA256 key \"${{key}}\")");
+    gen.println();
+    gen.println("get_filename_component(name \"${{output}}\" NAME)");
+    gen.println("set(entry \"${{CACHE_DIR}}/${{key}}/${{name}}\")");
+    gen.println("set(archive \"${{CACHE_DIR}}/${{key}}/products.tar\")");
+    gen.println<generator::INCREASE_AFTER>("if (EXISTS \"${{entry}}\" AND "
+                                           "(NOT products OR EXISTS "
+                                           "\"${{archive}}\"))");
+    gen.println("message(STATUS \"Build cache hit for ${{output}} "
+                "(${{key}})\")");
+    gen.println<generator::INCREASE_AFTER>("if (products)");
+    gen.println("# Drop files of an earlier build missing from the entry");
+    gen.println("file(REMOVE_RECURSE ${{products}})");
+    gen.println("file(ARCHIVE_EXTRACT INPUT \"${{archive}}\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println("file(COPY_FILE \"${{entry}}\" \"${{output}}\")");
+    gen.println("return()");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println("message(STATUS \"Build cache miss for ${{output}} "
+                "(${{key}})\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println();
+    gen.println("execute_process(COMMAND ${{command}} RESULT_VARIABLE result)");
+    gen.println<generator::INCREASE_AFTER>("if (NOT result EQUAL 0)");
+    gen.println("message(FATAL_ERROR \"Build step for ${{output}} failed: "
+                "${{result}}\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("if (CACHE_DIR)");
+    gen.println("# Store under a temporary name first, builds may share the "
+                "cache. The");
+    gen.println("# output comes last, as its presence marks a complete "
+                "entry.");
+    gen.println("string(RANDOM LENGTH 8 suffix)");
+    gen.println("file(MAKE_DIRECTORY \"${{CACHE_DIR}}/${{key}}\")");
+    gen.println<generator::INCREASE_AFTER>("if (products)");
+    gen.println("file(ARCHIVE_CREATE OUTPUT \"${{archive}}.${{suffix}}\" "
+                "PATHS ${{products}})");
+    gen.println("file(RENAME \"${{archive}}.${{suffix}}\" "
+                "\"${{archive}}\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+    gen.println("file(COPY_FILE \"${{output}}\" \"${{entry}}.${{suffix}}\")");
+    gen.println("file(RENAME \"${{entry}}.${{suffix}}\" \"${{entry}}\")");
+    gen.println<generator::DECREASE_BEFORE>("endif ()");
+
+}
+
 void generator::generate_cmake() {
     fs::path cmake_file = out_dir / "CMakeLists.txt";
 
@@ -15,7 +141,10 @@ void generator::generate_cmake() {
     this->println("project(aieblas)");
     this->println();
 
-    this->println<INCREASE_AFTER>("if (NOT EXISTS $ENV{{XILINX_VITIS}})");
+    // Only the host library or the emulated graph can be built without Vitis
+    this->println<INCREASE_AFTER>("if (NOT EXISTS \"$ENV{{XILINX_VITIS}}\" AND "
+                                  "NOT DEFINED AIEBLAS_MOCK_XRT AND NOT "
+                                  "DEFINED AIEBLAS_AIE_EMU)");
     this->println("message(FATAL_ERROR \"Xilinx Vitis not found, make sure to "
                   "source setup.sh\")");
     this->println<DECREASE_BEFORE>("endif ()");
@@ -65,6 +194,33 @@ void generator::generate_cmake() {
                   "-g -t hw --log_dir log --temp_dir tmp --report_dir report)");
     this->println();
 
+    this->println("# Results of v++ and aiecompiler are looked up in a cache "
+                  "shared by designs when");
+    this->println("# AIEBLAS_BUILD_CACHE is set to a directory, as CMake or "
+                  "environment variable.");
+    this->println("# The key of a step hashes its command line and the content "
+                  "of its inputs, see");
+    this->println("# build_cache.cmake.");
+    this->println<INCREASE_AFTER>("if (NOT DEFINED AIEBLAS_BUILD_CACHE)");
+    this->println("set(AIEBLAS_BUILD_CACHE \"$ENV{{AIEBLAS_BUILD_CACHE}}\")");
+    this->println<DECREASE_BEFORE>("endif ()");
+    this->println("set(CACHED ${{CMAKE_COMMAND}} "
+                  "-DCACHE_DIR=${{AIEBLAS_BUILD_CACHE}} "
+                  "-DCACHE_ROOT=${{CMAKE_CURRENT_SOURCE_DIR}} "
+                  "-P ${{CMAKE_CURRENT_SOURCE_DIR}}/build_cache.cmake)");
+    this->println("# aiesimulator reads the work directory and graph.json of "
+                  "aiecompiler as well");
+    this->println("set(CACHED_AIE ${{CMAKE_COMMAND}} "
+                  "-DCACHE_DIR=${{AIEBLAS_BUILD_CACHE}} "
+                  "-DCACHE_ROOT=${{CMAKE_CURRENT_SOURCE_DIR}} "
+                  "-DCACHE_PRODUCTS=Work,graph.json "
+                  "-P ${{CMAKE_CURRENT_SOURCE_DIR}}/build_cache.cmake)");
+    this->println("set(AIE_INPUTS aie/graph.cpp aie/graph.hpp "
+                  "${{AIE_KERNELS}})");
+    this->println("list(TRANSFORM AIE_INPUTS PREPEND "
+                  "${{CMAKE_CURRENT_SOURCE_DIR}}/)");
+    this->println();
+
     this->println("#######");
     this->println("# AIE #");
     this->println("#######");
@@ -80,12 +236,14 @@ void generator::generate_cmake() {
     this->println("# HW / HW emu");
     this->println<INCREASE_AFTER>("add_custom_command(");
     this->println("OUTPUT xilinx/libadf.a");
-    this->println("COMMAND ${{AIECC}} ${{AIE_FLAGS}} "
+    this->println("COMMAND ${{CACHED_AIE}} libadf.a ${{AIE_INPUTS}} -- "
+                  "${{AIECC}} ${{AIE_FLAGS}} "
                   "--output-archive=libadf.a -workdir=./Work "
                   "--target=hw \"${{CMAKE_CURRENT_SOURCE_DIR}}/aie/"
                   "graph.cpp\"");
-    this->println("MAIN_DEPENDENCY aie/graph.cpp");
-    this->println("DEPENDS xilinx aie/graph.hpp ${{AIE_KERNELS}}");
+    // Not the main dependency, graph.cpp is also a source of aie_emu
+    this->println("DEPENDS xilinx aie/graph.cpp aie/graph.hpp "
+                  "${{AIE_KERNELS}}");
     this->println("COMMENT \"Building ADF graph for HW/HW-emulation "
                   "xilinx/libadf_x86.a\"");
     this->println("WORKING_DIRECTORY xilinx");
@@ -93,6 +251,7 @@ void generator::generate_cmake() {
     this->println<DECREASE_BEFORE>(")");
     this->println();
 
+    // Not cached, the x86 simulator needs the work directory as well
     this->println("# SW emu");
     this->println<INCREASE_AFTER>("add_custom_command(");
     this->println("OUTPUT xilinx/libadf_x86.a");
@@ -100,8 +259,8 @@ void generator::generate_cmake() {
                   "--output-archive=libadf_x86.a -workdir=./Work_sw "
                   "--target=x86sim \"${{CMAKE_CURRENT_SOURCE_DIR}}/aie/"
                   "graph.cpp\"");
-    this->println("MAIN_DEPENDENCY aie/graph.cpp");
-    this->println("DEPENDS xilinx aie/graph.h ${{AIE_KERNELS}}");
+    this->println("DEPENDS xilinx aie/graph.cpp aie/graph.h "
+                  "${{AIE_KERNELS}}");
     this->println("COMMENT \"Building ADF graph for SW-emulation "
                   "xilinx/libadf_x86.a\"");
     this->println("WORKING_DIRECTORY xilinx");
@@ -109,6 +268,23 @@ void generator::generate_cmake() {
     this->println<DECREASE_BEFORE>(")");
     this->println();
 
+    this->println("# Functional emulation on the CPU. When AIEBLAS_AIE_EMU "
+                  "is set to the include");
+    this->println("# directory of the AIE emulation shim, the graph is built "
+                  "as a native program");
+    this->println("# that reads its PLIO data files from the working "
+                  "directory.");
+    this->println<INCREASE_AFTER>("if (DEFINED AIEBLAS_AIE_EMU)");
+    this->println("find_package(Threads REQUIRED)");
+    this->println("add_executable(aie_emu aie/graph.cpp aie/graph.hpp "
+                  "${{AIE_KERNELS}})");
+    this->println("target_include_directories(aie_emu PRIVATE "
+                  "${{AIEBLAS_AIE_EMU}} aie aie/kernels)");
+    this->println("target_link_libraries(aie_emu PRIVATE Threads::Threads)");
+    this->println("target_compile_features(aie_emu PRIVATE cxx_std_20)");
+    this->println<DECREASE_BEFORE>("endif ()");
+    this->println();
+
     this->println("######");
     this->println("# PL #");
     this->println("######");
@@ -120,7 +296,9 @@ void generator::generate_cmake() {
     this->println();
     this->println<INCREASE_AFTER>("add_custom_command(");
     this->println("OUTPUT xilinx/${{name}}.xo");
-    this->println("COMMAND ${{VPP}} ${{VPP_FLAGS}} -c -k ${{name}} "
+    this->println("COMMAND ${{CACHED}} ${{name}}.xo "
+                  "${{CMAKE_CURRENT_SOURCE_DIR}}/${{kernel}} -- "
+                  "${{VPP}} ${{VPP_FLAGS}} -c -k ${{name}} "
                   "${{CMAKE_CURRENT_SOURCE_DIR}}/${{kernel}} -o ${{name}}.xo");
     this->println("MAIN_DEPENDENCY ${{kernel}}");
     this->println("DEPENDS xilinx");
@@ -139,7 +317,9 @@ void generator::generate_cmake() {
     this->println();
     this->println<INCREASE_AFTER>("add_custom_command(");
     this->println("OUTPUT xilinx/aieblas.xsa");
-    this->println("COMMAND ${{VPP}} ${{VPP_FLAGS}} -l ${{KERNEL_OBJECTS}} "
+    this->println("COMMAND ${{CACHED}} aieblas.xsa ${{KERNEL_OBJECTS}} "
+                  "libadf.a ${{CMAKE_CURRENT_SOURCE_DIR}}/link.cfg -- "
+                  "${{VPP}} ${{VPP_FLAGS}} -l ${{KERNEL_OBJECTS}} "
                   "libadf.a --config ${{CMAKE_CURRENT_SOURCE_DIR}}/link.cfg "
                   "-o aieblas.xsa");
     this->println("DEPENDS xilinx xilinx/libadf.a ${{KERNEL_OBJECTS_PATH}} "
@@ -153,7 +333,8 @@ void generator::generate_cmake() {
 
     this->println<INCREASE_AFTER>("add_custom_command(");
     this->println("OUTPUT xilinx/aieblas.xclbin");
-    this->println("COMMAND ${{VPP}} -p ${{VPP_FLAGS}} --package.boot_mode=ospi "
+    this->println("COMMAND ${{CACHED}} aieblas.xclbin aieblas.xsa libadf.a -- "
+                  "${{VPP}} -p ${{VPP_FLAGS}} --package.boot_mode=ospi "
                   "aieblas.xsa libadf.a -o aieblas.xclbin");
     this->println("DEPENDS xilinx xilinx/aieblas.xsa xilinx/libadf.a");
     this->println("COMMENT \"Packaging FPGA design xilinx/aieblas.xclbin\"");
@@ -162,6 +343,69 @@ void generator::generate_cmake() {
     this->println<DECREASE_BEFORE>(")");
     this->println();
 
+    this->println("########");
+    this->println("# HOST #");
+    this->println("########");
+    this->println();
+    this->println("# Host library to launch the routines of this design. "
+                  "When AIEBLAS_MOCK_XRT is");
+    this->println("# set to the include directory of the mock XRT backend, "
+                  "the routines run on the");
+    this->println("# CPU instead. It is an object library so the routines "
+                  "registered in mock.cpp");
+    this->println("# are always linked in.");
+    this->println("find_package(Threads REQUIRED)");
+    this->println<INCREASE_AFTER>("if (DEFINED AIEBLAS_MOCK_XRT)");
+    this->println("add_library(aieblas_host OBJECT host/aieblas.cpp "
+                  "host/aieblas.hpp host/bo_pool.hpp host/queue.hpp "
+                  "host/mock.cpp)");
+    this->println("target_include_directories(aieblas_host PUBLIC "
+                  "${{AIEBLAS_MOCK_XRT}} host)");
+    this->println("target_link_libraries(aieblas_host PUBLIC "
+                  "Threads::Threads)");
+    this->println("target_compile_features(aieblas_host PUBLIC cxx_std_20)");
+    this->println<DECREASE_BEFORE>("elseif (EXISTS $ENV{{XILINX_XRT}})");
+    this->indent_incr();
+    this->println("add_library(aieblas_host STATIC host/aieblas.cpp "
+                  "host/aieblas.hpp host/bo_pool.hpp host/queue.hpp)");
+    this->println("target_include_directories(aieblas_host PUBLIC "
+                  "$ENV{{XILINX_XRT}}/include host)");
+    this->println("target_link_directories(aieblas_host PUBLIC "
+                  "$ENV{{XILINX_XRT}}/lib)");
+    this->println("target_link_libraries(aieblas_host PUBLIC xrt_coreutil "
+                  "Threads::Threads)");
+    this->println("target_compile_features(aieblas_host PUBLIC cxx_std_20)");
+    this->println<DECREASE_BEFORE>("endif ()");
+    this->println();
+
+    this->println("# Benchmark driver of all routines: bench <xclbin> "
+                  "[--min <size>] [--max <size>]");
+    this->println("# [--step <n>|x<n>] [--warmup <n>] [--repeat <n>] "
+                  "[--json <file>] [-r <routine>]");
+    this->println<INCREASE_AFTER>("if (TARGET aieblas_host)");
+    this->println("add_executable(bench host/bench.cpp)");
+    this->println("target_link_libraries(bench PRIVATE aieblas_host)");
+    this->println<DECREASE_BEFORE>("endif ()");
+    this->println();
+
+    if (this->d.sim_data) {
+        this->println("# Stimulus for aiesimulator: sim_data <size> [<seed>] "
+                      "writes the input PLIO");
+        this->println("# files to data/ and the expected output to "
+                      "data/golden/, computed by the");
+        this->println("# CPU implementation of the mock XRT backend.");
+        this->println<INCREASE_AFTER>("if (DEFINED AIEBLAS_MOCK_XRT)");
+        this->println("add_executable(sim_data sim/sim_data.cpp "
+                      "host/mock.cpp)");
+        this->println("target_include_directories(sim_data PRIVATE "
+                      "${{AIEBLAS_MOCK_XRT}})");
+        this->println("target_link_libraries(sim_data PRIVATE "
+                      "Threads::Threads)");
+        this->println("target_compile_features(sim_data PRIVATE cxx_std_20)");
+        this->println<DECREASE_BEFORE>("endif ()");
+        this->println();
+    }
+
     this->println("###########");
     this->println("# TARGETS #");
     this->println("###########");
@@ -183,6 +427,9 @@ void generator::generate_cmake() {
 
     this->close();
 
+    this->open(out_dir / "build_cache.cmake", comment_type::HASHTAG);
+    generate_build_cache(*this);
+    this->close();
 }
 
 } // codegen
@@ -6,14 +6,19 @@
 namespace aieblas {
 namespace codegen {
 
-void codegen(fs::path json_file, fs::path output) {
-    generator gen{json_file, output};
+void codegen(fs::path json_file, fs::path output, bool emit_sim_data) {
+    generator gen{json_file, output, emit_sim_data};
 
     gen.generate_kernels();
     gen.generate_graph();
     gen.generate_pl_kernels();
     gen.generate_config();
+    gen.generate_host();
+    if (emit_sim_data) {
+        gen.generate_sim_data();
+    }
     gen.generate_cmake();
+    gen.generate_manifest();
 }
 
 } // codegen
@@ -31,6 +31,13 @@ void generator::generate_config() {
     }
 
     this->println("[connectivity]");
+    if (this->d.movers.merge) {
+        this->println("# Merged data movers");
+        gen_pl_merged_link(*this);
+        this->close();
+        return;
+    }
+
     for (const kernel &kernel : this->d.kernels) {
         this->println("# Kernel {}", kernel.user_name);
         generate_config_kernel(*this, kernel);
@@ -1,5 +1,8 @@
 #include <fstream>
+#include <iterator>
+#include <string_view>
 #include "aieblas/detail/util.hpp"
+#include "aieblas/detail/util/hash.hpp"
 #include "aieblas/detail/codegen/generator.hpp"
 
 namespace aieblas {
@@ -18,41 +21,65 @@ static inline void generate_header(generator &gen,
         return;
     }
 
-    time_t now = std::time(0);
-    struct tm tstruct = *std::localtime(&now);
-
-    gen.println("{}This file was auto-generated by aieblas on {}-{}-{} at "
-                "{}:{}", comment_start, 1900 + tstruct.tm_year,
-                1 + tstruct.tm_mon, tstruct.tm_mday, tstruct.tm_hour,
-                tstruct.tm_min);
+    // The time of generation is kept in the manifest, so that regenerating
+    // a design without changes leaves its files untouched.
+    gen.println("{}This file was auto-generated by aieblas", comment_start);
     gen.println();
 }
 
-generator::generator(fs::path json, fs::path output) : out_dir(output) {
+generator::generator(fs::path json, fs::path output, bool sim_data)
+        : out_dir(output), json_path(json) {
     // try {
         parse_json(json);
     // } catch (const parse_error &e) {
     //     throw parse_error(std::format("Parsing error from '{}': {}",
     //                                   json.native(), e.what()));
     // }
+    this->d.sim_data = sim_data;
 }
 
 void generator::open(fs::path filename, comment_type comment_type) {
     indent_ = 0;
     indented = false;
-    if (cur_file_.is_open()) {
+    if (!cur_filename.empty()) {
         this->close();
     }
     log(log_level::verbose, "Opening '{}'", filename.native());
-    cur_file_ = std::ofstream{filename};
+    cur_file_.str("");
+    cur_file_.clear();
     cur_filename = filename;
 
     generate_header(*this, comment_type);
 }
 
 void generator::close() {
-    log(log_level::verbose, "Closing '{}'", cur_filename.native());
-    cur_file_.close();
+    const std::string content = cur_file_.str();
+    const std::uint64_t hash = fnv1a(content);
+
+    bool changed = true;
+    std::ifstream existing{cur_filename, std::ios::binary};
+    if (existing) {
+        const std::string old{std::istreambuf_iterator<char>{existing},
+                              std::istreambuf_iterator<char>{}};
+        changed = fnv1a(old) != hash;
+    }
+    existing.close();
+
+    if (changed) {
+        log(log_level::verbose, "Writing '{}'", cur_filename.native());
+        // Replace the file at once, so an interrupted run does not leave a
+        // partial file with a newer modification time behind.
+        fs::path tmp = cur_filename;
+        tmp += ".tmp";
+        std::ofstream{tmp, std::ios::binary} << content;
+        fs::rename(tmp, cur_filename);
+    } else {
+        log(log_level::verbose, "Unchanged '{}'", cur_filename.native());
+    }
+
+    this->emitted.emplace_back(cur_filename, hash, changed);
+    cur_file_.str("");
+    cur_filename.clear();
 }
 
 void generator::print_indent() {
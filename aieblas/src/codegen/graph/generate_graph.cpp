@@ -5,6 +5,25 @@
 
 namespace aieblas {
 namespace codegen {
+std::string rtp_port_name(const kernel &kernel, const std::string &arg,
+                          unsigned replica) {
+    // Enabled inputs are numbered in the order of the kernel arguments
+    unsigned in_count = 0;
+    for (const kernel_arg &karg : get_kernel_args(kernel.operation)) {
+        if (karg.name == arg) {
+            return std::format("mygraph.{}.in[{}]",
+                               kernel_object(kernel, replica), in_count);
+        }
+        if (kernel.connections.at(karg.name).type != connection_type::none &&
+            karg.type != karg_type::output) {
+            in_count++;
+        }
+    }
+    throw std::runtime_error(std::format("Internal error: kernel {} has no "
+                                         "argument {}", kernel.user_name,
+                                         arg));
+}
+
 static inline void generate_graph_hdr(generator &gen) {
     gen.println("#include <adf.h>");
     for (const kernel &kernel : gen.get_data().kernels) {
@@ -20,7 +39,11 @@ static inline void generate_graph_hdr(generator &gen) {
     gen.println<generator::NO_INDENT>("private:");
 
     for (const kernel &kernel : gen.get_data().kernels) {
-        gen.println("kernel {}k;", kernel.user_name);
+        if (kernel.replicas > 1) {
+            gen.println("kernel {}k[{}];", kernel.user_name, kernel.replicas);
+        } else {
+            gen.println("kernel {}k;", kernel.user_name);
+        }
     }
 
     gen.println();
@@ -30,9 +53,18 @@ static inline void generate_graph_hdr(generator &gen) {
         std::unique_ptr<kernel_generator> kernel_gen =
                 get_kernel_generator(kernel);
         for (const kernel_arg &arg : kernel_gen->get_kernel_args()) {
-            if (kernel.connections.at(arg.name).type == connection_type::host) {
-                gen.println("{} {}_{};", kernel_arg_type_to_str(arg.type),
-                            kernel.user_name, arg.name);
+            if (kernel.connections.at(arg.name).type == connection_type::rtp) {
+                gen.println("port<input> {}_{};", kernel.user_name, arg.name);
+            } else if (kernel.connections.at(arg.name).type ==
+                       connection_type::host) {
+                const unsigned replicas = arg_replicas(kernel, arg);
+                for (unsigned r = 0; r < replicas; ++r) {
+                    gen.println("{} {};", kernel_arg_type_to_str(arg.type),
+                                replica_name(std::format("{}_{}",
+                                                         kernel.user_name,
+                                                         arg.name),
+                                             replicas, r));
+                }
             }
         }
     }
@@ -46,26 +78,27 @@ static inline void generate_graph_hdr(generator &gen) {
         gen.println("// initialize {}", kernel.user_name);
         for (const kernel_arg &arg : kernel_gen->get_kernel_args()) {
             if (kernel.connections.at(arg.name).type == connection_type::host) {
-                std::string plio_type;
-                // Manual override to keep index variables 64 bits
-                if (arg.type == karg_type::input_index) {
-                    plio_type = "plio_64_bits";
-                } else {
-                    unsigned bits = datatype_to_bits(kernel.type);
-                    if (bits < 32) {
-                        bits = 32;
-                    }
-                    plio_type= std::format("plio_{}_bits", bits);
-                }
+                const std::string plio_type =
+                        std::format("plio_{}_bits", plio_bits(kernel, arg));
 
-                gen.println("{1}_{2} = {0}::create(\"{1}_{2}\", {3}, \"data/"
-                            "{1}_{2}.txt\");", kernel_arg_type_to_str(arg.type),
-                            kernel.user_name, arg.name, plio_type);
+                const unsigned replicas = arg_replicas(kernel, arg);
+                for (unsigned r = 0; r < replicas; ++r) {
+                    gen.println("{0} = {1}::create(\"{0}\", {2}, \"data/"
+                                "{0}.txt\");",
+                                replica_name(std::format("{}_{}",
+                                                         kernel.user_name,
+                                                         arg.name),
+                                             replicas, r),
+                                kernel_arg_type_to_str(arg.type), plio_type);
+                }
             }
         }
 
         gen.println();
-        gen.println("{0}k = kernel::create({0});", kernel.user_name);
+        for (unsigned r = 0; r < kernel.replicas; ++r) {
+            gen.println("{} = kernel::create({});", kernel_object(kernel, r),
+                        kernel.user_name);
+        }
         gen.println();
     }
 
@@ -89,26 +122,49 @@ static inline void generate_graph_hdr(generator &gen) {
             const auto &connection = kernel.connections.at(arg.name);
 
             if (connection.type == connection_type::host) { // mapping to PLIO
-                if (arg.type == karg_type::input ||
-                    arg.type == karg_type::input_index) {
-                    std::string in_arg =
-                            std::format("{}k.in[{}]", kernel.user_name,
-                                        in_count);
-                    if (arg.async) {
-                        in_arg = std::format("async({})", in_arg);
+                // Scalars use a single PLIO that is broadcast to all replicas
+                const unsigned replicas = arg_replicas(kernel, arg);
+                for (unsigned r = 0; r < kernel.replicas; ++r) {
+                    if (r != 0) {
+                        name = std::format(" net{}", net_count);
+                        net_count++;
                     }
-                    gen.println("connect<{}>{}({}_{}.out[0], {});",
-                                type, name, kernel.user_name, arg.name, in_arg);
-                } else {
-                    std::string out_arg =
-                            std::format("{}k.out[{}]", kernel.user_name,
-                                        out_count);
-                    if (arg.async) {
-                        out_arg = std::format("async({})", out_arg);
+                    const std::string plio = replica_name(
+                            std::format("{}_{}", kernel.user_name, arg.name),
+                            replicas, r);
+                    if (arg.type == karg_type::input ||
+                        arg.type == karg_type::input_index) {
+                        std::string in_arg =
+                                std::format("{}.in[{}]",
+                                            kernel_object(kernel, r),
+                                            in_count);
+                        if (arg.async) {
+                            in_arg = std::format("async({})", in_arg);
+                        }
+                        gen.println("connect<{}>{}({}.out[0], {});",
+                                    type, name, plio, in_arg);
+                    } else {
+                        std::string out_arg =
+                                std::format("{}.out[{}]",
+                                            kernel_object(kernel, r),
+                                            out_count);
+                        if (arg.async) {
+                            out_arg = std::format("async({})", out_arg);
+                        }
+                        gen.println("connect<{}>{}({}, {}.in[0]);",
+                                    type, name, out_arg, plio);
                     }
-                    gen.println("connect<{}>{}({}, {}_{}.in[0]);",
-                                type, name, out_arg, kernel.user_name,
-                                arg.name);
+                }
+            } else if (connection.type == connection_type::rtp) {
+                // A single graph port updates the parameter of all replicas
+                for (unsigned r = 0; r < kernel.replicas; ++r) {
+                    if (r != 0) {
+                        name = std::format(" net{}", net_count);
+                        net_count++;
+                    }
+                    gen.println("connect<parameter>{}({}_{}, "
+                                "async({}.in[{}]));", name, kernel.user_name,
+                                arg.name, kernel_object(kernel, r), in_count);
                 }
             } else if (arg.type == karg_type::output) { // mapping to ext kernel
                 // find external kernel we are mapping against
@@ -189,12 +245,16 @@ static inline void generate_graph_hdr(generator &gen) {
         }
 
         gen.println();
-        gen.println("source({0}k) = \"kernels/{0}.cpp\";",
-                    kernel.user_name);
-        gen.println("runtime<ratio>({}k) = 0.9;", kernel.user_name);
-        if (kernel.tile_set) {
-            gen.println("location<kernel>({}k) = tile({}, {});",
-                        kernel.user_name, kernel.tile_x, kernel.tile_y);
+        for (unsigned r = 0; r < kernel.replicas; ++r) {
+            const std::string object = kernel_object(kernel, r);
+            gen.println("source({}) = \"kernels/{}.cpp\";", object,
+                        kernel.user_name);
+            gen.println("runtime<ratio>({}) = 0.9;", object);
+            if (kernel.tile_set) {
+                // Replicas are placed in consecutive columns
+                gen.println("location<kernel>({}) = tile({}, {});", object,
+                            kernel.tile_x + r, kernel.tile_y);
+            }
         }
         gen.println();
     }
@@ -212,12 +272,56 @@ static inline void generate_graph_src(generator &gen) {
     gen.println("adf::return_code ret;");
     gen.println("mygraph.init();");
     gen.println();
-    gen.println("ret = mygraph.run(1);");
+    bool rtp = false;
+    for (const kernel &kernel : gen.get_data().kernels) {
+        for (const kernel_arg &arg : get_kernel_args(kernel.operation)) {
+            if (kernel.connections.at(arg.name).type != connection_type::rtp) {
+                continue;
+            }
+            if (!rtp) {
+                gen.println("// Runtime parameters start at 1, the host "
+                            "updates them per call");
+                rtp = true;
+            }
+            gen.println("mygraph.update(mygraph.{}_{}, static_cast<{}>(1));",
+                        kernel.user_name, arg.name,
+                        datatype_to_str(kernel.type));
+        }
+    }
+    if (rtp) {
+        gen.println();
+    }
+    if (gen.get_data().persistent) {
+        gen.println("// Keep the graph running, the host feeds it jobs");
+        gen.println("ret = mygraph.run(-1);");
+    } else if (gen.get_data().sim_data) {
+        gen.println("// One iteration per window of the stimulus, sim_data "
+                    "writes their number");
+        gen.println("int iterations = 1;");
+        gen.println<generator::INCREASE_AFTER>("if (FILE *file = fopen("
+                                               "\"data/iterations.txt\", "
+                                               "\"r\")) {{");
+        gen.println<generator::INCREASE_AFTER>("if (fscanf(file, \"%d\", "
+                                               "&iterations) != 1) {{");
+        gen.println("iterations = 1;");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println("fclose(file);");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println("ret = mygraph.run(iterations);");
+    } else {
+        gen.println("ret = mygraph.run(1);");
+    }
     gen.println<generator::INCREASE_AFTER>("if (ret != adf::ok) {{");
     gen.println("printf(\"Run failed\\n\");");
     gen.println("return ret;");
     gen.println<generator::DECREASE_BEFORE>("}}");
     gen.println();
+
+    if (gen.get_data().persistent) {
+        gen.println("return 0;");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        return;
+    }
     gen.println("ret = mygraph.end();");
     gen.println<generator::INCREASE_AFTER>("if (ret != adf::ok) {{");
     gen.println("printf(\"End failed\\n\");");
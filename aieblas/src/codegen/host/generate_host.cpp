@@ -0,0 +1,1704 @@
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <tuple>
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/util/hash.hpp"
+#include "aieblas/detail/codegen/generator.hpp"
+#include "aieblas/detail/codegen/kernels.hpp"
+
+namespace aieblas {
+namespace codegen {
+
+/*
+ * Parameter of a generated host function, set on one or more PL kernel
+ * arguments or graph runtime parameter ports. Vectors and scalars are named
+ * after the port they are sent over, sizes keep their name.
+ */
+struct host_param {
+    pl_arg_type type;
+    std::string name;
+    std::vector<pl_kernel_arg> args;
+    std::vector<std::string> ports = {};
+};
+
+static inline std::string host_param_name(const kernel &kernel,
+                                          const pl_kernel_arg &arg) {
+    if (arg.arg.type == pl_arg_type::size) {
+        return arg.arg.name;
+    }
+    for (const pl_mover &mover :
+            get_kernel_generator(kernel)->get_pl_movers()) {
+        if (mover.name != arg.mover) {
+            continue;
+        }
+        for (const pl_port &port : mover.ports) {
+            if (port.host_arg == arg.arg.name) {
+                return port.arg;
+            }
+        }
+    }
+    return arg.arg.name;
+}
+
+// Parameters of the host function of kernel: scalars, vectors and sizes.
+static std::vector<host_param> get_host_params(generator &gen,
+                                               const kernel &kernel) {
+    std::vector<host_param> params;
+    for (const kernel_arg &arg : get_kernel_args(kernel.operation)) {
+        if (kernel.connections.at(arg.name).type != connection_type::rtp) {
+            continue;
+        }
+        std::vector<std::string> ports;
+        for (unsigned r = 0; r < kernel.replicas; ++r) {
+            ports.push_back(rtp_port_name(kernel, arg.name, r));
+        }
+        params.emplace_back(pl_arg_type::scalar, arg.name,
+                            std::vector<pl_kernel_arg>{}, std::move(ports));
+    }
+    for (pl_arg_type type : {pl_arg_type::scalar, pl_arg_type::memory,
+                             pl_arg_type::size}) {
+        for (const pl_kernel_arg &arg : get_pl_kernel_args(gen, kernel)) {
+            if (arg.implicit || arg.arg.type != type) {
+                continue;
+            }
+
+            const std::string name = host_param_name(kernel, arg);
+            auto param = std::find_if(params.begin(), params.end(),
+                [&name](const host_param &p) { return p.name == name; });
+            if (param == params.end()) {
+                params.emplace_back(type, name,
+                                    std::vector<pl_kernel_arg>{arg});
+            } else {
+                param->args.push_back(arg);
+            }
+        }
+    }
+    return params;
+}
+
+// Whether any scalar of the design is a runtime parameter of the graph.
+static bool has_rtp(generator &gen) {
+    for (const kernel &kernel : gen.get_data().kernels) {
+        for (const auto &[arg, conn] : kernel.connections) {
+            if (conn.type == connection_type::rtp) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// PL kernels used by kernel, in the order they are started.
+static std::vector<std::string> get_pl_kernels(generator &gen,
+                                               const kernel &kernel) {
+    if (gen.get_data().movers.merge) {
+        return {merged_mover_name};
+    }
+    std::vector<std::string> pl_kernels;
+    for (const pl_mover &mover :
+            get_kernel_generator(kernel)->get_pl_movers()) {
+        pl_kernels.push_back(std::format("{}_{}", kernel.user_name,
+                                         mover.name));
+    }
+    return pl_kernels;
+}
+
+static inline std::string host_param_decl(const kernel &kernel,
+                                          const host_param &param,
+                                          const std::string &prefix) {
+    switch (param.type) {
+    case pl_arg_type::memory:
+        return std::format("xrt::bo &{}{}", prefix, param.name);
+    case pl_arg_type::scalar:
+        return std::format("{} {}{}", datatype_to_host_type(kernel.type),
+                           prefix, param.name);
+    case pl_arg_type::size:
+        return std::format("std::uint64_t {}{}", prefix, param.name);
+    default:
+        throw std::runtime_error("Internal error: unexpected host parameter");
+    }
+}
+
+static inline std::string join_params(const std::vector<std::string> &params) {
+    std::string joined;
+    for (const std::string &param : params) {
+        joined.append(joined.empty() ? param : std::format(", {}", param));
+    }
+    return joined;
+}
+
+/*
+ * Declarations of the start functions. Without merged movers every kernel
+ * gets its own function, otherwise a single function starts the merged mover
+ * with the parameters of all kernels, prefixed with the kernel name.
+ */
+static std::vector<std::string> start_params(generator &gen,
+                                             const kernel &kernel,
+                                             bool prefixed) {
+    std::vector<std::string> decls;
+    const std::string prefix = prefixed ? kernel.user_name + "_" : "";
+    for (const host_param &param : get_host_params(gen, kernel)) {
+        decls.push_back(host_param_decl(kernel, param, prefix));
+    }
+    return decls;
+}
+
+/*
+ * Generate the buffer pool used by the alloc_ functions of the design. It is
+ * independent of the design, but generated with it so the host library does
+ * not depend on the aieblas sources.
+ */
+static void gen_host_pool(generator &gen) {
+    gen.println("#pragma once");
+    gen.println();
+    gen.println("#include <algorithm>");
+    gen.println("#include <bit>");
+    gen.println("#include <cstdint>");
+    gen.println("#include <map>");
+    gen.println("#include <mutex>");
+    gen.println("#include <stdexcept>");
+    gen.println("#include <utility>");
+    gen.println("#include <vector>");
+    gen.println("#include <xrt/xrt_bo.h>");
+    gen.println("#include <xrt/xrt_device.h>");
+    gen.println();
+    gen.println("namespace aieblas {{");
+    gen.println();
+    gen.println("/*");
+    gen.println(" * Pool of device buffers, so repeated calls do not allocate "
+                "and map new");
+    gen.println(" * buffers. Buffers are sub-buffers carved out of large "
+                "arenas per memory bank,");
+    gen.println(" * in power of two size classes. Released buffers go to a "
+                "free list per bank");
+    gen.println(" * and size class, and are handed out again by later requests "
+                "of the same class.");
+    gen.println(" * Arena memory is only returned to the device when the pool "
+                "is destroyed.");
+    gen.println(" * Acquire and release may be called from several threads, "
+                "such as the");
+    gen.println(" * completion callbacks of the streams.");
+    gen.println(" */");
+    gen.println<generator::INCREASE_AFTER>("class bo_pool {{");
+    gen.println<generator::DECREASE_BEFORE>("public:");
+    gen.indent_incr();
+    gen.println("// Smallest size class, sub-buffers must be aligned to it");
+    gen.println("static constexpr std::uint64_t min_block = 4096;");
+    gen.println();
+    gen.println("explicit bo_pool(xrt::device &device,");
+    gen.println("                 std::uint64_t arena_size = "
+                "std::uint64_t{{64}} << 20)");
+    gen.println("    : device(device), arena_size(arena_size) {{}}");
+    gen.println();
+    gen.println("// Sub-buffer of the given number of bytes in a memory "
+                "bank");
+    gen.println<generator::INCREASE_AFTER>("xrt::bo acquire(std::uint64_t "
+                                           "bytes, xrtMemoryGroup bank) {{");
+    gen.println("const std::uint64_t size = std::bit_ceil(std::max(bytes, "
+                "min_block));");
+    gen.println("const key k{{bank, size}};");
+    gen.println("std::lock_guard lock{{mutex}};");
+    gen.println("std::vector<block> &free = free_blocks[k];");
+    gen.println("block b;");
+    gen.println<generator::INCREASE_AFTER>("if (free.empty()) {{");
+    gen.println("b = carve(bank, size);");
+    gen.println<generator::DECREASE_BEFORE>("}} else {{");
+    gen.indent_incr();
+    gen.println("b = free.back();");
+    gen.println("free.pop_back();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("xrt::bo bo{{arenas[b.arena].bo, bytes, b.offset}};");
+    gen.println("used.emplace(bo.address(), std::pair{{k, b}});");
+    gen.println("return bo;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Return a buffer from acquire, it must no longer be used");
+    gen.println<generator::INCREASE_AFTER>("void release(const xrt::bo &bo) "
+                                           "{{");
+    gen.println("std::lock_guard lock{{mutex}};");
+    gen.println("auto it = used.find(bo.address());");
+    gen.println<generator::INCREASE_AFTER>("if (it == used.end()) {{");
+    gen.println("throw std::invalid_argument(\"Buffer not acquired from "
+                "this pool\");");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("free_blocks[it->second.first].push_back(it->second.second);");
+    gen.println("used.erase(it);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::DECREASE_BEFORE>("private:");
+    gen.indent_incr();
+    gen.println("// Bank and size class of a free list");
+    gen.println("using key = std::pair<xrtMemoryGroup, std::uint64_t>;");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("struct arena {{");
+    gen.println("xrt::bo bo;");
+    gen.println("xrtMemoryGroup bank;");
+    gen.println("std::uint64_t used;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("struct block {{");
+    gen.println("std::size_t arena;");
+    gen.println("std::uint64_t offset;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println("// Take a new block from an arena of bank, blocks larger "
+                "than an arena get");
+    gen.println("// their own. Called with mutex held");
+    gen.println<generator::INCREASE_AFTER>("block carve(xrtMemoryGroup bank, "
+                                           "std::uint64_t size) {{");
+    gen.println<generator::INCREASE_AFTER>("for (std::size_t i = 0; "
+                                           "i < arenas.size(); ++i) {{");
+    gen.println("arena &a = arenas[i];");
+    gen.println<generator::INCREASE_AFTER>("if (a.bank == bank && "
+                                           "a.used + size <= a.bo.size()) {{");
+    gen.println("a.used += size;");
+    gen.println("return block{{i, a.used - size}};");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("const std::uint64_t bytes = std::max(size, arena_size);");
+    gen.println("arenas.push_back(arena{{xrt::bo{{device, bytes, bank}}, "
+                "bank, size}});");
+    gen.println("return block{{arenas.size() - 1, 0}};");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("xrt::device &device;");
+    gen.println("const std::uint64_t arena_size;");
+    gen.println("// Guards arenas, free_blocks and used");
+    gen.println("std::mutex mutex;");
+    gen.println("std::vector<arena> arenas;");
+    gen.println("// Free blocks per bank and size class");
+    gen.println("std::map<key, std::vector<block>> free_blocks;");
+    gen.println("// Free list and block of acquired buffers by device "
+                "address");
+    gen.println("std::map<std::uint64_t, std::pair<key, block>> used;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println("}} // aieblas");
+}
+
+/*
+ * Generate the asynchronous command queue used by the enqueue_ functions of
+ * the design, so the next call can be prepared (e.g. its inputs synced) while
+ * the current one runs.
+ */
+static void gen_host_queue(generator &gen) {
+    gen.println("#pragma once");
+    gen.println();
+    gen.println("#include <chrono>");
+    gen.println("#include <condition_variable>");
+    gen.println("#include <deque>");
+    gen.println("#include <functional>");
+    gen.println("#include <future>");
+    gen.println("#include <mutex>");
+    gen.println("#include <thread>");
+    gen.println("#include <utility>");
+    gen.println("#include <vector>");
+    gen.println("#include <xrt/xrt_bo.h>");
+    gen.println();
+    gen.println("namespace aieblas {{");
+    gen.println();
+    gen.println("/*");
+    gen.println(" * Completion of a command enqueued on a stream. Waiting "
+                "rethrows the");
+    gen.println(" * exception of a failed command.");
+    gen.println(" */");
+    gen.println<generator::INCREASE_AFTER>("class event {{");
+    gen.println<generator::DECREASE_BEFORE>("public:");
+    gen.indent_incr();
+    gen.println("event() = default;");
+    gen.println("explicit event(std::shared_future<void> done) : "
+                "done(std::move(done)) {{}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("bool ready() const {{");
+    gen.println("return !done.valid() || "
+                "done.wait_for(std::chrono::seconds(0)) ==");
+    gen.println("                        std::future_status::ready;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("void wait() const {{");
+    gen.println<generator::INCREASE_AFTER>("if (done.valid()) {{");
+    gen.println("done.get();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::DECREASE_BEFORE>("private:");
+    gen.indent_incr();
+    gen.println("std::shared_future<void> done;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println("/*");
+    gen.println(" * In-order queue of host commands, executed by a worker "
+                "thread. Commands on");
+    gen.println(" * different streams run concurrently, e.g. uploading the "
+                "inputs of the next");
+    gen.println(" * call on one stream while another waits for the current "
+                "call. A command");
+    gen.println(" * starts after all commands enqueued before it on the same "
+                "stream and all");
+    gen.println(" * events it depends on, a command whose dependency failed "
+                "fails as well.");
+    gen.println(" */");
+    gen.println<generator::INCREASE_AFTER>("class stream {{");
+    gen.println<generator::DECREASE_BEFORE>("public:");
+    gen.indent_incr();
+    gen.println("using command = std::function<void()>;");
+    gen.println("using callback = std::function<void()>;");
+    gen.println();
+    gen.println("stream() : worker([this] {{ run(); }}) {{}}");
+    gen.println();
+    gen.println("stream(const stream &) = delete;");
+    gen.println("stream &operator=(const stream &) = delete;");
+    gen.println();
+    gen.println("// Finishes all enqueued commands");
+    gen.println<generator::INCREASE_AFTER>("~stream() {{");
+    gen.println<generator::INCREASE_AFTER>("{{");
+    gen.println("std::lock_guard<std::mutex> lock(mutex);");
+    gen.println("stopping = true;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("cv.notify_one();");
+    gen.println("worker.join();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Enqueue cmd, done is called on the worker thread once it "
+                "succeeded.");
+    gen.println("event enqueue(command cmd, std::vector<event> deps = {{}},");
+    gen.println<generator::INCREASE_AFTER>("              callback done = "
+                                           "{{}}) {{");
+    gen.println("std::packaged_task<void()> task(");
+    gen.println("    [cmd = std::move(cmd), deps = std::move(deps),");
+    gen.println<generator::INCREASE_AFTER>("     done = std::move(done)] {{");
+    gen.println<generator::INCREASE_AFTER>("    for (const event &dep : deps) "
+                                           "{{");
+    gen.println("    dep.wait();");
+    gen.println<generator::DECREASE_BEFORE>("    }}");
+    gen.println("    cmd();");
+    gen.println<generator::INCREASE_AFTER>("    if (done) {{");
+    gen.println("    done();");
+    gen.println<generator::DECREASE_BEFORE>("    }}");
+    gen.println<generator::DECREASE_BEFORE>("    }});");
+    gen.println("event e{{task.get_future().share()}};");
+    gen.println<generator::INCREASE_AFTER>("{{");
+    gen.println("std::lock_guard<std::mutex> lock(mutex);");
+    gen.println("tasks.push_back(std::move(task));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("cv.notify_one();");
+    gen.println("return e;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Wait for all commands enqueued so far");
+    gen.println<generator::INCREASE_AFTER>("void synchronize() {{");
+    gen.println("enqueue([] {{}}).wait();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::DECREASE_BEFORE>("private:");
+    gen.indent_incr();
+    gen.println<generator::INCREASE_AFTER>("void run() {{");
+    gen.println<generator::INCREASE_AFTER>("while (true) {{");
+    gen.println("std::packaged_task<void()> task;");
+    gen.println<generator::INCREASE_AFTER>("{{");
+    gen.println("std::unique_lock<std::mutex> lock(mutex);");
+    gen.println("cv.wait(lock, [this] {{ return stopping || !tasks.empty(); "
+                "}});");
+    gen.println<generator::INCREASE_AFTER>("if (tasks.empty()) {{");
+    gen.println("return;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("task = std::move(tasks.front());");
+    gen.println("tasks.pop_front();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("task();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("std::mutex mutex;");
+    gen.println("std::condition_variable cv;");
+    gen.println("std::deque<std::packaged_task<void()>> tasks;");
+    gen.println("bool stopping = false;");
+    gen.println("std::thread worker;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println("// Enqueue a sync of bo in direction dir");
+    gen.println("inline event enqueue_sync(stream &s, xrt::bo bo, "
+                "xclBOSyncDirection dir,");
+    gen.println<generator::INCREASE_AFTER>("                          "
+                                           "std::vector<event> deps = {{}}) "
+                                           "{{");
+    gen.println("return s.enqueue([bo, dir]() mutable {{ bo.sync(dir); }},");
+    gen.println("                 std::move(deps));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("}} // aieblas");
+
+}
+
+static void gen_host_header(generator &gen) {
+    const data &d = gen.get_data();
+
+    gen.println("#pragma once");
+    gen.println();
+    gen.println("#include <chrono>");
+    gen.println("#include <cstdint>");
+    gen.println("#include <vector>");
+    gen.println("#include <xrt/xrt_bo.h>");
+    gen.println("#include <xrt/xrt_device.h>");
+    if (has_rtp(gen)) {
+        gen.println("#include <xrt/xrt_graph.h>");
+    }
+    gen.println("#include <xrt/xrt_kernel.h>");
+    gen.println("#include <xrt/xrt_uuid.h>");
+    gen.println();
+    gen.println("#include \"bo_pool.hpp\"");
+    gen.println("#include \"queue.hpp\"");
+    gen.println();
+    gen.println("namespace aieblas {{");
+    gen.println();
+    gen.println("/*");
+    gen.println(" * Host interface of the generated design. Vectors are passed "
+                "as device");
+    gen.println(" * buffers, which should be allocated with the alloc_ "
+                "functions to end up in");
+    gen.println(" * the memory bank of their data mover, and synced by the "
+                "caller. Allocated");
+    gen.println(" * buffers come from a pool, releasing them lets later calls "
+                "reuse them.");
+    if (has_rtp(gen)) {
+        gen.println(" * Scalars are runtime parameters of the graph, updated "
+                    "when a routine starts,");
+        gen.println(" * so routines using them should not overlap.");
+    }
+    gen.println(" */");
+    gen.println<generator::INCREASE_AFTER>("class design {{");
+    gen.println<generator::DECREASE_BEFORE>("public:");
+    gen.indent_incr();
+    gen.println("design(xrt::device &device, const xrt::uuid &uuid);");
+    gen.println("design(const design &) = delete;");
+    gen.println("design &operator=(const design &) = delete;");
+    gen.println();
+
+    gen.println("// Allocate a buffer of count elements for a vector argument");
+    for (const kernel &kernel : d.kernels) {
+        for (const host_param &param : get_host_params(gen, kernel)) {
+            if (param.type == pl_arg_type::memory) {
+                gen.println("xrt::bo alloc_{}_{}(std::uint64_t count);",
+                            kernel.user_name, param.name);
+            }
+        }
+    }
+    gen.println("// Return a buffer from an alloc_ function to the pool");
+    gen.println("void release(const xrt::bo &bo);");
+    gen.println();
+
+    if (d.movers.merge) {
+        std::vector<std::string> params;
+        for (const kernel &kernel : d.kernels) {
+            for (std::string &param : start_params(gen, kernel, true)) {
+                params.push_back(std::move(param));
+            }
+        }
+        gen.println("// Start the data movers of all routines");
+        gen.println("void start({});", join_params(params));
+        gen.println("void run({});", join_params(params));
+        gen.println();
+        gen.println("// Enqueue run on queue, calls of a design must all use "
+                    "the same stream");
+        params.push_back("std::vector<event> deps = {}");
+        gen.println("event enqueue_run(stream &queue, {});",
+                    join_params(params));
+    } else {
+        gen.println("// Start a routine without waiting for it, routines "
+                    "connected to each other");
+        gen.println("// must all be started before waiting");
+        for (const kernel &kernel : d.kernels) {
+            if (!get_pl_kernels(gen, kernel).empty()) {
+                gen.println("void start_{}({});", kernel.user_name,
+                            join_params(start_params(gen, kernel, false)));
+            }
+        }
+        gen.println();
+        gen.println("// Run a single routine until it finishes");
+        for (const kernel &kernel : d.kernels) {
+            if (!get_pl_kernels(gen, kernel).empty()) {
+                gen.println("void {}({});", kernel.user_name,
+                            join_params(start_params(gen, kernel, false)));
+            }
+        }
+        gen.println();
+        gen.println("// Enqueue running a single routine on queue, calls of "
+                    "a design must all use");
+        gen.println("// the same stream");
+        for (const kernel &kernel : d.kernels) {
+            if (!get_pl_kernels(gen, kernel).empty()) {
+                std::vector<std::string> params =
+                    start_params(gen, kernel, false);
+                params.push_back("std::vector<event> deps = {}");
+                gen.println("event enqueue_{}(stream &queue, {});",
+                            kernel.user_name, join_params(params));
+            }
+        }
+    }
+    gen.println();
+    gen.println("// Wait for all started routines, returns false if any timed "
+                "out");
+    gen.println("bool wait(std::chrono::milliseconds timeout = "
+                "std::chrono::milliseconds{{0}});");
+    gen.println();
+
+    gen.println<generator::DECREASE_BEFORE>("private:");
+    gen.indent_incr();
+    gen.println("xrt::device device;");
+    gen.println("bo_pool pool;");
+    if (has_rtp(gen)) {
+        gen.println("xrt::graph graph;");
+    }
+    std::vector<std::string> pl_kernels;
+    for (const kernel &kernel : d.kernels) {
+        for (std::string &pl_kernel : get_pl_kernels(gen, kernel)) {
+            if (std::find(pl_kernels.begin(), pl_kernels.end(), pl_kernel) ==
+                pl_kernels.end()) {
+                pl_kernels.push_back(std::move(pl_kernel));
+            }
+        }
+    }
+    for (const std::string &pl_kernel : pl_kernels) {
+        gen.println("xrt::kernel {};", pl_kernel);
+    }
+    for (const std::string &pl_kernel : pl_kernels) {
+        gen.println("xrt::run {}_run;", pl_kernel);
+    }
+    gen.println("std::vector<xrt::run *> started;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println("}} // aieblas");
+}
+
+static void gen_host_set_args(generator &gen, const kernel &kernel,
+                              const std::string &prefix) {
+    for (const host_param &param : get_host_params(gen, kernel)) {
+        for (const std::string &port : param.ports) {
+            gen.println("graph.update(\"{}\", {}{});", port, prefix,
+                        param.name);
+        }
+        for (const pl_kernel_arg &arg : param.args) {
+            gen.println("{}_run.set_arg({}, {}{});", arg.pl_kernel, arg.index,
+                        prefix, param.name);
+        }
+    }
+    for (const pl_kernel_arg &arg : get_pl_kernel_args(gen, kernel)) {
+        if (!arg.implicit) {
+            continue;
+        } else if (arg.arg.type == pl_arg_type::flag) {
+            gen.println("{}_run.set_arg({}, false);", arg.pl_kernel,
+                        arg.index);
+        } else {
+            gen.println("{}_run.set_arg({}, std::uint64_t{{0}});",
+                        arg.pl_kernel, arg.index);
+        }
+    }
+}
+
+static void gen_host_start(generator &gen,
+                           const std::vector<std::string> &pl_kernels) {
+    for (const std::string &pl_kernel : pl_kernels) {
+        gen.println("{}_run.start();", pl_kernel);
+        gen.println("started.push_back(&{}_run);", pl_kernel);
+    }
+}
+
+// Buffers are copied into the command, as the caller's may be gone when it
+// runs.
+static void gen_host_enqueue(generator &gen, const std::string &name,
+                             const std::string &params,
+                             const std::string &names) {
+    gen.println<generator::INCREASE_AFTER>(
+        "event design::enqueue_{}(stream &queue, {}) {{", name, params);
+    gen.println<generator::INCREASE_AFTER>("return queue.enqueue([=, this]() "
+                                           "mutable {{");
+    gen.println("{}({});", name, names);
+    gen.println<generator::DECREASE_BEFORE>("}}, std::move(deps));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+}
+
+static void gen_host_source(generator &gen) {
+    const data &d = gen.get_data();
+
+    gen.println("#include \"aieblas.hpp\"");
+    gen.println();
+    gen.println("namespace aieblas {{");
+    gen.println();
+
+    std::vector<std::string> pl_kernels;
+    for (const kernel &kernel : d.kernels) {
+        for (std::string &pl_kernel : get_pl_kernels(gen, kernel)) {
+            if (std::find(pl_kernels.begin(), pl_kernels.end(), pl_kernel) ==
+                pl_kernels.end()) {
+                pl_kernels.push_back(std::move(pl_kernel));
+            }
+        }
+    }
+    std::vector<std::string> inits{"device(device)", "pool(this->device)"};
+    if (has_rtp(gen)) {
+        inits.push_back("graph(device, uuid, \"mygraph\")");
+    }
+    for (const std::string &pl_kernel : pl_kernels) {
+        inits.push_back(std::format("{0}(device, uuid, \"{0}\")", pl_kernel));
+    }
+    for (const std::string &pl_kernel : pl_kernels) {
+        inits.push_back(std::format("{0}_run({0})", pl_kernel));
+    }
+    gen.println("design::design(xrt::device &device, const xrt::uuid &uuid)");
+    gen.indent_incr();
+    for (std::size_t i = 0; i < inits.size(); ++i) {
+        gen.println("{} {}{}", i == 0 ? ":" : " ", inits[i],
+                    i + 1 == inits.size() ? " {}" : ",");
+    }
+    gen.indent_decr();
+    gen.println();
+
+    for (const kernel &kernel : d.kernels) {
+        for (const host_param &param : get_host_params(gen, kernel)) {
+            if (param.type != pl_arg_type::memory) {
+                continue;
+            }
+            const pl_kernel_arg &arg = param.args.front();
+            gen.println<generator::INCREASE_AFTER>(
+                "xrt::bo design::alloc_{}_{}(std::uint64_t count) {{",
+                kernel.user_name, param.name);
+            gen.println("return pool.acquire(count * sizeof({}), "
+                        "{}.group_id({}));",
+                        datatype_to_host_type(kernel.type), arg.pl_kernel,
+                        arg.index);
+            gen.println<generator::DECREASE_BEFORE>("}}");
+            gen.println();
+        }
+    }
+    gen.println<generator::INCREASE_AFTER>("void design::release(const "
+                                           "xrt::bo &bo) {{");
+    gen.println("pool.release(bo);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+
+    if (d.movers.merge) {
+        std::vector<std::string> params;
+        std::vector<std::string> names;
+        for (const kernel &kernel : d.kernels) {
+            for (std::string &param : start_params(gen, kernel, true)) {
+                params.push_back(std::move(param));
+            }
+            for (const host_param &param : get_host_params(gen, kernel)) {
+                names.push_back(kernel.user_name + "_" + param.name);
+            }
+        }
+        gen.println<generator::INCREASE_AFTER>("void design::start({}) {{",
+                                               join_params(params));
+        for (const kernel &kernel : d.kernels) {
+            gen_host_set_args(gen, kernel, kernel.user_name + "_");
+        }
+        gen_host_start(gen, pl_kernels);
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println();
+        gen.println<generator::INCREASE_AFTER>("void design::run({}) {{",
+                                               join_params(params));
+        gen.println("start({});", join_params(names));
+        gen.println("wait();");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println();
+        params.push_back("std::vector<event> deps");
+        gen_host_enqueue(gen, "run", join_params(params), join_params(names));
+    } else {
+        for (const kernel &kernel : d.kernels) {
+            if (get_pl_kernels(gen, kernel).empty()) {
+                continue;
+            }
+            const std::string params =
+                join_params(start_params(gen, kernel, false));
+            std::vector<std::string> names;
+            for (const host_param &param : get_host_params(gen, kernel)) {
+                names.push_back(param.name);
+            }
+
+            gen.println<generator::INCREASE_AFTER>(
+                "void design::start_{}({}) {{", kernel.user_name, params);
+            gen_host_set_args(gen, kernel, "");
+            gen_host_start(gen, get_pl_kernels(gen, kernel));
+            gen.println<generator::DECREASE_BEFORE>("}}");
+            gen.println();
+            gen.println<generator::INCREASE_AFTER>("void design::{}({}) {{",
+                                                   kernel.user_name, params);
+            gen.println("start_{}({});", kernel.user_name, join_params(names));
+            gen.println("wait();");
+            gen.println<generator::DECREASE_BEFORE>("}}");
+            gen.println();
+            gen_host_enqueue(gen, kernel.user_name,
+                             params + ", std::vector<event> deps",
+                             join_params(names));
+        }
+    }
+
+    gen.println<generator::INCREASE_AFTER>("bool design::wait("
+                                           "std::chrono::milliseconds "
+                                           "timeout) {{");
+    gen.println("bool finished = true;");
+    gen.println<generator::INCREASE_AFTER>("for (xrt::run *run : started) {{");
+    gen.println("finished &= run->wait(timeout) != ERT_CMD_STATE_TIMEOUT;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("started.clear();");
+    gen.println("return finished;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("}} // aieblas");
+}
+
+// PL kernel argument moving kernel argument name from or to the host.
+static pl_kernel_arg mock_arg(generator &gen, const kernel &kernel,
+                              const std::string &name) {
+    const std::vector<pl_kernel_arg> args = get_pl_kernel_args(gen, kernel);
+    for (const pl_mover &mover :
+            get_kernel_generator(kernel)->get_pl_movers()) {
+        for (const pl_port &port : mover.ports) {
+            if (port.arg != name) {
+                continue;
+            }
+            for (const pl_kernel_arg &arg : args) {
+                if (arg.mover == mover.name && arg.arg.name == port.host_arg) {
+                    return arg;
+                }
+            }
+        }
+    }
+    throw std::runtime_error(std::format("Internal error: no PL argument for "
+                                         "{} of {}", name, kernel.user_name));
+}
+
+static std::optional<pl_kernel_arg> mock_size_arg(generator &gen,
+                                                  const kernel &kernel) {
+    for (const pl_kernel_arg &arg : get_pl_kernel_args(gen, kernel)) {
+        if (!arg.implicit && arg.arg.type == pl_arg_type::size) {
+            return arg;
+        }
+    }
+    return std::nullopt;
+}
+
+/*
+ * Kernels connected to each other form a group, which the mock executes as a
+ * single routine once all its PL kernels are started. With merged movers all
+ * kernels share one PL kernel and thus one group. Kernels are ordered so
+ * producers come before their consumers.
+ */
+static std::vector<std::vector<const kernel *>> mock_groups(generator &gen) {
+    const data &d = gen.get_data();
+    std::vector<std::size_t> group_ids(d.kernels.size());
+    for (std::size_t i = 0; i < d.kernels.size(); ++i) {
+        group_ids[i] = d.movers.merge ? 0 : i;
+    }
+    auto index_of = [&d](const std::string &name) {
+        for (std::size_t i = 0; i < d.kernels.size(); ++i) {
+            if (d.kernels[i].user_name == name) {
+                return i;
+            }
+        }
+        throw std::runtime_error(std::format("Internal error: unknown kernel "
+                                             "{}", name));
+    };
+    for (std::size_t i = 0; i < d.kernels.size(); ++i) {
+        for (const auto &[arg, conn] : d.kernels[i].connections) {
+            if (conn.type != connection_type::kernel) {
+                continue;
+            }
+            const std::size_t from = group_ids[index_of(conn.kernel)];
+            const std::size_t to = group_ids[i];
+            std::replace(group_ids.begin(), group_ids.end(), from, to);
+        }
+    }
+
+    std::vector<std::size_t> order;
+    while (order.size() < d.kernels.size()) {
+        const std::size_t before = order.size();
+        for (std::size_t i = 0; i < d.kernels.size(); ++i) {
+            if (std::find(order.begin(), order.end(), i) != order.end()) {
+                continue;
+            }
+            bool ready = true;
+            for (const kernel_arg &arg : get_kernel_args(
+                    d.kernels[i].operation)) {
+                const connection &conn = d.kernels[i].connections.at(arg.name);
+                if (arg.type != karg_type::output &&
+                    conn.type == connection_type::kernel &&
+                    std::find(order.begin(), order.end(),
+                              index_of(conn.kernel)) == order.end()) {
+                    ready = false;
+                }
+            }
+            if (ready) {
+                order.push_back(i);
+            }
+        }
+        if (order.size() == before) {
+            throw std::runtime_error("Internal error: cyclic kernel "
+                                     "connections");
+        }
+    }
+
+    std::vector<std::size_t> ids;
+    std::vector<std::vector<const kernel *>> groups;
+    for (std::size_t i : order) {
+        auto id = std::find(ids.begin(), ids.end(), group_ids[i]);
+        if (id == ids.end()) {
+            ids.push_back(group_ids[i]);
+            groups.emplace_back();
+            id = ids.end() - 1;
+        }
+        groups[id - ids.begin()].push_back(&d.kernels[i]);
+    }
+    return groups;
+}
+
+/*
+ * Generate the execution of kernel within a routine. Arguments moved by a PL
+ * kernel are looked up in the runs of the routine, arguments connected to
+ * another kernel use the results of that kernel.
+ */
+static void gen_mock_kernel(generator &gen, const kernel &kernel,
+                            const std::string &group_size) {
+    const std::unique_ptr<kernel_generator> kernel_gen =
+        get_kernel_generator(kernel);
+    const char *type = datatype_to_host_type(kernel.type);
+
+    gen.println("// {}", kernel.user_name);
+    gen.println<generator::INCREASE_AFTER>("{{");
+    const std::optional<pl_kernel_arg> size = mock_size_arg(gen, kernel);
+    if (size) {
+        gen.println("const std::uint64_t size = r.scalar<std::uint64_t>("
+                    "\"{}\", {});", size->pl_kernel, size->index);
+    } else {
+        gen.println("const std::uint64_t size = {};", group_size);
+    }
+
+    for (const kernel_arg &arg : kernel_gen->get_kernel_args()) {
+        const connection &conn = kernel.connections.at(arg.name);
+        const bool input = arg.type != karg_type::output;
+        if (arg.type == karg_type::input_index ||
+            conn.type == connection_type::none) {
+            continue;
+        } else if (conn.type == connection_type::rtp) {
+            // All replicas get the same value
+            gen.println("const {0} {1} = r.parameter<{0}>(\"{2}\");", type,
+                        arg.name, rtp_port_name(kernel, arg.name, 0));
+        } else if (conn.type == connection_type::host) {
+            // Scalar results are written to a buffer as well
+            const pl_kernel_arg pl_arg = mock_arg(gen, kernel, arg.name);
+            if (input && arg.dimensions == 0) {
+                gen.println("const {0} {1} = r.scalar<{0}>(\"{2}\", {3});",
+                            type, arg.name, pl_arg.pl_kernel, pl_arg.index);
+            } else {
+                gen.println("{0}{1} *{2} = r.buffer<{1}>(\"{3}\", {4});",
+                            input ? "const " : "", type, arg.name,
+                            pl_arg.pl_kernel, pl_arg.index);
+            }
+        } else if (input) {
+            const std::string result =
+                std::format("{}_{}", conn.kernel, conn.parameter);
+            if (arg.dimensions == 0) {
+                gen.println("const {} {} = {}[0];", type, arg.name, result);
+            } else {
+                gen.println("const {} *{} = {}.data();", type, arg.name,
+                            result);
+            }
+        } else {
+            const std::string result =
+                std::format("{}_{}", kernel.user_name, arg.name);
+            gen.println("{}.resize({});", result,
+                        arg.dimensions == 0 ? "1" : "size");
+            gen.println("{} *{} = {}.data();", type, arg.name, result);
+        }
+    }
+
+    kernel_gen->gen_mock(gen);
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+static void gen_host_mock(generator &gen) {
+    gen.println("#include <cmath>");
+    gen.println("#include <cstdint>");
+    gen.println("#include <vector>");
+    gen.println("#include <xrt/mock.h>");
+    gen.println();
+    gen.println("// CPU implementation of the design for the mock XRT "
+                "backend");
+    gen.println("namespace {{");
+    gen.println();
+
+    for (const std::vector<const kernel *> &group : mock_groups(gen)) {
+        std::vector<std::string> pl_kernels;
+        std::string group_size = "0";
+        for (const kernel *kernel : group) {
+            for (std::string &pl_kernel : get_pl_kernels(gen, *kernel)) {
+                if (std::find(pl_kernels.begin(), pl_kernels.end(),
+                              pl_kernel) == pl_kernels.end()) {
+                    pl_kernels.push_back(std::move(pl_kernel));
+                }
+            }
+            const std::optional<pl_kernel_arg> size =
+                mock_size_arg(gen, *kernel);
+            if (size && group_size == "0") {
+                group_size = std::format("r.scalar<std::uint64_t>(\"{}\", "
+                                         "{})", size->pl_kernel, size->index);
+            }
+        }
+        if (pl_kernels.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> names;
+        for (const std::string &pl_kernel : pl_kernels) {
+            names.push_back(std::format("\"{}\"", pl_kernel));
+        }
+        gen.println("const bool {}_registered = xrt::mock::add_routine(",
+                    group.front()->user_name);
+        gen.indent_incr();
+        gen.println("{{{}}},", join_params(names));
+        gen.println<generator::INCREASE_AFTER>("[](xrt::mock::routine &r) {{");
+        for (const kernel *kernel : group) {
+            for (const kernel_arg &arg : get_kernel_args(kernel->operation)) {
+                if (arg.type == karg_type::output &&
+                    kernel->connections.at(arg.name).type ==
+                        connection_type::kernel) {
+                    gen.println("std::vector<{}> {}_{};",
+                                datatype_to_host_type(kernel->type),
+                                kernel->user_name, arg.name);
+                }
+            }
+        }
+        for (const kernel *kernel : group) {
+            gen_mock_kernel(gen, *kernel, group_size);
+        }
+        gen.println<generator::DECREASE_BEFORE>("}});");
+        gen.indent_decr();
+        gen.println();
+    }
+
+    gen.println("}} // anonymous namespace");
+}
+
+// Floating point (or integer) operations per element of the largest input.
+static unsigned ops_per_element(blas_op op) {
+    switch (op) {
+    case blas_op::axpy:
+    case blas_op::dot:
+    case blas_op::gemv:
+    case blas_op::nrm2:
+        return 2;
+    case blas_op::rot:
+        return 6;
+    default:
+        return 1;
+    }
+}
+
+// Port moving the vector parameter param of kernel from or to the host.
+static const pl_port &host_param_port(const kernel &kernel,
+                                      const std::vector<pl_mover> &movers,
+                                      const host_param &param) {
+    const pl_kernel_arg &arg = param.args.front();
+    for (const pl_mover &mover : movers) {
+        if (mover.name != arg.mover) {
+            continue;
+        }
+        for (const pl_port &port : mover.ports) {
+            if (port.host_arg == arg.arg.name) {
+                return port;
+            }
+        }
+    }
+    throw std::runtime_error(std::format("Internal error: no port for {} of "
+                                         "{}", param.name, kernel.user_name));
+}
+
+/*
+ * Generate the benchmark of a group of connected kernels: allocate, fill and
+ * sync the vectors of all kernels, run them together and sync the outputs
+ * back, timing every phase. Sizes are the problem size, defines of the movers
+ * keep their value.
+ */
+static void gen_bench_routine(generator &gen,
+                              const std::vector<const kernel *> &group,
+                              const std::string &name,
+                              const std::string &function) {
+    const data &d = gen.get_data();
+    gen.println<generator::INCREASE_AFTER>("sample {}(aieblas::design &d, "
+                                           "std::uint64_t problem_size) {{",
+                                           function);
+    std::set<std::string> declared;
+    for (const kernel *kernel : group) {
+        for (const pl_mover &mover :
+                get_kernel_generator(*kernel)->get_pl_movers()) {
+            for (const pl_arg &arg : mover.args) {
+                if (arg.type == pl_arg_type::size &&
+                    declared.insert(arg.name).second) {
+                    gen.println("const std::uint64_t {} = problem_size;",
+                                arg.name);
+                }
+            }
+            for (const std::string &define : mover.defines) {
+                const std::size_t split = define.find(' ');
+                const std::string name = define.substr(0, split);
+                if (split != std::string::npos &&
+                    declared.insert(name).second) {
+                    gen.println("const std::uint64_t {} = {};", name,
+                                define.substr(split + 1));
+                }
+            }
+        }
+    }
+    gen.println("sample s{{}};");
+
+    // Vectors, split by direction, as (name, type, length). The elements of
+    // a kernel are those of its largest input.
+    std::vector<std::tuple<std::string, const char *, std::string>> inputs;
+    std::vector<std::tuple<std::string, const char *, std::string>> outputs;
+    for (const kernel *kernel : group) {
+        const std::vector<pl_mover> movers =
+            get_kernel_generator(*kernel)->get_pl_movers();
+        std::set<std::string> lengths;
+        for (const host_param &param : get_host_params(gen, *kernel)) {
+            if (param.type != pl_arg_type::memory) {
+                continue;
+            }
+            const pl_port &port = host_param_port(*kernel, movers, param);
+            const std::string name = kernel->user_name + "_" + param.name;
+            const char *type = datatype_to_host_type(kernel->type);
+            if (pl_port_is_input(port.type)) {
+                inputs.emplace_back(name, type, port.length);
+                lengths.insert(port.length);
+            } else {
+                outputs.emplace_back(name, type, port.length);
+            }
+            gen.println("s.bytes += ({}) * sizeof({});", port.length, type);
+        }
+        if (lengths.empty()) {
+            continue;
+        }
+        std::string largest;
+        for (const std::string &length : lengths) {
+            largest = largest.empty() ? length :
+                std::format("std::max<std::uint64_t>({}, {})", largest,
+                            length);
+        }
+        gen.println("s.elements += {};", largest);
+        gen.println("s.ops += {} * ({});", ops_per_element(kernel->operation),
+                    largest);
+    }
+
+    // Scalars are 1, so results stay in range over repetitions
+    for (const kernel *kernel : group) {
+        for (const host_param &param : get_host_params(gen, *kernel)) {
+            if (param.type == pl_arg_type::scalar) {
+                gen.println("const {} {}_{} = 1;",
+                            datatype_to_host_type(kernel->type),
+                            kernel->user_name, param.name);
+            }
+        }
+    }
+    gen.println();
+
+    gen.println("clock_type::time_point t = clock_type::now();");
+    for (const auto &vectors : {inputs, outputs}) {
+        for (const auto &[name, type, length] : vectors) {
+            gen.println("xrt::bo {0} = d.alloc_{0}({1});", name, length);
+        }
+    }
+    gen.println("s.alloc = elapsed_ms(t);");
+    for (const auto &[name, type, length] : inputs) {
+        gen.println("fill<{}>({}, {});", type, name, length);
+    }
+    gen.println("t = clock_type::now();");
+    for (const auto &[name, type, length] : inputs) {
+        gen.println("{}.sync(XCL_BO_SYNC_BO_TO_DEVICE);", name);
+    }
+    gen.println("s.sync_in = elapsed_ms(t);");
+
+    // Merged movers take the parameters of all kernels in the order of the
+    // design
+    std::vector<std::string> merged_names;
+    for (const kernel &kernel : d.kernels) {
+        if (std::find(group.begin(), group.end(), &kernel) == group.end()) {
+            continue;
+        }
+        std::vector<std::string> names;
+        for (const host_param &param : get_host_params(gen, kernel)) {
+            names.push_back(param.type == pl_arg_type::size ? param.name :
+                            kernel.user_name + "_" + param.name);
+        }
+        if (d.movers.merge) {
+            merged_names.insert(merged_names.end(), names.begin(),
+                                names.end());
+        } else if (!get_pl_kernels(gen, kernel).empty()) {
+            gen.println("d.start_{}({});", kernel.user_name,
+                        join_params(names));
+        }
+    }
+    if (d.movers.merge) {
+        gen.println("d.start({});", join_params(merged_names));
+    }
+    gen.println<generator::INCREASE_AFTER>("if (!d.wait()) {{");
+    gen.println("throw std::runtime_error(\"{} timed out\");", name);
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("s.run = elapsed_ms(t);");
+    for (const auto &[name, type, length] : outputs) {
+        gen.println("{}.sync(XCL_BO_SYNC_BO_FROM_DEVICE);", name);
+    }
+    gen.println("s.sync_out = elapsed_ms(t);");
+    gen.println();
+    for (const auto &vectors : {inputs, outputs}) {
+        for (const auto &[name, type, length] : vectors) {
+            gen.println("d.release({});", name);
+        }
+    }
+    gen.println("return s;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+static void gen_bench_helpers(generator &gen) {
+    gen.println("using clock_type = std::chrono::steady_clock;");
+    gen.println();
+    gen.println("// Host-side phases of a call in ms, and the work it does");
+    gen.println<generator::INCREASE_AFTER>("struct sample {{");
+    gen.println("double alloc;");
+    gen.println("double sync_in;");
+    gen.println("double run;");
+    gen.println("double sync_out;");
+    gen.println("std::uint64_t elements;");
+    gen.println("std::uint64_t bytes;");
+    gen.println("std::uint64_t ops;");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("double total() const {{");
+    gen.println("return alloc + sync_in + run + sync_out;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println("// Time since t in ms, and restart t");
+    gen.println<generator::INCREASE_AFTER>("double elapsed_ms(clock_type::"
+                                           "time_point &t) {{");
+    gen.println("const clock_type::time_point now = clock_type::now();");
+    gen.println("const double ms = std::chrono::duration<double, "
+                "std::milli>(now - t).count();");
+    gen.println("t = now;");
+    gen.println("return ms;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("void fill(xrt::bo &bo, "
+                                           "std::uint64_t count) {{");
+    gen.println("T *values = bo.map<T *>();");
+    gen.println<generator::INCREASE_AFTER>("for (std::uint64_t i = 0; "
+                                           "i < count; ++i) {{");
+    gen.println("values[i] = static_cast<T>(i % 8);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Nearest-rank percentile p of sorted values");
+    gen.println<generator::INCREASE_AFTER>("double percentile(const "
+                                           "std::vector<double> &sorted, "
+                                           "double p) {{");
+    gen.println("const std::size_t rank = static_cast<std::size_t>(");
+    gen.println("    std::ceil(p / 100 * sorted.size()));");
+    gen.println("return sorted[std::max<std::size_t>(rank, 1) - 1];");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Median of a phase over the samples");
+    gen.println<generator::INCREASE_AFTER>("double median(const "
+                                           "std::vector<sample> &samples, "
+                                           "double sample::*phase) {{");
+    gen.println("std::vector<double> values;");
+    gen.println<generator::INCREASE_AFTER>("for (const sample &s : samples) "
+                                           "{{");
+    gen.println("values.push_back(s.*phase);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("std::sort(values.begin(), values.end());");
+    gen.println("return percentile(values, 50);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("struct options {{");
+    gen.println("std::string xclbin;");
+    gen.println("std::vector<std::string> routines;");
+    gen.println("std::uint64_t min = 1024;");
+    gen.println("std::uint64_t max = 1024;");
+    gen.println("// added to the size, or multiplied with it if geometric");
+    gen.println("std::uint64_t step = 2;");
+    gen.println("bool geometric = true;");
+    gen.println("unsigned warmup = 1;");
+    gen.println("unsigned repeat = 10;");
+    gen.println("std::string json;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("void usage(const char *name) {{");
+    gen.println("std::printf(\"Usage: %s <xclbin> [options]\\n\"");
+    gen.println("            \"  -r <routine>  benchmark only this routine, "
+                "can be repeated\\n\"");
+    gen.println("            \"  --min <size>  smallest problem size "
+                "(1024)\\n\"");
+    gen.println("            \"  --max <size>  largest problem size "
+                "(--min)\\n\"");
+    gen.println("            \"  --step <n>    add n to the size, or "
+                "multiply with it as xn (x2)\\n\"");
+    gen.println("            \"  --warmup <n>  untimed calls per size "
+                "(1)\\n\"");
+    gen.println("            \"  --repeat <n>  timed calls per size (10)\\n\"");
+    gen.println("            \"  --json <file> append the results to a "
+                "JSON lines file\\n\", name);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("options parse_args(int argc, "
+                                           "char *argv[]) {{");
+    gen.println("options opts;");
+    gen.println("bool max_set = false;");
+    gen.println<generator::INCREASE_AFTER>("for (int i = 1; i < argc; ++i) "
+                                           "{{");
+    gen.println("const std::string arg = argv[i];");
+    gen.println<generator::INCREASE_AFTER>("if (arg == \"-h\" || arg == "
+                                           "\"--help\") {{");
+    gen.println("usage(argv[0]);");
+    gen.println("std::exit(0);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg[0] != '-') {{");
+    gen.indent_incr();
+    gen.println("opts.xclbin = arg;");
+    gen.println("continue;");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (i + 1 == argc) {{");
+    gen.indent_incr();
+    gen.println("std::fprintf(stderr, \"Missing value of %s\\n\", "
+                "arg.c_str());");
+    gen.println("std::exit(1);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("const std::string value = argv[++i];");
+    gen.println<generator::INCREASE_AFTER>("if (arg == \"-r\") {{");
+    gen.println("opts.routines.push_back(value);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg == \"--min\") {{");
+    gen.indent_incr();
+    gen.println("opts.min = std::stoull(value);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg == \"--max\") {{");
+    gen.indent_incr();
+    gen.println("opts.max = std::stoull(value);");
+    gen.println("max_set = true;");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg == \"--step\") "
+                                            "{{");
+    gen.indent_incr();
+    gen.println("opts.geometric = value[0] == 'x';");
+    gen.println("opts.step = std::stoull(opts.geometric ? value.substr(1) : "
+                "value);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg == "
+                                            "\"--warmup\") {{");
+    gen.indent_incr();
+    gen.println("opts.warmup = std::stoul(value);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg == "
+                                            "\"--repeat\") {{");
+    gen.indent_incr();
+    gen.println("opts.repeat = std::stoul(value);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (arg == "
+                                            "\"--json\") {{");
+    gen.indent_incr();
+    gen.println("opts.json = value;");
+    gen.println<generator::DECREASE_BEFORE>("}} else {{");
+    gen.indent_incr();
+    gen.println("std::fprintf(stderr, \"Unknown option %s\\n\", "
+                "arg.c_str());");
+    gen.println("std::exit(1);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("if (opts.xclbin.empty() || "
+                                           "opts.repeat == 0 || opts.min == 0 "
+                                           "||");
+    gen.println<generator::DECREASE_BEFORE>("    (opts.geometric ? opts.step < "
+                                            "2 : opts.step == 0)) {{");
+    gen.indent_incr();
+    gen.println("usage(argv[0]);");
+    gen.println("std::exit(1);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::INCREASE_AFTER>("if (!max_set) {{");
+    gen.println("opts.max = opts.min;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return opts;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+/*
+ * Generate the writer of the results of the benchmark driver, one JSON object
+ * per line in the format of benchmark/util/include/write_results.hpp, so the
+ * aiesim tools read both. The design is the JSON file the driver was
+ * generated from, with its hash at generation time.
+ */
+static void gen_bench_json(generator &gen) {
+    const fs::path design = fs::absolute(gen.get_json_path());
+    const std::optional<std::uint64_t> hash = fnv1a_file(design);
+    gen.println("const char *const design_file = \"{}\";", design.native());
+    gen.println("const char *const design_hash = \"{}\";",
+                hash ? fnv1a_hex(*hash) : "");
+    gen.println();
+    gen.println("// First line of the output of a command, empty if it "
+                "fails");
+    gen.println<generator::INCREASE_AFTER>("std::string run_command(const "
+                                           "std::string &command) {{");
+    gen.println("FILE *pipe = popen(command.c_str(), \"r\");");
+    gen.println<generator::INCREASE_AFTER>("if (!pipe) {{");
+    gen.println("return \"\";");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("std::string output;");
+    gen.println("char buffer[256];");
+    gen.println<generator::INCREASE_AFTER>("while (std::fgets(buffer, "
+                                           "sizeof(buffer), pipe)) {{");
+    gen.println("output += buffer;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::INCREASE_AFTER>("if (pclose(pipe) != 0) {{");
+    gen.println("return \"\";");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return output.substr(0, output.find('\\n'));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("std::string json_string(const "
+                                           "std::string &value) {{");
+    gen.println("std::string escaped = \"\\\"\";");
+    gen.println<generator::INCREASE_AFTER>("for (char c : value) {{");
+    gen.println<generator::INCREASE_AFTER>("if (c == '\"' || c == '\\\\') "
+                                           "{{");
+    gen.println("escaped += '\\\\';");
+    gen.println("escaped += c;");
+    gen.println<generator::DECREASE_BEFORE>("}} else if (static_cast<"
+                                            "unsigned char>(c) < 0x20) {{");
+    gen.indent_incr();
+    gen.println("char code[8];");
+    gen.println("std::snprintf(code, sizeof(code), \"\\\\u%04x\", c);");
+    gen.println("escaped += code;");
+    gen.println<generator::DECREASE_BEFORE>("}} else {{");
+    gen.indent_incr();
+    gen.println("escaped += c;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return escaped + \"\\\"\";");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Shortest representation, null if not finite");
+    gen.println<generator::INCREASE_AFTER>("std::string json_number(double "
+                                           "value) {{");
+    gen.println<generator::INCREASE_AFTER>("if (!std::isfinite(value)) {{");
+    gen.println("return \"null\";");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("char text[32];");
+    gen.println("const std::to_chars_result end = std::to_chars(text, "
+                "text + sizeof(text), value);");
+    gen.println("return std::string(text, end.ptr);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Append the times in ms of the calls of r for size to "
+                "file, and the");
+    gen.println("// median time of every host-side phase");
+    gen.println("void write_json(const std::string &file, const routine &r, "
+                "std::uint64_t size,");
+    gen.println<generator::INCREASE_AFTER>("                const "
+                                           "std::vector<sample> &samples) {{");
+    gen.println("std::vector<double> times;");
+    gen.println<generator::INCREASE_AFTER>("for (const sample &s : samples) "
+                                           "{{");
+    gen.println("times.push_back(s.total());");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("const std::uint64_t bytes = samples.front().bytes;");
+    gen.println("std::vector<double> sorted = times;");
+    gen.println("std::sort(sorted.begin(), sorted.end());");
+    gen.println("const std::size_t mid = sorted.size() / 2;");
+    gen.println("const double median_ms = sorted.size() % 2 ? sorted[mid]");
+    gen.println("    : (sorted[mid - 1] + sorted[mid]) / 2;");
+    gen.println("double mean = 0;");
+    gen.println<generator::INCREASE_AFTER>("for (double time : sorted) {{");
+    gen.println("mean += time / sorted.size();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("double variance = 0;");
+    gen.println<generator::INCREASE_AFTER>("for (double time : sorted) {{");
+    gen.println("variance += (time - mean) * (time - mean) / sorted.size();");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("// bytes per ns is GB/s");
+    gen.println("const double gbps = median_ms > 0 ? bytes / "
+                "(median_ms * 1e6) : 0;");
+    gen.println();
+    gen.println("// The host and checkout do not change while the driver "
+                "runs");
+    gen.println<generator::INCREASE_AFTER>("static const std::string "
+                                           "hostname = [] {{");
+    gen.println("char name[256] = \"\";");
+    gen.println("gethostname(name, sizeof(name) - 1);");
+    gen.println("return std::string(name);");
+    gen.println<generator::DECREASE_BEFORE>("}}();");
+    gen.println<generator::NO_INDENT>("#if defined(__GNUC__) && "
+                                      "!defined(__clang__)");
+    gen.println("static const std::string compiler = \"GCC \" __VERSION__;");
+    gen.println<generator::NO_INDENT>("#elif defined(__VERSION__)");
+    gen.println("static const std::string compiler = __VERSION__;");
+    gen.println<generator::NO_INDENT>("#else");
+    gen.println("static const std::string compiler = \"\";");
+    gen.println<generator::NO_INDENT>("#endif");
+    gen.println<generator::NO_INDENT>("#if __has_include(<xrt/mock.h>)");
+    gen.println("static const std::string backend = \"mock\";");
+    gen.println<generator::NO_INDENT>("#else");
+    gen.println("static const std::string backend = \"xrt\";");
+    gen.println<generator::NO_INDENT>("#endif");
+    gen.println("static const std::string git = \"git -C '\" +");
+    gen.println("    std::filesystem::path(design_file).parent_path()."
+                "string() + \"' \";");
+    gen.println("static const std::string commit = run_command(git + "
+                "\"rev-parse HEAD \"");
+    gen.println("                                              "
+                "\"2>/dev/null\");");
+    gen.println("static const bool dirty = !run_command(git + \"status "
+                "--porcelain \"");
+    gen.println("                                       \"--untracked-files="
+                "no 2>/dev/null\").empty();");
+    gen.println();
+    gen.println("char timestamp[32];");
+    gen.println("const std::time_t now = std::time(nullptr);");
+    gen.println("std::strftime(timestamp, sizeof(timestamp), "
+                "\"%Y-%m-%dT%H:%M:%SZ\",");
+    gen.println("              std::gmtime(&now));");
+    gen.println();
+    gen.println("std::ofstream out{{file, std::ios::app}};");
+    gen.println("out << \"{{\\\"timestamp\\\":\" << json_string(timestamp)");
+    gen.println("    << \",\\\"routine\\\":\" << json_string(r.name)");
+    gen.println("    << \",\\\"design\\\":{{\\\"file\\\":\" << "
+                "json_string(design_file)");
+    gen.println("    << \",\\\"hash\\\":\" << json_string(design_hash)");
+    gen.println("    << \"}},\\\"dtype\\\":\" << json_string(r.dtype)");
+    gen.println("    << \",\\\"vsize\\\":\" << r.vsize << \",\\\"wsize\\\":\" "
+                "<< r.wsize");
+    gen.println("    << \",\\\"n\\\":\" << size << \",\\\"m\\\":\" << "
+                "(r.matrix ? size : 0)");
+    gen.println("    << \",\\\"repetitions\\\":\" << times.size() << "
+                "\",\\\"times_ms\\\":[\";");
+    gen.println<generator::INCREASE_AFTER>("for (std::size_t i = 0; "
+                                           "i < times.size(); ++i) {{");
+    gen.println("out << (i ? \",\" : \"\") << json_number(times[i]);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("out << \"],\\\"stats_ms\\\":{{\\\"min\\\":\" << "
+                "json_number(sorted.front())");
+    gen.println("    << \",\\\"median\\\":\" << json_number(median_ms)");
+    gen.println("    << \",\\\"mean\\\":\" << json_number(mean)");
+    gen.println("    << \",\\\"max\\\":\" << json_number(sorted.back())");
+    gen.println("    << \",\\\"stddev\\\":\" << "
+                "json_number(std::sqrt(variance))");
+    gen.println("    << \",\\\"p90\\\":\" << "
+                "json_number(percentile(sorted, 90))");
+    gen.println("    << \",\\\"p99\\\":\" << "
+                "json_number(percentile(sorted, 99))");
+    gen.println("    << \"}},\\\"breakdown_ms\\\":{{\\\"alloc\\\":\" <<");
+    gen.println("    json_number(median(samples, &sample::alloc))");
+    gen.println("    << \",\\\"sync_in\\\":\" << "
+                "json_number(median(samples, &sample::sync_in))");
+    gen.println("    << \",\\\"run\\\":\" << "
+                "json_number(median(samples, &sample::run))");
+    gen.println("    << \",\\\"sync_out\\\":\" << "
+                "json_number(median(samples, &sample::sync_out))");
+    gen.println("    << \"}},\\\"bytes\\\":\" << bytes");
+    gen.println("    << \",\\\"bandwidth_gbps\\\":\" << json_number(gbps)");
+    gen.println("    << \",\\\"host\\\":{{\\\"name\\\":\" << "
+                "json_string(hostname)");
+    gen.println("    << \",\\\"compiler\\\":\" << json_string(compiler)");
+    gen.println("    << \",\\\"backend\\\":\" << json_string(backend)");
+    gen.println("    << \"}},\\\"git\\\":{{\\\"commit\\\":\" << "
+                "json_string(commit)");
+    gen.println("    << \",\\\"dirty\\\":\" << (dirty ? \"true\" : "
+                "\"false\") << \"}}}}\\n\";");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+/*
+ * Generate a benchmark driver for all routines of the design, a routine being
+ * a group of connected kernels. For every problem size in a range it runs a
+ * routine a number of untimed warmup and timed calls, and reports percentiles
+ * of the call time, throughput, and the median time of every host phase. It
+ * uses the host library only, so it runs against XRT or the mock backend.
+ */
+static void gen_host_bench(generator &gen) {
+    gen.println("#include <algorithm>");
+    gen.println("#include <charconv>");
+    gen.println("#include <chrono>");
+    gen.println("#include <cmath>");
+    gen.println("#include <cstdint>");
+    gen.println("#include <cstdio>");
+    gen.println("#include <cstdlib>");
+    gen.println("#include <ctime>");
+    gen.println("#include <filesystem>");
+    gen.println("#include <fstream>");
+    gen.println("#include <stdexcept>");
+    gen.println("#include <string>");
+    gen.println("#include <vector>");
+    gen.println("#include <unistd.h>");
+    gen.println();
+    gen.println("#include \"aieblas.hpp\"");
+    gen.println();
+    gen.println("// Benchmark driver of the routines of the design");
+    gen.println("namespace {{");
+    gen.println();
+    gen_bench_helpers(gen);
+    gen.println();
+
+    // Routines as (name, function, first kernel, uses a matrix)
+    std::vector<std::tuple<std::string, std::string, const kernel *, bool>>
+        routines;
+    for (const std::vector<const kernel *> &group : mock_groups(gen)) {
+        bool moved = gen.get_data().movers.merge;
+        bool matrix = false;
+        std::string name;
+        for (const kernel *kernel : group) {
+            moved = moved || !get_pl_kernels(gen, *kernel).empty();
+            name.append(name.empty() ? kernel->user_name :
+                        "+" + kernel->user_name);
+            for (const kernel_arg &arg : get_kernel_args(kernel->operation)) {
+                matrix = matrix || arg.dimensions == 2;
+            }
+        }
+        if (!moved) {
+            continue;
+        }
+        const std::string function = std::format("routine_{}",
+                                                 routines.size());
+        gen.println("// {}", name);
+        gen_bench_routine(gen, group, name, function);
+        gen.println();
+        routines.emplace_back(name, function, group.front(), matrix);
+    }
+
+    gen.println("// The type and sizes are those of the first kernel, the "
+                "size of a matrix");
+    gen.println("// is problem size by problem size");
+    gen.println<generator::INCREASE_AFTER>("struct routine {{");
+    gen.println("const char *name;");
+    gen.println("sample (*call)(aieblas::design &, std::uint64_t);");
+    gen.println("const char *dtype;");
+    gen.println("unsigned vsize;");
+    gen.println("unsigned wsize;");
+    gen.println("bool matrix;");
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("const routine routines[] = {{");
+    for (const auto &[name, function, first, matrix] : routines) {
+        gen.println("{{\"{}\", {}, \"{}\", {}, {}, {}}},", name, function,
+                    datatype_to_str(first->type), first->vsize, first->wsize,
+                    matrix);
+    }
+    gen.println<generator::DECREASE_BEFORE>("}};");
+    gen.println();
+    gen_bench_json(gen);
+    gen.println();
+    gen.println("}} // anonymous namespace");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("int main(int argc, char *argv[]) "
+                                           "{{");
+    gen.println("const options opts = parse_args(argc, argv);");
+    gen.println("xrt::device device{{0}};");
+    gen.println("const xrt::uuid uuid = device.load_xclbin(opts.xclbin);");
+    gen.println("aieblas::design d{{device, uuid}};");
+    gen.println<generator::INCREASE_AFTER>("for (const std::string &name : "
+                                           "opts.routines) {{");
+    gen.println<generator::INCREASE_AFTER>("if (std::none_of(std::begin("
+                                           "routines), std::end(routines),");
+    gen.println<generator::DECREASE_BEFORE>("        [&name](const routine &r) "
+                                            "{{ return r.name == name; }})) "
+                                            "{{");
+    gen.indent_incr();
+    gen.println("std::fprintf(stderr, \"Unknown routine %s\\n\", "
+                "name.c_str());");
+    gen.println("return 1;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("std::printf(\"%-16s %12s %10s %10s %10s %10s %12s %8s %8s \"");
+    gen.println("            \"%10s %10s %10s %10s\\n\", \"routine\", "
+                "\"size\", \"min(ms)\",");
+    gen.println("            \"median(ms)\", \"p90(ms)\", \"p99(ms)\", "
+                "\"elem/s\", \"GB/s\",");
+    gen.println("            \"GFLOP/s\", \"alloc(ms)\", \"in(ms)\", "
+                "\"run(ms)\", \"out(ms)\");");
+    gen.println<generator::INCREASE_AFTER>("for (const routine &r : "
+                                           "routines) {{");
+    gen.println<generator::INCREASE_AFTER>("if (!opts.routines.empty() &&");
+    gen.println("    std::find(opts.routines.begin(), opts.routines.end(),");
+    gen.println<generator::DECREASE_BEFORE>("              r.name) == "
+                                            "opts.routines.end()) {{");
+    gen.indent_incr();
+    gen.println("continue;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::INCREASE_AFTER>("for (std::uint64_t size = "
+                                           "opts.min; size <= opts.max;");
+    gen.println<generator::DECREASE_BEFORE>("     size = opts.geometric ? "
+                                            "size * opts.step : size + "
+                                            "opts.step) {{");
+    gen.indent_incr();
+    gen.println<generator::INCREASE_AFTER>("for (unsigned i = 0; "
+                                           "i < opts.warmup; ++i) {{");
+    gen.println("r.call(d, size);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("std::vector<sample> samples;");
+    gen.println("std::vector<double> totals;");
+    gen.println<generator::INCREASE_AFTER>("for (unsigned i = 0; "
+                                           "i < opts.repeat; ++i) {{");
+    gen.println("samples.push_back(r.call(d, size));");
+    gen.println("totals.push_back(samples.back().total());");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::INCREASE_AFTER>("if (!opts.json.empty()) {{");
+    gen.println("write_json(opts.json, r, size, samples);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("std::sort(totals.begin(), totals.end());");
+    gen.println();
+    gen.println("// Throughput at the median call time");
+    gen.println("const sample &work = samples.front();");
+    gen.println("const double median_s = percentile(totals, 50) / 1e3;");
+    gen.println("const double elements = work.elements / median_s;");
+    gen.println("const double gbps = work.bytes / median_s / 1e9;");
+    gen.println("const double gflops = work.ops / median_s / 1e9;");
+    gen.println("std::printf(\"%-16s %12llu %10.3f %10.3f %10.3f %10.3f "
+                "%12.4g %8.3f %8.3f \"");
+    gen.println("            \"%10.3f %10.3f %10.3f %10.3f\\n\", r.name,");
+    gen.println("            static_cast<unsigned long long>(size), "
+                "totals.front(),");
+    gen.println("            percentile(totals, 50), percentile(totals, 90),");
+    gen.println("            percentile(totals, 99), elements, gbps, gflops,");
+    gen.println("            median(samples, &sample::alloc),");
+    gen.println("            median(samples, &sample::sync_in),");
+    gen.println("            median(samples, &sample::run),");
+    gen.println("            median(samples, &sample::sync_out));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return 0;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+void generator::generate_host() {
+    fs::path host_dir = out_dir / "host";
+    util::create_dir(host_dir);
+
+    this->open(host_dir / "bo_pool.hpp");
+    gen_host_pool(*this);
+    this->close();
+
+    this->open(host_dir / "queue.hpp");
+    gen_host_queue(*this);
+    this->close();
+
+    this->open(host_dir / "aieblas.hpp");
+    gen_host_header(*this);
+    this->close();
+
+    this->open(host_dir / "aieblas.cpp");
+    gen_host_source(*this);
+    this->close();
+
+    this->open(host_dir / "mock.cpp");
+    gen_host_mock(*this);
+    this->close();
+
+    this->open(host_dir / "bench.cpp");
+    gen_host_bench(*this);
+    this->close();
+}
+
+} // codegen
+} // aieblas
@@ -36,6 +36,85 @@ void generator::parse_json(fs::path json_file) {
         this->d.profile = false;
     }
 
+    if (json_data.count("persistent")) {
+        if (!json_data["persistent"].is_boolean()) {
+            throw parse_error("persistent should be a boolean.");
+        }
+        this->d.persistent = json_data["persistent"].get<bool>();
+    } else {
+        this->d.persistent = false;
+    }
+
+    if (json_data.count("rtp")) {
+        if (!json_data["rtp"].is_boolean()) {
+            throw parse_error("rtp should be a boolean.");
+        }
+        this->d.rtp = json_data["rtp"].get<bool>();
+    } else {
+        this->d.rtp = false;
+    }
+
+    this->d.movers = {0, 64, 16, false, 4};
+    if (json_data.count("movers")) {
+        json &movers = json_data["movers"];
+        if (!movers.is_object()) {
+            throw parse_error("movers should be a dictionary.");
+        }
+
+        if (movers.count("mem_width")) {
+            if (!movers["mem_width"].is_number_unsigned()) {
+                throw parse_error("mem_width should be an unsigned integer.");
+            }
+            this->d.movers.mem_width = movers["mem_width"].get<unsigned>();
+            if (this->d.movers.mem_width != 0 &&
+                this->d.movers.mem_width != 128 &&
+                this->d.movers.mem_width != 256 &&
+                this->d.movers.mem_width != 512) {
+                throw parse_error("mem_width should be 0, 128, 256 or 512.");
+            }
+        }
+
+        if (movers.count("burst_length")) {
+            if (!movers["burst_length"].is_number_unsigned()) {
+                throw parse_error(
+                    "burst_length should be an unsigned integer.");
+            }
+            this->d.movers.burst_length =
+                    movers["burst_length"].get<unsigned>();
+            if (this->d.movers.burst_length == 0 ||
+                this->d.movers.burst_length > 256) {
+                throw parse_error("burst_length should be between 1 and 256.");
+            }
+        }
+
+        if (movers.count("outstanding")) {
+            if (!movers["outstanding"].is_number_unsigned()) {
+                throw parse_error("outstanding should be an unsigned integer.");
+            }
+            this->d.movers.outstanding = movers["outstanding"].get<unsigned>();
+            if (this->d.movers.outstanding == 0) {
+                throw parse_error("outstanding should be positive.");
+            }
+        }
+
+        if (movers.count("merge")) {
+            if (!movers["merge"].is_boolean()) {
+                throw parse_error("merge should be a boolean.");
+            }
+            this->d.movers.merge = movers["merge"].get<bool>();
+        }
+
+        if (movers.count("noc_ports")) {
+            if (!movers["noc_ports"].is_number_unsigned()) {
+                throw parse_error("noc_ports should be an unsigned integer.");
+            }
+            this->d.movers.noc_ports = movers["noc_ports"].get<unsigned>();
+            if (this->d.movers.noc_ports == 0) {
+                throw parse_error("noc_ports should be positive.");
+            }
+        }
+    }
+
     std::unordered_map<kernel_parameter, kernel_parameter> connections;
 
     if (json_data.count("connections")) {
@@ -120,6 +199,8 @@ void generator::parse_json(fs::path json_file) {
         bool tile_set;
         unsigned tile_x;
         unsigned tile_y;
+        unsigned replicas;
+        unsigned plio_width;
         std::unordered_map<std::string, connection> connections_map;
         std::unique_ptr<kernel_options> extra_options;
 
@@ -168,6 +249,18 @@ void generator::parse_json(fs::path json_file) {
                 std::format("type '{}' is unknown in kernel {}.", type_str, i));
         }
 
+        if (this->d.persistent && operation == blas_op::gemv) {
+            throw parse_error(std::format(
+                "persistent is not supported by '{}' in kernel {}.",
+                blas_op_str, i));
+        }
+        // Scalars are followed by the length of the job, which has to fit
+        if (this->d.persistent && datatype_to_bits(type) < 32) {
+            throw parse_error(std::format(
+                "persistent requires types of at least 32 bits, but kernel {} "
+                "has type '{}'.", i, type_str));
+        }
+
         vsize = 0;
         if (item.count("vector_size")) {
             if (!item["vector_size"].is_number_unsigned()) {
@@ -208,6 +301,51 @@ void generator::parse_json(fs::path json_file) {
             tile_y = 0;
         }
 
+        replicas = 1;
+        if (item.count("replicas")) {
+            if (!item["replicas"].is_number_unsigned()
+                || item["replicas"].get<unsigned>() == 0) {
+                throw parse_error(std::format(
+                    "replicas should be a positive integer in kernel {}.", i));
+            }
+
+            replicas = item["replicas"].get<unsigned>();
+            if (replicas > 1 && operation != blas_op::axpy &&
+                operation != blas_op::scal && operation != blas_op::rot) {
+                throw parse_error(std::format(
+                    "replicas is only supported for elementwise routines "
+                    "(axpy, scal, rot), not '{}' in kernel {}.", blas_op_str,
+                    i));
+            }
+        }
+
+        plio_width = 0;
+        if (item.count("plio_width")) {
+            if (!item["plio_width"].is_number_unsigned()) {
+                throw parse_error(std::format(
+                    "plio_width should be an unsigned integer in kernel {}.",
+                    i));
+            }
+
+            plio_width = item["plio_width"].get<unsigned>();
+            if (plio_width != 32 && plio_width != 64 && plio_width != 128) {
+                throw parse_error(std::format(
+                    "plio_width should be 32, 64 or 128 in kernel {}.", i));
+            } else if (plio_width < datatype_to_bits(type)) {
+                throw parse_error(std::format(
+                    "plio_width {} is smaller than type '{}' in kernel {}.",
+                    plio_width, type_str, i));
+            } else if (wsize == 0) {
+                throw parse_error(std::format(
+                    "plio_width {} requires a window_size in kernel {}.",
+                    plio_width, i));
+            } else if ((wsize * 8) % plio_width != 0) {
+                throw parse_error(std::format(
+                    "window_size {} is not a multiple of plio_width {} in "
+                    "kernel {}.", wsize, plio_width, i));
+            }
+        }
+
         if (item.count("extra")) {
             extra_options = get_kernel_options(operation, item["extra"]);
         } else {
@@ -230,7 +368,13 @@ void generator::parse_json(fs::path json_file) {
                     [&param](auto &&p) { return p.second == param; });
 
                 if (it == std::end(connections)) {
-                    conn.type = connection_type::host;
+                    // Scalars from the host may be runtime parameters
+                    if (this->d.rtp && arg.dimensions == 0 &&
+                        arg.type == karg_type::input) {
+                        conn.type = connection_type::rtp;
+                    } else {
+                        conn.type = connection_type::host;
+                    }
                 } else {
                     conn.type = connection_type::kernel;
                     conn.kernel = it->first.kernel;
@@ -250,11 +394,27 @@ void generator::parse_json(fs::path json_file) {
                 throw parse_error("Unsupported karg_type");
             }
 
+            if (replicas > 1 && conn.type == connection_type::kernel) {
+                throw parse_error(std::format(
+                    "replicated kernel {} can only be connected to the host, "
+                    "but {} is connected to kernel {}.", user_name, arg.name,
+                    conn.kernel));
+            }
+
+            if (this->d.persistent && arg.dimensions == 0 &&
+                arg.type == karg_type::input &&
+                conn.type == connection_type::kernel) {
+                throw parse_error(std::format(
+                    "scalar {} of kernel {} should be connected to the host "
+                    "in a persistent graph.", arg.name, user_name));
+            }
+
             connections_map[arg.name] = conn;
         }
 
         this->d.kernels.emplace_back(operation, std::move(user_name), type,
                                      vsize, wsize, tile_set, tile_x, tile_y,
+                                     replicas, plio_width,
                                      std::move(connections_map),
                                      std::move(extra_options));
     }
@@ -24,10 +24,6 @@ void generator::generate_kernel(const kernel &kernel,
 
 void generator::generate_kernels() {
     fs::path aie_dir = out_dir / "aie";
-    if (fs::exists(aie_dir)) {
-        log(log_level::verbose, "Removing existing aie directory");
-        fs::remove_all(aie_dir);
-    }
     util::create_dir(aie_dir);
 
     fs::path kernel_dir = aie_dir / "kernels";
@@ -45,6 +41,77 @@ void generator::generate_kernels() {
     }
 }
 
+std::string kernel_generator::scalar_param(const std::string &name,
+                                           const connection &conn) {
+    if (conn.type == connection_type::rtp) {
+        return std::format("{} {}", datatype_to_str(k.type), name);
+    }
+    return std::format("input_stream<{}> *__restrict {}",
+                       datatype_to_str(k.type), name);
+}
+
+void kernel_generator::gen_job_glob(generator &gen) {
+    if (gen.get_data().persistent) {
+        gen.println("uint64 chess_storage(%chess_alignof(v4int64)) job[4] = "
+                    "{{0, 0, 0, 0}};");
+    }
+}
+
+void kernel_generator::gen_scalar_latch(
+        generator &gen, const std::string &flag,
+        const std::string &flag_storage,
+        const std::vector<std::pair<std::string, std::string>> &scalars) {
+    if (!gen.get_data().persistent) {
+        gen.println("{} *{} = &{};", datatype_to_str(k.type), flag,
+                    flag_storage);
+        gen.println<generator::INCREASE_AFTER>("if (*{} == 0) {{", flag);
+        gen.println("*{} = 1;", flag);
+        for (const auto &[stream, store] : scalars) {
+            gen.println("*{} = readincr({});", store, stream);
+        }
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println();
+        return;
+    }
+
+    gen.println("uint64 *remaining = &job[0];");
+    gen.println<generator::INCREASE_AFTER>("if (*remaining == 0) {{");
+    gen.println("// Every scalar is followed by the invocations of the job");
+    if (k.type == dtype::float32) {
+        gen.println("union {{ float f; int32 i; }} header;");
+    }
+    for (const auto &[stream, store] : scalars) {
+        gen.println("*{} = readincr({});", store, stream);
+        if (k.type == dtype::float32) {
+            gen.println("header.f = readincr({});", stream);
+        } else {
+            gen.println("*remaining = readincr({});", stream);
+        }
+    }
+    if (k.type == dtype::float32) {
+        gen.println("*remaining = header.i;");
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("*remaining -= 1;");
+    gen.println();
+}
+
+void kernel_generator::gen_job_reset(
+        generator &gen, const std::vector<std::string> &results,
+        unsigned vsize) {
+    if (!gen.get_data().persistent) {
+        return;
+    }
+    gen.println("*num_cycles = 0;");
+    gen.println("*cycle = 0;");
+    for (const std::string &result : results) {
+        gen.println("{} = {};", result,
+                    vsize == 0 ? "0" : std::format("aie::zeros<{}, {}>()",
+                                                   datatype_to_str(k.type),
+                                                   vsize));
+    }
+}
+
 void generate_kernel_src(generator &gen, kernel_generator &kernel_gen,
                          const kernel &kernel) {
     gen.println("#include \"{}.hpp\"", kernel.user_name);
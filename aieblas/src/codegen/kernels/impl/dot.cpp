@@ -37,7 +37,9 @@ void dot_generator::gen_kernel_body(generator &gen) {
     gen.println("uint64 *num_cycles = &counter[0];");
     gen.println("uint64 *cycle = &counter[1];");
     gen.println<generator::INCREASE_AFTER>("if (*num_cycles == 0) {{");
-    gen.println("*num_cycles = readincr(in_size_n) / NUM_SAMPLES;");
+    gen.println("// The movers pad the last window with zeros");
+    gen.println("*num_cycles = (readincr(in_size_n) + NUM_SAMPLES - 1) / "
+                "NUM_SAMPLES;");
     gen.println<generator::DECREASE_BEFORE>("}}");
     gen.println("{0} &result = *({0} *)result_storage;", dtype);
     const char *loop_cond;
@@ -73,6 +75,7 @@ void dot_generator::gen_kernel_body(generator &gen) {
     } else {
         gen.println("writeincr(out, aie::reduce_add(result), true);");
     }
+    gen_job_reset(gen, {"result"}, k.vsize);
     gen.println<generator::DECREASE_BEFORE>("}}");
 }
 
@@ -83,165 +86,42 @@ std::vector<kernel_arg> get_dot_args() {
                                    {karg_type::output, "out", 0}};
 }
 
-bool dot_generator::need_mm2s() const {
-    return true;
-}
-
-void dot_generator::gen_mm2s(generator &gen) {
-    unsigned bits = datatype_to_bits(k.type);
-
-    gen.print<generator::INCREASE_AFTER>("void {}_mm2s(", k.user_name);
-    if (x.type == connection_type::host) {
-        gen.print("ap_int<{0}> *mem_x, ", bits);
-    }
-    if (y.type == connection_type::host) {
-        gen.print("ap_int<{0}> *mem_y, ", bits);
-    }
-    gen.print("int size, ");
-    if (x.type == connection_type::host) {
-        gen.print("hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_x, ", bits);
-    }
-    if (y.type == connection_type::host) {
-        gen.print("hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_y, ", bits);
-    }
-    gen.print("hls::stream<qdma_axis<64, 0, 0, 0>> &stream_in_size_n");
-    gen.println(") {{");
+std::vector<pl_mover> dot_generator::get_pl_movers() {
+    const unsigned bits = datatype_to_bits(k.type);
+    std::vector<pl_mover> movers;
 
+    pl_mover mm2s{"mm2s"};
     if (x.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                          "port = mem_x offset = slave");
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                          "port = stream_x");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = mem_x bundle = control");
+        mm2s.add_arg(pl_arg_type::memory, "mem_x", bits);
+        mm2s.add_port(pl_port_type::mem_to_stream, "x", "mem_x", bits,
+                      "size", 1, job_block());
     }
     if (y.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                          "port = mem_y offset = slave");
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                          "port = stream_y");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = mem_y bundle = control");
-    }
-
-    gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                      "port = stream_in_size_n");
-    gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = size bundle = control");
-    gen.println<generator::NO_INDENT>("#pragma HLS interface s_axilite "
-                                      "port = return bundle = control");
-    gen.println();
-
-    gen.println("qdma_axis<64,0,0,0> in_size;");
-    gen.println("in_size.data = size;");
-    gen.println("in_size.keep_all();");
-    gen.println("in_size.set_last(1);");
-    gen.println("stream_in_size_n.write(in_size);");
-
-    gen.println("// Send data over stream");
-    gen.println<generator::INCREASE_AFTER>("for (int i = 0; i < size; i++) "
-                                            "{{");
-    gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
-
-    if (x.type == connection_type::host) {
-        gen.println("qdma_axis<{},0,0,0> x;", bits);
-        gen.println("x.data = mem_x[i];");
-        gen.println("x.keep_all();");
-        gen.println("stream_x.write(x);");
+        mm2s.add_arg(pl_arg_type::memory, "mem_y", bits);
+        mm2s.add_port(pl_port_type::mem_to_stream, "y", "mem_y", bits,
+                      "size", 1, job_block());
     }
+    mm2s.add_arg(pl_arg_type::size, "size");
+    mm2s.add_port(pl_port_type::size_to_stream, "in_size_n", "size", 64);
+    movers.push_back(std::move(mm2s));
 
-    if (y.type == connection_type::host) {
-        gen.println("qdma_axis<{},0,0,0> y;", bits);
-        gen.println("y.data = mem_y[i];");
-        gen.println("y.keep_all();");
-        gen.println("stream_y.write(y);");
+    if (out.type == connection_type::host) {
+        pl_mover s2mm{"s2mm"};
+        s2mm.add_arg(pl_arg_type::memory, "mem", bits);
+        s2mm.add_port(pl_port_type::stream_to_mem, "out", "mem", bits);
+        movers.push_back(std::move(s2mm));
     }
 
-    gen.println<generator::DECREASE_BEFORE>("}}");
-    gen.println<generator::DECREASE_BEFORE>("}}");
-}
-
-bool dot_generator::need_s2mm() const {
-    return out.type == connection_type::host;
+    return movers;
 }
 
-void dot_generator::gen_s2mm(generator &gen) {
-    unsigned bits = datatype_to_bits(k.type);
-
-    if (out.type != connection_type::host) {
-        throw std::runtime_error("Internal error: mm2s not needed");
-    }
-
-    gen.println<generator::INCREASE_AFTER>(
-        "void {0}_s2mm(ap_int<{1}> *mem,"
-        "hls::stream<qdma_axis<{1}, 0, 0, 0>> &stream_out) {{",
-        k.user_name, bits);
-
-    gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                      "port = mem offset = slave");
-    gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                      "port = stream_out");
-    gen.println();
-    gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                      "port = mem bundle = control");
-    gen.println<generator::NO_INDENT>("#pragma HLS interface s_axilite "
-                                      "port = return bundle = control");
-    gen.println();
-
-    gen.println("// Retrieve data from out stream");
-    gen.println("qdma_axis<{}, 0, 0, 0> x = stream_out.read();", bits);
-    gen.println("*mem = x.data;");
+void dot_generator::gen_mock(generator &gen) {
+    gen.println("{} result = 0;", datatype_to_host_type(k.type));
+    gen.println<generator::INCREASE_AFTER>("for (std::uint64_t i = 0; "
+                                           "i < size; ++i) {{");
+    gen.println("result += x[i] * y[i];");
     gen.println<generator::DECREASE_BEFORE>("}}");
-}
-
-std::vector<pl_kernel_generator> dot_generator::get_pl_generators() {
-    std::vector<pl_kernel_generator> generators;
-    if (need_mm2s()) {
-        generators.emplace_back("mm2s", [this](generator &gen) {
-                this->gen_mm2s(gen);
-            });
-    }
-
-    if (need_s2mm()) {
-        generators.emplace_back("s2mm", [this](generator &gen) {
-                this->gen_s2mm(gen);
-            });
-    }
-
-    return generators;
-}
-
-void dot_generator::gen_link(generator &gen) {
-    gen.println("nk={0}_mm2s:1:{0}_mm2s", k.user_name);
-    if (out.type == connection_type::host) {
-        gen.println("nk={0}_s2mm:1:{0}_s2mm", k.user_name);
-    }
-    gen.println();
-    gen.println("sc={0}_mm2s.stream_in_size_n:ai_engine_0.{0}_in_size_n",
-                k.user_name);
-    if (x.type == connection_type::host) {
-        gen.println("sc={0}_mm2s.stream_x:ai_engine_0.{0}_x", k.user_name);
-    }
-    if (y.type == connection_type::host) {
-        gen.println("sc={0}_mm2s.stream_y:ai_engine_0.{0}_y",
-                    k.user_name);
-    }
-    if (out.type == connection_type::host) {
-        gen.println("sc=ai_engine_0.{0}_out:{0}_s2mm.stream_out", k.user_name);
-    }
-    gen.println();
-    gen.println("slr={0}_mm2s:SLR0", k.user_name);
-    if (out.type == connection_type::host) {
-        gen.println("slr={0}_s2mm:SLR0", k.user_name);
-    }
-    gen.println();
-    if (x.type == connection_type::host ||
-        y.type == connection_type::host) {
-        gen.println("sp={0}_mm2s.m_axi_gmem:MC_NOC0", k.user_name);
-    }
-    if (out.type == connection_type::host) {
-        gen.println("sp={0}_s2mm.m_axi_gmem:MC_NOC0", k.user_name);
-    }
+    gen.println("out[0] = result;");
 }
 
 } // generators
@@ -9,7 +9,7 @@ namespace generators {
 void rot_generator::gen_kernel_glob(generator &gen) {
     const unsigned num_samples = k.wsize * 8 / datatype_to_bits(k.type);
     gen.println("#define NUM_SAMPLES {}", num_samples);
-    if (!options.c.set || !options.s.set) {
+    if (latched(c) || latched(s)) {
         gen.println();
         const auto native_type = datatype_to_native_type(k.type, 3);
         gen.print("{0} chess_storage(%chess_alignof({1})) rot_storage[{2}] = "
@@ -23,6 +23,7 @@ void rot_generator::gen_kernel_glob(generator &gen) {
             }
         }
         gen.println("}};");
+        gen_job_glob(gen);
     }
 }
 
@@ -34,33 +35,34 @@ void rot_generator::gen_kernel_args(generator &gen) {
               datatype_to_str(k.type));
 
     if (!options.c.set) {
-        gen.print(", input_stream<{0}> *__restrict c", datatype_to_str(k.type));
+        gen.print(", {}", scalar_param("c", c));
     }
 
     if (!options.s.set) {
-        gen.print(", input_stream<{0}> *__restrict s", datatype_to_str(k.type));
+        gen.print(", {}", scalar_param("s", s));
     }
 }
 
 void rot_generator::gen_kernel_body(generator &gen) {
-    if (!options.c.set) {
+    if (c.type == connection_type::rtp) {
+        gen.println("{0} *c_store = &c;", datatype_to_str(k.type));
+    } else if (!options.c.set) {
         gen.println("{0} *c_store = &rot_storage[0];", datatype_to_str(k.type));
     }
-    if (!options.s.set) {
-        gen.println("{0} *s_store = &rot_storage[0];", datatype_to_str(k.type));
+    if (s.type == connection_type::rtp) {
+        gen.println("{0} *s_store = &s;", datatype_to_str(k.type));
+    } else if (!options.s.set) {
+        gen.println("{0} *s_store = &rot_storage[1];", datatype_to_str(k.type));
     }
-    if (!options.c.set || !options.s.set) {
-        gen.println("{0} *rot_set = &rot_storage[1];", datatype_to_str(k.type));
-        gen.println<generator::INCREASE_AFTER>("if (*rot_set == 0) {{");
-        gen.println("*rot_set = 1;");
-        if (!options.c.set) {
-            gen.println("*c_store = readincr(c);");
+    if (latched(c) || latched(s)) {
+        std::vector<std::pair<std::string, std::string>> scalars;
+        if (latched(c)) {
+            scalars.emplace_back("c", "c_store");
         }
-        if (!options.s.set) {
-            gen.println("*s_store = readincr(s);");
+        if (latched(s)) {
+            scalars.emplace_back("s", "s_store");
         }
-        gen.println<generator::DECREASE_BEFORE>("}}");
-        gen.println();
+        gen_scalar_latch(gen, "rot_set", "rot_storage[2]", scalars);
     }
     gen.println("{0} vx, vy, vout_x, vout_y;", dtype);
     const char *loop_cond;
@@ -130,264 +132,66 @@ std::vector<kernel_arg> get_rot_args() {
                                    {karg_type::input, "s", 0}};
 }
 
-bool rot_generator::need_mm2s() const {
-    return x.type == connection_type::host
-        || y.type == connection_type::host
-        || c.type == connection_type::host
-        || s.type == connection_type::host;
-}
-
-void rot_generator::gen_mm2s(generator &gen) {
-    unsigned bits = datatype_to_bits(k.type);
-
-    if (x.type != connection_type::host &&
-        y.type != connection_type::host &&
-        c.type != connection_type::host &&
-        s.type != connection_type::host) {
-        throw std::runtime_error("Internal error: mm2s not needed");
-    }
-
-    gen.print<generator::INCREASE_AFTER>("void {}_mm2s(", k.user_name);
-    if (x.type == connection_type::host) {
-        gen.print("ap_int<{0}> *mem_x, ", bits);
-    }
-    if (y.type == connection_type::host) {
-        gen.print("ap_int<{0}> *mem_y, ", bits);
-    }
-    if (c.type == connection_type::host) {
-        gen.print("ap_int<{0}> scalar_c, ", bits);
-    }
-    if (s.type == connection_type::host) {
-        gen.print("ap_int<{0}> scalar_s, ", bits);
-    }
-    gen.print("int size");
-    if (x.type == connection_type::host) {
-        gen.print(", hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_x", bits);
-    }
-    if (y.type == connection_type::host) {
-        gen.print(", hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_y", bits);
-    }
-    if (c.type == connection_type::host) {
-        gen.print(", hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_c", bits);
-    }
-    if (s.type == connection_type::host) {
-        gen.print(", hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_s", bits);
-    }
-    gen.println(") {{");
+std::vector<pl_mover> rot_generator::get_pl_movers() {
+    const unsigned bits = datatype_to_bits(k.type);
+    std::vector<pl_mover> movers;
 
+    pl_mover mm2s{"mm2s"};
     if (x.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                          "port = mem_x offset = slave");
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                          "port = stream_x");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = mem_x bundle = control");
+        mm2s.add_arg(pl_arg_type::memory, "mem_x", bits);
+        mm2s.add_port(pl_port_type::mem_to_stream, "x", "mem_x", bits, "size",
+                      k.replicas, job_block());
     }
     if (y.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                          "port = mem_y offset = slave");
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                          "port = stream_y");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = mem_y bundle = control");
-    }
-    if (c.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                          "port = stream_c");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = scalar_c bundle = control");
+        mm2s.add_arg(pl_arg_type::memory, "mem_y", bits);
+        mm2s.add_port(pl_port_type::mem_to_stream, "y", "mem_y", bits, "size",
+                      k.replicas, job_block());
     }
-    if (s.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                          "port = stream_s");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = scalar_s bundle = control");
-    }
-
-    gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                          "port = size bundle = control");
-    gen.println<generator::NO_INDENT>("#pragma HLS interface s_axilite "
-                                      "port = return bundle = control");
-    gen.println();
-
-
     if (c.type == connection_type::host) {
-        gen.println("// Send scalar over c stream");
-        gen.println("qdma_axis<{},0,0,0> qdma_scalar_c;", bits);
-        gen.println("qdma_scalar_c.data = (ap_int<{}>) scalar_c;", bits);
-        gen.println("qdma_scalar_c.keep_all();");
-        gen.println("qdma_scalar_c.set_last(1);");
-        gen.println("stream_c.write(qdma_scalar_c);");
-        gen.println();
+        mm2s.add_arg(pl_arg_type::scalar, "scalar_c", bits);
+        mm2s.add_port(pl_port_type::scalar_to_stream, "c", "scalar_c", bits);
     }
-
     if (s.type == connection_type::host) {
-        gen.println("// Send scalar over c stream");
-        gen.println("qdma_axis<{},0,0,0> qdma_scalar_s;", bits);
-        gen.println("qdma_scalar_s.data = (ap_int<{}>) scalar_s;", bits);
-        gen.println("qdma_scalar_s.keep_all();");
-        gen.println("qdma_scalar_s.set_last(1);");
-        gen.println("stream_s.write(qdma_scalar_s);");
-        gen.println();
-    }
-
-    gen.println("// Send data over stream");
-    gen.println<generator::INCREASE_AFTER>("for (int i = 0; i < size; i++) "
-                                            "{{");
-    gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
-
-    if (x.type == connection_type::host) {
-        gen.println("qdma_axis<{},0,0,0> x;", bits);
-        gen.println("x.data = mem_x[i];");
-        gen.println("x.keep_all();");
-        gen.println("stream_x.write(x);");
-    }
-
-    if (y.type == connection_type::host) {
-        gen.println("qdma_axis<{},0,0,0> y;", bits);
-        gen.println("y.data = mem_y[i];");
-        gen.println("y.keep_all();");
-        gen.println("stream_y.write(y);");
-    }
-
-    gen.println<generator::DECREASE_BEFORE>("}}");
-    gen.println<generator::DECREASE_BEFORE>("}}");
-}
-
-bool rot_generator::need_s2mm() const {
-    return out_x.type == connection_type::host
-        || out_y.type == connection_type::host;
-}
-
-void rot_generator::gen_s2mm(generator &gen) {
-    unsigned bits = datatype_to_bits(k.type);
-
-    if (out_x.type != connection_type::host
-        && out_y.type != connection_type::host) {
-        throw std::runtime_error("Internal error: s2mm not needed");
-    }
-
-    gen.print<generator::INCREASE_AFTER>("void {}_s2mm(", k.user_name);
-    if (out_x.type == connection_type::host) {
-        gen.print("ap_int<{0}> *mem_out_x, ", bits);
-    }
-    if (out_y.type == connection_type::host) {
-        gen.print("ap_int<{0}> *mem_out_y, ", bits);
+        mm2s.add_arg(pl_arg_type::scalar, "scalar_s", bits);
+        mm2s.add_port(pl_port_type::scalar_to_stream, "s", "scalar_s", bits);
     }
-    gen.print("int size");
-    if (out_x.type == connection_type::host) {
-        gen.print(", hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_out_x", bits);
+    if (!mm2s.empty()) {
+        mm2s.add_arg(pl_arg_type::size, "size");
+        movers.push_back(std::move(mm2s));
     }
-    if (out_y.type == connection_type::host) {
-        gen.print(", hls::stream<qdma_axis<{0}, 0, 0, 0>> &stream_out_y", bits);
-    }
-    gen.println(") {{");
 
+    pl_mover s2mm{"s2mm"};
     if (out_x.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                        "port = mem_out_x offset = slave");
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                        "port = stream_out_x");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                        "port = mem_out_x bundle = control");
+        s2mm.add_arg(pl_arg_type::memory, "mem_out_x", bits);
+        s2mm.add_port(pl_port_type::stream_to_mem, "out_x", "mem_out_x", bits,
+                      "size", k.replicas, job_block());
     }
     if (out_y.type == connection_type::host) {
-        gen.println<generator::NO_INDENT>("#pragma HLS interface m_axi "
-                                        "port = mem_out_y offset = slave");
-        gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
-                                        "port = stream_out_y");
-        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                        "port = mem_out_y bundle = control");
-    }
-    gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
-                                      "port = size bundle = control");
-    gen.println();
-    gen.println<generator::NO_INDENT>("#pragma HLS interface s_axilite "
-                                      "port = return bundle = control");
-    gen.println();
-
-    gen.println("// Retrieve data from out stream");
-    gen.println<generator::INCREASE_AFTER>("for (int i = 0; i < size; i++) {{");
-    gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
-    if (out_x.type == connection_type::host) {
-        gen.println("qdma_axis<{},0,0,0> x = stream_out_x.read();", bits);
-        gen.println("mem_out_x[i] = x.data;");
-    }
-    if (out_y.type == connection_type::host) {
-        gen.println("qdma_axis<{},0,0,0> y = stream_out_y.read();", bits);
-        gen.println("mem_out_y[i] = y.data;");
-    }
-    gen.println<generator::DECREASE_BEFORE>("}}");
-    gen.println<generator::DECREASE_BEFORE>("}}");
-}
-
-std::vector<pl_kernel_generator> rot_generator::get_pl_generators() {
-    std::vector<pl_kernel_generator> generators;
-    if (need_mm2s()) {
-        generators.emplace_back("mm2s", [this](generator &gen) {
-                this->gen_mm2s(gen);
-            });
+        s2mm.add_arg(pl_arg_type::memory, "mem_out_y", bits);
+        s2mm.add_port(pl_port_type::stream_to_mem, "out_y", "mem_out_y", bits,
+                      "size", k.replicas, job_block());
     }
-
-    if (need_s2mm()) {
-        generators.emplace_back("s2mm", [this](generator &gen) {
-                this->gen_s2mm(gen);
-            });
+    if (!s2mm.empty()) {
+        s2mm.add_arg(pl_arg_type::size, "size");
+        movers.push_back(std::move(s2mm));
     }
 
-    return generators;
+    return movers;
 }
 
-void rot_generator::gen_link(generator &gen) {
-    if (x.type == connection_type::host ||
-        y.type == connection_type::host) {
-        gen.println("nk={0}_mm2s:1:{0}_mm2s", k.user_name);
-    }
-    if (out_x.type == connection_type::host ||
-        out_y.type == connection_type::host) {
-        gen.println("nk={0}_s2mm:1:{0}_s2mm", k.user_name);
-    }
-    gen.println();
-    if (x.type == connection_type::host) {
-        gen.println("sc={0}_mm2s.stream_x:ai_engine_0.{0}_x", k.user_name);
-    }
-    if (y.type == connection_type::host) {
-        gen.println("sc={0}_mm2s.stream_y:ai_engine_0.{0}_y",
-                    k.user_name);
+void rot_generator::gen_mock(generator &gen) {
+    const char *type = datatype_to_host_type(k.type);
+    if (options.c.set) {
+        gen.println("const {} c = {};", type, options.c.to_string());
     }
-    if (c.type == connection_type::host) {
-        gen.println("sc={0}_mm2s.stream_c:ai_engine_0.{0}_c", k.user_name);
-    }
-    if (s.type == connection_type::host) {
-        gen.println("sc={0}_mm2s.stream_s:ai_engine_0.{0}_s",
-                    k.user_name);
-    }
-    if (out_x.type == connection_type::host) {
-        gen.println("sc=ai_engine_0.{0}_out_x:{0}_s2mm.stream_out_x",
-                    k.user_name);
-    }
-    if (out_y.type == connection_type::host) {
-        gen.println("sc=ai_engine_0.{0}_out_y:{0}_s2mm.stream_out_y",
-                    k.user_name);
-    }
-    gen.println();
-    if (x.type == connection_type::host ||
-        y.type == connection_type::host) {
-        gen.println("slr={0}_mm2s:SLR0", k.user_name);
-    }
-    if (out_x.type == connection_type::host ||
-        out_y.type == connection_type::host) {
-        gen.println("slr={0}_s2mm:SLR0", k.user_name);
-    }
-    gen.println();
-    if (x.type == connection_type::host ||
-        y.type == connection_type::host) {
-        gen.println("sp={0}_mm2s.m_axi_gmem:MC_NOC0", k.user_name);
-    }
-    if (out_x.type == connection_type::host ||
-        out_y.type == connection_type::host) {
-        gen.println("sp={0}_s2mm.m_axi_gmem:MC_NOC0", k.user_name);
+    if (options.s.set) {
+        gen.println("const {} s = {};", type, options.s.to_string());
     }
+    gen.println<generator::INCREASE_AFTER>("for (std::uint64_t i = 0; "
+                                           "i < size; ++i) {{");
+    gen.println("out_x[i] = c * x[i] + s * y[i];");
+    gen.println("out_y[i] = c * y[i] - s * x[i];");
+    gen.println<generator::DECREASE_BEFORE>("}}");
 }
 
 } // generators
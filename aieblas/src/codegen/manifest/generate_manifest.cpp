@@ -0,0 +1,90 @@
+#include <ctime>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <set>
+
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/codegen/generator.hpp"
+
+using json = nlohmann::json;
+
+namespace aieblas {
+namespace codegen {
+
+// A relative path without .. components, which stays inside the directory
+static bool inside_output(const fs::path &file) {
+    if (file.empty() || file.has_root_name() || file.has_root_directory()) {
+        return false;
+    }
+    for (const fs::path &part : file) {
+        if (part == "..") {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * The manifest lists every generated file with the hash of its content, and
+ * records when and from which design the files were generated. Files listed
+ * by the manifest of a previous run that were not generated again (e.g. of a
+ * removed kernel) are deleted, other files in the output are left alone.
+ */
+void generator::generate_manifest() {
+    fs::path manifest_file = out_dir / "manifest.json";
+
+    std::set<std::string> generated;
+    json files = json::object();
+    for (const emitted_file &file : this->emitted) {
+        const std::string name =
+            fs::relative(file.path, out_dir).generic_string();
+        generated.insert(name);
+        files[name] = std::format("{:016x}", file.hash);
+    }
+
+    std::ifstream previous_file{manifest_file};
+    if (previous_file) {
+        json previous = json::parse(previous_file, nullptr, false);
+        if (previous.is_object() && previous.contains("files") &&
+            previous["files"].is_object()) {
+            for (const auto &[name, hash] : previous["files"].items()) {
+                if (generated.contains(name)) {
+                    continue;
+                }
+                // An edited manifest must not remove files outside the output
+                if (!inside_output(name)) {
+                    log(log_level::warning, "Not removing '{}' listed in the "
+                        "manifest, it is outside the output directory", name);
+                    continue;
+                }
+                log(log_level::verbose, "Removing stale file '{}'", name);
+                fs::remove(out_dir / name);
+            }
+        } else {
+            log(log_level::warning, "Ignoring invalid manifest '{}'",
+                manifest_file.native());
+        }
+    }
+    previous_file.close();
+
+    std::time_t now = std::time(nullptr);
+    char time[32];
+    std::strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S",
+                  std::localtime(&now));
+
+    std::size_t changed = 0;
+    for (const emitted_file &file : this->emitted) {
+        changed += file.changed;
+    }
+    log("Generated {} files, {} changed", this->emitted.size(), changed);
+
+    json manifest = {
+        {"generated", time},
+        {"design", fs::absolute(json_path).generic_string()},
+        {"files", files}
+    };
+    std::ofstream{manifest_file} << manifest.dump(4) << "\n";
+}
+
+} // codegen
+} // aieblas
@@ -19,12 +19,17 @@ static inline void generate_pl_kernel(generator &gen,
 
 void generator::generate_pl_kernels() {
     fs::path pl_dir = out_dir / "pl_kernels";
-    if (fs::exists(pl_dir)) {
-        log(log_level::verbose, "Removing existing pl directory");
-        fs::remove_all(pl_dir);
-    }
     util::create_dir(pl_dir);
 
+    if (d.movers.merge) {
+        fs::path pl = pl_dir / std::format("{}.cpp", merged_mover_name);
+        this->open(pl);
+        generate_pl_kernel(*this, gen_pl_merged_mover);
+        this->close();
+        this->pl_kernels.push_back(pl);
+        return;
+    }
+
     for (const kernel &kernel : d.kernels)  {
         std::unique_ptr<kernel_generator> kernel_gen = get_kernel_generator(kernel);
         for (pl_kernel_generator &pl_gen : kernel_gen->get_pl_generators()) {
@@ -0,0 +1,1066 @@
+#include <algorithm>
+#include <tuple>
+#include <unordered_set>
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/codegen/generator.hpp"
+#include "aieblas/detail/codegen/kernels.hpp"
+#include "aieblas/detail/codegen/pl_kernels.hpp"
+
+namespace aieblas {
+namespace codegen {
+static inline std::string stream_name(const pl_port &port, unsigned replica) {
+    return replica_name(std::format("stream_{}", port.arg), port.replicas,
+                        replica);
+}
+
+static inline std::string mem_index(const pl_port &port, unsigned replica) {
+    if (port.length == "1") {
+        return "0";
+    } else if (port.replicas <= 1) {
+        return "i";
+    }
+    return std::format("i * {} + {}", port.replicas, replica);
+}
+
+static inline std::string join(const std::vector<std::string> &items) {
+    std::string joined;
+    for (const std::string &item : items) {
+        joined.append(joined.empty() ? item : std::format(", {}", item));
+    }
+    return joined;
+}
+
+// Width in bits of a single beat on the stream of port.
+static inline unsigned beat_bits(const kernel &kernel, const pl_port &port) {
+    return port.bits * elements_per_beat(kernel, port);
+}
+
+// Number of elements moved over all replicas of port on every iteration.
+static inline unsigned beat_stride(const kernel &kernel, const pl_port &port) {
+    return elements_per_beat(kernel, port) * port.replicas;
+}
+
+// Number of beats holding the elements of port, the last may be partial.
+static inline std::string valid_beats(const kernel &kernel,
+                                      const pl_port &port) {
+    const unsigned per_beat = elements_per_beat(kernel, port);
+    if (per_beat == 1) {
+        return port.length;
+    }
+    return std::format("(({}) + {}) / {}", port.length, per_beat - 1,
+                       per_beat);
+}
+
+// Clear the elements of beat var past the length of port, only the last beat
+// of a packed port can be partial.
+static inline void gen_tail_mask(generator &gen, const kernel &kernel,
+                                 const pl_port &port, const std::string &var,
+                                 const std::string &index) {
+    const unsigned per_beat = elements_per_beat(kernel, port);
+    if (per_beat == 1) {
+        return;
+    }
+    gen.println<generator::INCREASE_AFTER>("for (int e = 0; e < {}; e++) {{",
+                                           per_beat);
+    gen.println<generator::NO_INDENT>("#pragma HLS unroll");
+    gen.println<generator::INCREASE_AFTER>("if (({}) * {} + e >= ({})) {{",
+                                           index, per_beat, port.length);
+    gen.println("{}.data.range(e * {} + {}, e * {}) = 0;", var, port.bits,
+                port.bits - 1, port.bits);
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+// Wide ports access memory in mem_width bit words through a FIFO instead of
+// one beat at a time.
+static inline bool is_wide(generator &gen, const pl_port &port) {
+    return gen.get_data().movers.mem_width != 0 && port.length != "1" &&
+           (port.type == pl_port_type::mem_to_stream ||
+            port.type == pl_port_type::stream_to_mem);
+}
+
+static inline bool has_wide_port(generator &gen, const pl_mover &mover) {
+    return std::any_of(mover.ports.begin(), mover.ports.end(),
+        [&gen](const pl_port &port) { return is_wide(gen, port); });
+}
+
+// Data ports move vectors between memory and a stream.
+static inline bool is_data_port(const pl_port &port) {
+    return port.length != "1" &&
+           (port.type == pl_port_type::mem_to_stream ||
+            port.type == pl_port_type::stream_to_mem);
+}
+
+// Data ports run concurrently in a dataflow region if there is more than one,
+// or when they need a FIFO for wide memory accesses.
+static inline bool uses_dataflow(generator &gen, const pl_mover &mover) {
+    return has_wide_port(gen, mover) ||
+           std::count_if(mover.ports.begin(), mover.ports.end(),
+                         is_data_port) > 1;
+}
+
+static inline bool in_dataflow(generator &gen, const pl_mover &mover,
+                               const pl_port &port) {
+    return is_data_port(port) && uses_dataflow(gen, mover);
+}
+
+static inline unsigned count_memory_args(const pl_mover &mover) {
+    return std::count_if(mover.args.begin(), mover.args.end(),
+        [](const pl_arg &arg) { return arg.type == pl_arg_type::memory; });
+}
+
+static inline const pl_arg &find_arg(const pl_mover &mover,
+                                     const std::string &name) {
+    for (const pl_arg &arg : mover.args) {
+        if (arg.name == name) {
+            return arg;
+        }
+    }
+    throw std::runtime_error(
+        std::format("Internal error: mover {} has no argument {}", mover.name,
+                    name));
+}
+
+static inline const pl_port *find_port(const pl_mover &mover,
+                                       const pl_arg &arg) {
+    for (const pl_port &port : mover.ports) {
+        if (port.host_arg == arg.name) {
+            return &port;
+        }
+    }
+    return nullptr;
+}
+
+// Width in bits of the memory accesses on memory argument arg.
+static inline unsigned mem_bits(generator &gen, const kernel &kernel,
+                                const pl_mover &mover, const pl_arg &arg) {
+    const pl_port *port = find_port(mover, arg);
+    if (port == nullptr) {
+        return arg.bits;
+    } else if (is_wide(gen, *port)) {
+        return gen.get_data().movers.mem_width;
+    }
+    return beat_bits(kernel, *port);
+}
+
+/*
+ * Name of a host argument in the merged mover. Memory arguments belong to a
+ * single mover, while sizes and scalars are shared by the movers of a kernel.
+ */
+static inline std::string arg_name(const pl_mover &mover, const pl_arg &arg,
+                                   const std::string &prefix) {
+    if (prefix.empty()) {
+        return arg.name;
+    } else if (arg.type == pl_arg_type::memory) {
+        return std::format("{}{}_{}", prefix, mover.name, arg.name);
+    }
+    return prefix + arg.name;
+}
+
+static inline std::string arg_param(generator &gen, const kernel &kernel,
+                                    const pl_mover &mover, const pl_arg &arg,
+                                    const std::string &prefix = "") {
+    const std::string name = arg_name(mover, arg, prefix);
+    switch (arg.type) {
+    case pl_arg_type::memory:
+        if (mem_bits(gen, kernel, mover, arg) != arg.bits) {
+            return std::format("ap_uint<{}> *{}",
+                               mem_bits(gen, kernel, mover, arg), name);
+        }
+        return std::format("ap_int<{}> *{}", arg.bits, name);
+    case pl_arg_type::scalar:
+        return std::format("ap_int<{}> {}", arg.bits, name);
+    case pl_arg_type::size:
+        return std::format("long long {}", name);
+    case pl_arg_type::flag:
+        return std::format("bool {}", name);
+    default:
+        throw std::runtime_error("Internal error: unknown pl_arg_type");
+    }
+}
+
+static inline std::vector<std::string>
+stream_params(const kernel &kernel, const pl_port &port,
+              const std::string &prefix = "") {
+    std::vector<std::string> params;
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        params.push_back(std::format("hls::stream<qdma_axis<{}, 0, 0, 0>> "
+                                     "&{}{}", beat_bits(kernel, port), prefix,
+                                     stream_name(port, r)));
+    }
+    return params;
+}
+
+static inline std::vector<std::string> stream_names(const pl_port &port,
+                                                    const std::string &prefix
+                                                            = "") {
+    std::vector<std::string> names;
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        names.push_back(prefix + stream_name(port, r));
+    }
+    return names;
+}
+
+/*
+ * Parameters of a mover: host arguments first, followed by the streams. If
+ * declared is given, arguments already in it are skipped and added otherwise,
+ * so movers of the same kernel can share their size and scalar arguments.
+ */
+static inline std::vector<std::string>
+mover_params(generator &gen, const kernel &kernel, const pl_mover &mover,
+             const std::string &prefix = "",
+             std::unordered_set<std::string> *declared = nullptr) {
+    std::vector<std::string> params;
+    for (const pl_arg &arg : mover_args(mover)) {
+        if (declared != nullptr &&
+            !declared->insert(arg_name(mover, arg, prefix)).second) {
+            continue;
+        }
+        params.push_back(arg_param(gen, kernel, mover, arg, prefix));
+    }
+    for (const pl_port &port : mover.ports) {
+        for (std::string &param : stream_params(kernel, port, prefix)) {
+            params.push_back(std::move(param));
+        }
+    }
+    return params;
+}
+
+static inline std::vector<std::string>
+mover_param_names(const pl_mover &mover, const std::string &prefix = "") {
+    std::vector<std::string> names;
+    for (const pl_arg &arg : mover_args(mover)) {
+        names.push_back(arg_name(mover, arg, prefix));
+    }
+    for (const pl_port &port : mover.ports) {
+        for (std::string &name : stream_names(port, prefix)) {
+            names.push_back(std::move(name));
+        }
+    }
+    return names;
+}
+
+/*
+ * Every memory argument gets its own AXI master (bundle gmem<i>), so the
+ * arguments can be accessed in parallel. bundle is the index of the first
+ * bundle of this mover and is advanced past the bundles used.
+ */
+static inline void
+gen_pl_mover_interface(generator &gen, const pl_mover &mover,
+                       unsigned &bundle, const std::string &prefix = "",
+                       std::unordered_set<std::string> *declared = nullptr) {
+    const mover_options &options = gen.get_data().movers;
+    for (const pl_arg &arg : mover_args(mover)) {
+        if (declared != nullptr &&
+            !declared->insert(arg_name(mover, arg, prefix)).second) {
+            continue;
+        }
+
+        const std::string name = arg_name(mover, arg, prefix);
+        if (arg.type == pl_arg_type::memory) {
+            const pl_port *port = find_port(mover, arg);
+            if (port != nullptr && is_wide(gen, *port)) {
+                const char *dir = pl_port_is_input(port->type) ? "read"
+                                                               : "write";
+                gen.println<generator::NO_INDENT>(
+                    "#pragma HLS interface m_axi port = {} offset = slave "
+                    "bundle = gmem{} max_{}_burst_length = {} "
+                    "num_{}_outstanding = {}", name, bundle, dir,
+                    options.burst_length, dir, options.outstanding);
+            } else {
+                gen.println<generator::NO_INDENT>("#pragma HLS interface "
+                                                  "m_axi port = {} offset "
+                                                  "= slave bundle = gmem{}",
+                                                  name, bundle);
+            }
+            bundle++;
+        }
+        gen.println<generator::NO_INDENT>("#pragma HLS INTERFACE s_axilite "
+                                          "port = {} bundle = control",
+                                          name);
+    }
+    for (const pl_port &port : mover.ports) {
+        for (const std::string &name : stream_names(port, prefix)) {
+            gen.println<generator::NO_INDENT>("#pragma HLS interface axis "
+                                              "port = {}", name);
+        }
+    }
+}
+
+static inline void gen_pl_mover_token(generator &gen, const kernel &kernel,
+                                      const pl_mover &mover,
+                                      const pl_port &port) {
+    gen.println("// Send {} over {} stream",
+                port.type == pl_port_type::size_to_stream ? "size" : "scalar",
+                port.arg);
+    gen.println("qdma_axis<{},0,0,0> qdma_{};", port.bits, port.arg);
+    if (port.type == pl_port_type::size_to_stream) {
+        gen.println("qdma_{0}.data = (ap_int<{1}>) ({2}_total != 0 ? "
+                    "{2}_total : {2});", port.arg, port.bits, port.host_arg);
+    } else {
+        gen.println("qdma_{}.data = (ap_int<{}>) {};", port.arg, port.bits,
+                    port.host_arg);
+    }
+    gen.println("qdma_{}.keep_all();", port.arg);
+    gen.println("qdma_{}.set_last(1);", port.arg);
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        gen.println("{}.write(qdma_{});", stream_name(port, r), port.arg);
+    }
+
+    if (!gen.get_data().persistent ||
+        port.type != pl_port_type::scalar_to_stream) {
+        return;
+    }
+    // A persistent kernel keeps the scalar for this many invocations
+    const bool has_size = std::any_of(mover.args.begin(), mover.args.end(),
+        [](const pl_arg &arg) {
+            return arg.type == pl_arg_type::size && arg.name == "size";
+        });
+    if (!has_size) {
+        throw std::runtime_error(std::format(
+            "persistent graph: mover {} of kernel {} does not know the size "
+            "of a job, connect a vector of the kernel to the host",
+            mover.name, kernel.user_name));
+    }
+    const unsigned num_samples = kernel.wsize * 8 /
+                                 datatype_to_bits(kernel.type);
+    const unsigned block = num_samples * kernel.replicas;
+    gen.println("qdma_{}.data = (ap_int<{}>) ((size + {}) / {});", port.arg,
+                port.bits, block - 1, block);
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        gen.println("{}.write(qdma_{});", stream_name(port, r), port.arg);
+    }
+}
+
+static inline bool is_token_port(const pl_port &port) {
+    return port.type == pl_port_type::scalar_to_stream ||
+           port.type == pl_port_type::size_to_stream;
+}
+
+static inline void gen_pl_mover_tokens(generator &gen, const kernel &kernel,
+                                       const pl_mover &mover) {
+    if (std::none_of(mover.ports.begin(), mover.ports.end(), is_token_port)) {
+        return;
+    }
+
+    // The kernel keeps the tokens of the first chunk for the whole vector
+    gen.println<generator::INCREASE_AFTER>("if (!continued) {{");
+    bool first = true;
+    for (const pl_port &port : mover.ports) {
+        if (is_token_port(port)) {
+            if (!first) {
+                gen.println();
+            }
+            gen_pl_mover_token(gen, kernel, mover, port);
+            first = false;
+        }
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+}
+
+// Beats past the valid beats of a padded port are zero when sent and dropped
+// when received.
+static inline void gen_padded_data(generator &gen, const kernel &kernel,
+                                   const pl_port &port, unsigned replica) {
+    const unsigned bits = beat_bits(kernel, port);
+    const unsigned per_beat = elements_per_beat(kernel, port);
+    const std::string var = replica_name(port.arg, port.replicas, replica);
+    const std::string index = mem_index(port, replica);
+    if (port.type == pl_port_type::mem_to_stream) {
+        gen.println("qdma_axis<{},0,0,0> {};", bits, var);
+        gen.println("{}.data = 0;", var);
+        gen.println<generator::INCREASE_AFTER>("if ({} < valid_{}) {{", index,
+                                               port.arg);
+        gen.println("{}.data = {}[{}];", var, port.host_arg, index);
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen_tail_mask(gen, kernel, port, var, index);
+        gen.println("{}.keep_all();", var);
+        gen.println("{}.write({});", stream_name(port, replica), var);
+        return;
+    }
+
+    gen.println("qdma_axis<{},0,0,0> {} = {}.read();", bits, var,
+                stream_name(port, replica));
+    gen.println<generator::INCREASE_AFTER>("if ({} < valid_{}) {{", index,
+                                           port.arg);
+    if (per_beat == 1) {
+        gen.println("{}[{}] = {}.data;", port.host_arg, index, var);
+    } else {
+        gen.println<generator::INCREASE_AFTER>("if (({} + 1) * {} <= ({})) {{",
+                                               index, per_beat, port.length);
+        gen.println("{}[{}] = {}.data;", port.host_arg, index, var);
+        gen.println<generator::DECREASE_BEFORE>("}} else {{");
+        gen.indent_incr();
+        gen.println("// Keep the memory after the output intact");
+        gen.println("const int keep = (({}) - {} * {}) * {};", port.length,
+                    index, per_beat, port.bits);
+        gen.println("ap_uint<{}> word = {}[{}];", bits, port.host_arg, index);
+        gen.println("word.range(keep - 1, 0) = {}.data.range(keep - 1, 0);",
+                    var);
+        gen.println("{}[{}] = word;", port.host_arg, index);
+        gen.println<generator::DECREASE_BEFORE>("}}");
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+static inline void gen_pl_mover_data(generator &gen, const kernel &kernel,
+                                     const pl_port &port) {
+    const unsigned bits = beat_bits(kernel, port);
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        const std::string var = replica_name(port.arg, port.replicas, r);
+        if (port.block > 1) {
+            gen_padded_data(gen, kernel, port, r);
+        } else if (port.type == pl_port_type::mem_to_stream) {
+            gen.println("qdma_axis<{},0,0,0> {};", bits, var);
+            gen.println("{}.data = {}[{}];", var, port.host_arg,
+                        mem_index(port, r));
+            gen.println("{}.keep_all();", var);
+            gen.println("{}.write({});", stream_name(port, r), var);
+        } else {
+            gen.println("qdma_axis<{},0,0,0> {} = {}.read();", bits, var,
+                        stream_name(port, r));
+            gen.println("{}[{}] = {}.data;", port.host_arg,
+                        mem_index(port, r), var);
+        }
+    }
+}
+
+static inline void gen_pl_mover_loop(generator &gen, const kernel &kernel,
+                                     const pl_port &port) {
+    gen.println("// {} data {} {} stream",
+                pl_port_is_input(port.type) ? "Send" : "Retrieve",
+                pl_port_is_input(port.type) ? "over" : "from", port.arg);
+
+    const bool loop = port.length != "1";
+    if (loop && port.block > 1) {
+        gen.println("// Padded to a multiple of {} elements, only the last "
+                    "chunk", port.block);
+        gen.println("// of a vector moved in chunks may need padding");
+        gen.println("const long long valid_{} = {};", port.arg,
+                    valid_beats(kernel, port));
+    }
+    // Every iteration moves a single beat to each replica
+    const unsigned stride = beat_stride(kernel, port);
+    if (loop) {
+        if (stride > 1) {
+            gen.println<generator::INCREASE_AFTER>(
+                "for (long long i = 0; i < ({}) / {}; i++) {{",
+                padded_length(port), stride);
+        } else {
+            gen.println<generator::INCREASE_AFTER>(
+                "for (long long i = 0; i < {}; i++) {{", padded_length(port));
+        }
+        gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
+    }
+    gen_pl_mover_data(gen, kernel, port);
+    if (loop) {
+        gen.println<generator::DECREASE_BEFORE>("}}");
+    }
+}
+
+// Data port of a dataflow region accessing memory one beat at a time.
+static inline void gen_narrow_port(generator &gen, const kernel &kernel,
+                                   const pl_mover &mover, const pl_port &port,
+                                   const std::vector<std::string> &sizes) {
+    std::vector<std::string> params{
+        arg_param(gen, kernel, mover, find_arg(mover, port.host_arg))};
+    for (std::string &param : stream_params(kernel, port)) {
+        params.push_back(std::move(param));
+    }
+    params.insert(params.end(), sizes.begin(), sizes.end());
+    gen.println<generator::INCREASE_AFTER>("static void {}_{}_move_{}({}) {{",
+                                           kernel.user_name, mover.name,
+                                           port.arg, join(params));
+    gen_pl_mover_loop(gen, kernel, port);
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+}
+
+/*
+ * Wide data movement: memory is accessed in mem_width bit words by a burst
+ * function feeding (or draining) a FIFO, while a second function converts
+ * between words and stream beats. Both run concurrently in a dataflow region.
+ */
+static inline void gen_wide_beats(generator &gen, const kernel &kernel,
+                                  const pl_port &port, bool streams = false) {
+    const unsigned stride = beat_stride(kernel, port);
+    if (port.block > 1) {
+        // Beats holding data, the streams carry the padding as well
+        gen.println("const long long beats = {};", valid_beats(kernel, port));
+        if (streams) {
+            gen.println("const long long padded = ({}) / {};",
+                        padded_length(port), elements_per_beat(kernel, port));
+        }
+    } else if (stride > 1) {
+        gen.println("const long long beats = ({}) / {} * {};", port.length,
+                    stride, port.replicas);
+    } else {
+        gen.println("const long long beats = {};", port.length);
+    }
+}
+
+static inline void gen_wide_loop(generator &gen, const pl_port &port) {
+    const char *beats = port.block > 1 ? "padded" : "beats";
+    if (port.replicas > 1) {
+        gen.println<generator::INCREASE_AFTER>("for (long long i = 0; i < "
+                                               "{} / {}; i++) {{", beats,
+                                               port.replicas);
+    } else {
+        gen.println<generator::INCREASE_AFTER>("for (long long i = 0; i < "
+                                               "{}; i++) {{", beats);
+    }
+    gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
+}
+
+static inline void gen_wide_mm2s(generator &gen, const kernel &kernel,
+                                 const pl_mover &mover, const pl_port &port,
+                                 const std::vector<std::string> &sizes) {
+    const unsigned mem_width = gen.get_data().movers.mem_width;
+    const unsigned bits = beat_bits(kernel, port);
+    const unsigned per_word = mem_width / bits;
+
+    std::vector<std::string> params{
+        std::format("ap_uint<{}> *{}", mem_width, port.host_arg),
+        std::format("hls::stream<ap_uint<{}>> &fifo_{}", mem_width, port.arg)};
+    params.insert(params.end(), sizes.begin(), sizes.end());
+    gen.println<generator::INCREASE_AFTER>("static void {}_{}_read_{}({}) {{",
+                                           kernel.user_name, mover.name,
+                                           port.arg, join(params));
+    gen_wide_beats(gen, kernel, port);
+    gen.println();
+    gen.println("// Read {} from memory in {} bit words", port.arg,
+                mem_width);
+    gen.println<generator::INCREASE_AFTER>("for (long long i = 0; "
+                                           "i < (beats + {}) / {}; i++) {{",
+                                           per_word - 1, per_word);
+    gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
+    gen.println("fifo_{}.write({}[i]);", port.arg, port.host_arg);
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+
+    params = {std::format("hls::stream<ap_uint<{}>> &fifo_{}", mem_width,
+                          port.arg)};
+    for (std::string &param : stream_params(kernel, port)) {
+        params.push_back(std::move(param));
+    }
+    params.insert(params.end(), sizes.begin(), sizes.end());
+    gen.println<generator::INCREASE_AFTER>("static void {}_{}_send_{}({}) {{",
+                                           kernel.user_name, mover.name,
+                                           port.arg, join(params));
+    gen_wide_beats(gen, kernel, port, true);
+    gen.println("ap_uint<{}> word = 0;", mem_width);
+    gen.println("int j = 0;");
+    gen.println();
+    gen.println("// Split {} bit words into {} bit beats", mem_width, bits);
+    gen_wide_loop(gen, port);
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        const std::string var = replica_name(port.arg, port.replicas, r);
+        if (port.block > 1) {
+            const std::string index = mem_index(port, r);
+            gen.println<generator::INCREASE_AFTER>("if (j == 0 && {} < beats) "
+                                                   "{{", index);
+            gen.println("word = fifo_{}.read();", port.arg);
+            gen.println<generator::DECREASE_BEFORE>("}}");
+            gen.println("qdma_axis<{},0,0,0> {};", bits, var);
+            gen.println("{}.data = 0;", var);
+            gen.println<generator::INCREASE_AFTER>("if ({} < beats) {{",
+                                                   index);
+            gen.println("{}.data = word.range({}, 0);", var, bits - 1);
+            gen.println<generator::DECREASE_BEFORE>("}}");
+            gen_tail_mask(gen, kernel, port, var, index);
+        } else {
+            gen.println<generator::INCREASE_AFTER>("if (j == 0) {{");
+            gen.println("word = fifo_{}.read();", port.arg);
+            gen.println<generator::DECREASE_BEFORE>("}}");
+            gen.println("qdma_axis<{},0,0,0> {};", bits, var);
+            gen.println("{}.data = word.range({}, 0);", var, bits - 1);
+        }
+        gen.println("{}.keep_all();", var);
+        gen.println("{}.write({});", stream_name(port, r), var);
+        gen.println("word >>= {};", bits);
+        gen.println("j = (j == {}) ? 0 : j + 1;", per_word - 1);
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+}
+
+static inline void gen_wide_s2mm(generator &gen, const kernel &kernel,
+                                 const pl_mover &mover, const pl_port &port,
+                                 const std::vector<std::string> &sizes) {
+    const unsigned mem_width = gen.get_data().movers.mem_width;
+    const unsigned bits = beat_bits(kernel, port);
+    const unsigned per_word = mem_width / bits;
+
+    std::vector<std::string> params = stream_params(kernel, port);
+    params.push_back(std::format("hls::stream<ap_uint<{}>> &fifo_{}",
+                                 mem_width, port.arg));
+    params.insert(params.end(), sizes.begin(), sizes.end());
+    gen.println<generator::INCREASE_AFTER>("static void {}_{}_recv_{}({}) {{",
+                                           kernel.user_name, mover.name,
+                                           port.arg, join(params));
+    gen_wide_beats(gen, kernel, port, true);
+    gen.println("ap_uint<{}> word = 0;", mem_width);
+    gen.println("int j = 0;");
+    gen.println();
+    gen.println("// Merge {} bit beats into {} bit words", bits, mem_width);
+    gen_wide_loop(gen, port);
+    for (unsigned r = 0; r < port.replicas; ++r) {
+        const std::string var = replica_name(port.arg, port.replicas, r);
+        gen.println("qdma_axis<{},0,0,0> {} = {}.read();", bits, var,
+                    stream_name(port, r));
+        if (port.block > 1) {
+            // Drop the padding
+            gen.println<generator::INCREASE_AFTER>("if ({} < beats) {{",
+                                                   mem_index(port, r));
+        }
+        gen.println("word.range(j * {0} + {1}, j * {0}) = {2}.data;", bits,
+                    bits - 1, var);
+        gen.println<generator::INCREASE_AFTER>("if (j == {}) {{",
+                                               per_word - 1);
+        gen.println("fifo_{}.write(word);", port.arg);
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println("j = (j == {}) ? 0 : j + 1;", per_word - 1);
+        if (port.block > 1) {
+            gen.println<generator::DECREASE_BEFORE>("}}");
+        }
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    if (per_word > 1) {
+        gen.println<generator::INCREASE_AFTER>("if (j != 0) {{");
+        gen.println("fifo_{}.write(word);", port.arg);
+        gen.println<generator::DECREASE_BEFORE>("}}");
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+
+    params = {std::format("hls::stream<ap_uint<{}>> &fifo_{}", mem_width,
+                          port.arg),
+              std::format("ap_uint<{}> *{}", mem_width, port.host_arg)};
+    params.insert(params.end(), sizes.begin(), sizes.end());
+    gen.println<generator::INCREASE_AFTER>("static void {}_{}_write_{}({}) {{",
+                                           kernel.user_name, mover.name,
+                                           port.arg, join(params));
+    // Padded ports may end in a partial beat, so count in elements
+    const unsigned per_beat = port.block > 1 ? elements_per_beat(kernel, port)
+                                             : 1;
+    const unsigned per_word_unit = per_word * per_beat;
+    const unsigned unit_bits = bits / per_beat;
+    std::string units = "beats";
+    if (port.block > 1) {
+        units = std::format("({})", port.length);
+    } else {
+        gen_wide_beats(gen, kernel, port);
+    }
+    gen.println("const long long words = {} / {};", units, per_word_unit);
+    gen.println();
+    gen.println("// Write {} to memory in {} bit words", port.arg, mem_width);
+    gen.println<generator::INCREASE_AFTER>("for (long long i = 0; i < words; "
+                                           "i++) {{");
+    gen.println<generator::NO_INDENT>("#pragma HLS pipeline II = 1");
+    gen.println("{}[i] = fifo_{}.read();", port.host_arg, port.arg);
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    if (per_word_unit > 1) {
+        gen.println();
+        gen.println("// Merge the last partial word, leaving the memory after "
+                    "the output intact");
+        gen.println<generator::INCREASE_AFTER>("if ({} % {} != 0) {{", units,
+                                               per_word_unit);
+        gen.println("const int valid = ({} % {}) * {};", units, per_word_unit,
+                    unit_bits);
+        gen.println("ap_uint<{}> last = fifo_{}.read();", mem_width,
+                    port.arg);
+        gen.println("ap_uint<{}> word = {}[words];", mem_width,
+                    port.host_arg);
+        gen.println("word.range(valid - 1, 0) = last.range(valid - 1, 0);");
+        gen.println("{}[words] = word;", port.host_arg);
+        gen.println<generator::DECREASE_BEFORE>("}}");
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+}
+
+// Arguments of the dataflow region, in the order of the mover signature.
+static inline std::vector<const pl_arg *> dataflow_args(generator &gen,
+                                                        const pl_mover &mover) {
+    std::vector<const pl_arg *> args;
+    for (const pl_arg &arg : mover.args) {
+        const pl_port *port = find_port(mover, arg);
+        if (arg.type == pl_arg_type::size ||
+            (arg.type == pl_arg_type::memory && port != nullptr &&
+             in_dataflow(gen, mover, *port))) {
+            args.push_back(&arg);
+        }
+    }
+    return args;
+}
+
+static inline void gen_dataflow(generator &gen, const kernel &kernel,
+                                const pl_mover &mover) {
+    const mover_options &options = gen.get_data().movers;
+    std::vector<std::string> sizes;
+    std::vector<std::string> size_names;
+    for (const pl_arg &arg : mover.args) {
+        if (arg.type == pl_arg_type::size) {
+            sizes.push_back(std::format("long long {}", arg.name));
+            size_names.push_back(arg.name);
+        }
+    }
+
+    for (const pl_port &port : mover.ports) {
+        if (!in_dataflow(gen, mover, port)) {
+            continue;
+        } else if (!is_wide(gen, port)) {
+            gen_narrow_port(gen, kernel, mover, port, sizes);
+        } else if (port.type == pl_port_type::mem_to_stream) {
+            gen_wide_mm2s(gen, kernel, mover, port, sizes);
+        } else {
+            gen_wide_s2mm(gen, kernel, mover, port, sizes);
+        }
+    }
+
+    std::vector<std::string> params;
+    for (const pl_arg *arg : dataflow_args(gen, mover)) {
+        params.push_back(arg_param(gen, kernel, mover, *arg));
+    }
+    for (const pl_port &port : mover.ports) {
+        if (in_dataflow(gen, mover, port)) {
+            for (std::string &param : stream_params(kernel, port)) {
+                params.push_back(std::move(param));
+            }
+        }
+    }
+    gen.println<generator::INCREASE_AFTER>("static void {}_{}_dataflow({}) "
+                                           "{{", kernel.user_name, mover.name,
+                                           join(params));
+    gen.println<generator::NO_INDENT>("#pragma HLS dataflow");
+    for (const pl_port &port : mover.ports) {
+        if (is_wide(gen, port)) {
+            gen.println("hls::stream<ap_uint<{}>> fifo_{};", options.mem_width,
+                        port.arg);
+            gen.println<generator::NO_INDENT>("#pragma HLS stream variable = "
+                                              "fifo_{} depth = {}", port.arg,
+                                              2 * options.burst_length);
+        }
+    }
+    if (has_wide_port(gen, mover)) {
+        gen.println();
+    }
+    for (const pl_port &port : mover.ports) {
+        if (!in_dataflow(gen, mover, port)) {
+            continue;
+        }
+
+        const std::string fifo = std::format("fifo_{}", port.arg);
+        const std::string streams = join(stream_names(port));
+        std::string sizes_arg = join(size_names);
+        if (!sizes_arg.empty()) {
+            sizes_arg = ", " + sizes_arg;
+        }
+
+        if (!is_wide(gen, port)) {
+            gen.println("{}_{}_move_{}({}, {}{});", kernel.user_name,
+                        mover.name, port.arg, port.host_arg, streams,
+                        sizes_arg);
+        } else if (port.type == pl_port_type::mem_to_stream) {
+            gen.println("{}_{}_read_{}({}, {}{});", kernel.user_name,
+                        mover.name, port.arg, port.host_arg, fifo, sizes_arg);
+            gen.println("{}_{}_send_{}({}, {}{});", kernel.user_name,
+                        mover.name, port.arg, fifo, streams, sizes_arg);
+        } else {
+            gen.println("{}_{}_recv_{}({}, {}{});", kernel.user_name,
+                        mover.name, port.arg, streams, fifo, sizes_arg);
+            gen.println("{}_{}_write_{}({}, {}{});", kernel.user_name,
+                        mover.name, port.arg, fifo, port.host_arg, sizes_arg);
+        }
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+}
+
+void gen_pl_mover(generator &gen, const kernel &kernel, const pl_mover &mover,
+                  bool top) {
+    if (mover.empty()) {
+        throw std::runtime_error(
+            std::format("Internal error: {}_{} has no ports", kernel.user_name,
+                        mover.name));
+    }
+
+    for (const std::string &define : mover.defines) {
+        gen.println<generator::NO_INDENT>("#define {}", define);
+    }
+    if (!mover.defines.empty()) {
+        gen.println();
+    }
+
+    const bool dataflow = uses_dataflow(gen, mover);
+    if (dataflow) {
+        gen_dataflow(gen, kernel, mover);
+    }
+
+    if (top) {
+        unsigned bundle = 0;
+        gen.println<generator::INCREASE_AFTER>(
+            "void {}_{}({}) {{", kernel.user_name, mover.name,
+            join(mover_params(gen, kernel, mover)));
+        gen_pl_mover_interface(gen, mover, bundle);
+        gen.println<generator::NO_INDENT>("#pragma HLS interface s_axilite "
+                                          "port = return bundle = control");
+        gen.println();
+    } else {
+        // Interfaces are declared by the merged mover calling this function
+        gen.println<generator::INCREASE_AFTER>(
+            "static void {}_{}({}) {{", kernel.user_name, mover.name,
+            join(mover_params(gen, kernel, mover)));
+    }
+
+    gen_pl_mover_tokens(gen, kernel, mover);
+
+    if (dataflow) {
+        std::vector<std::string> names;
+        for (const pl_arg *arg : dataflow_args(gen, mover)) {
+            names.push_back(arg->name);
+        }
+        for (const pl_port &port : mover.ports) {
+            if (in_dataflow(gen, mover, port)) {
+                for (std::string &name : stream_names(port)) {
+                    names.push_back(std::move(name));
+                }
+            }
+        }
+        if (has_wide_port(gen, mover)) {
+            gen.println("// Move data in {} bit bursts",
+                        gen.get_data().movers.mem_width);
+        } else {
+            gen.println("// Move data of all ports concurrently");
+        }
+        gen.println("{}_{}_dataflow({});", kernel.user_name, mover.name,
+                    join(names));
+    }
+
+    for (const pl_port &port : mover.ports) {
+        if ((port.type == pl_port_type::mem_to_stream ||
+             port.type == pl_port_type::stream_to_mem) &&
+            !in_dataflow(gen, mover, port)) {
+            gen_pl_mover_loop(gen, kernel, port);
+        }
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+
+    if (!top) {
+        // Defines may differ between the movers sharing a merged file
+        for (const std::string &define : mover.defines) {
+            gen.println<generator::NO_INDENT>("#undef {}",
+                                              define.substr(0,
+                                                            define.find(' ')));
+        }
+        gen.println();
+    }
+}
+
+void gen_pl_merged_mover(generator &gen) {
+    std::vector<std::tuple<const kernel *, pl_mover>> movers;
+    for (const kernel &kernel : gen.get_data().kernels) {
+        for (pl_mover &mover : get_kernel_generator(kernel)->get_pl_movers()) {
+            movers.emplace_back(&kernel, std::move(mover));
+        }
+    }
+
+    for (const auto &[kernel, mover] : movers) {
+        gen_pl_mover(gen, *kernel, mover, false);
+    }
+
+    std::vector<std::string> params;
+    std::unordered_set<std::string> declared;
+    for (const auto &[kernel, mover] : movers) {
+        for (std::string &param : mover_params(gen, *kernel, mover,
+                                               kernel->user_name + "_",
+                                               &declared)) {
+            params.push_back(std::move(param));
+        }
+    }
+    gen.println<generator::INCREASE_AFTER>("void {}({}) {{",
+                                           merged_mover_name, join(params));
+    declared.clear();
+    unsigned bundle = 0;
+    for (const auto &[kernel, mover] : movers) {
+        gen_pl_mover_interface(gen, mover, bundle, kernel->user_name + "_",
+                               &declared);
+    }
+    gen.println<generator::NO_INDENT>("#pragma HLS interface s_axilite "
+                                      "port = return bundle = control");
+    gen.println();
+
+    // Run all movers concurrently, the AIE graph needs inputs and outputs
+    // to make progress at the same time.
+    gen.println<generator::NO_INDENT>("#pragma HLS dataflow");
+    for (const auto &[kernel, mover] : movers) {
+        gen.println("{}_{}({});", kernel->user_name, mover.name,
+                    join(mover_param_names(mover, kernel->user_name + "_")));
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+void gen_pl_link(generator &gen, const kernel &kernel,
+                 const std::vector<pl_mover> &movers) {
+    for (const pl_mover &mover : movers) {
+        gen.println("nk={0}_{1}:1:{0}_{1}", kernel.user_name, mover.name);
+    }
+    gen.println();
+    for (const pl_mover &mover : movers) {
+        for (const pl_port &port : mover.ports) {
+            for (unsigned r = 0; r < port.replicas; ++r) {
+                const std::string plio = replica_name(
+                        std::format("{}_{}", kernel.user_name, port.arg),
+                        port.replicas, r);
+                if (pl_port_is_input(port.type)) {
+                    gen.println("sc={}_{}.{}:ai_engine_0.{}", kernel.user_name,
+                                mover.name, stream_name(port, r), plio);
+                } else {
+                    gen.println("sc=ai_engine_0.{}:{}_{}.{}", plio,
+                                kernel.user_name, mover.name,
+                                stream_name(port, r));
+                }
+            }
+        }
+    }
+    gen.println();
+    for (const pl_mover &mover : movers) {
+        gen.println("slr={}_{}:SLR0", kernel.user_name, mover.name);
+    }
+    gen.println();
+
+    // Continue spreading bundles over the NoC ports where the movers of the
+    // previous kernels stopped
+    const unsigned noc_ports = gen.get_data().movers.noc_ports;
+    unsigned channel = 0;
+    for (const codegen::kernel &prev : gen.get_data().kernels) {
+        if (&prev == &kernel) {
+            break;
+        }
+        for (const pl_mover &mover :
+                get_kernel_generator(prev)->get_pl_movers()) {
+            channel += count_memory_args(mover);
+        }
+    }
+    for (const pl_mover &mover : movers) {
+        for (unsigned bundle = 0; bundle < count_memory_args(mover);
+             ++bundle) {
+            gen.println("sp={}_{}.m_axi_gmem{}:MC_NOC{}", kernel.user_name,
+                        mover.name, bundle, channel % noc_ports);
+            channel++;
+        }
+    }
+}
+
+void gen_pl_merged_link(generator &gen) {
+    unsigned bundles = 0;
+    gen.println("nk={0}:1:{0}", merged_mover_name);
+    gen.println();
+    for (const kernel &kernel : gen.get_data().kernels) {
+        for (const pl_mover &mover :
+                get_kernel_generator(kernel)->get_pl_movers()) {
+            for (const pl_port &port : mover.ports) {
+                for (unsigned r = 0; r < port.replicas; ++r) {
+                    const std::string plio = replica_name(
+                            std::format("{}_{}", kernel.user_name, port.arg),
+                            port.replicas, r);
+                    if (pl_port_is_input(port.type)) {
+                        gen.println("sc={}.{}_{}:ai_engine_0.{}",
+                                    merged_mover_name, kernel.user_name,
+                                    stream_name(port, r), plio);
+                    } else {
+                        gen.println("sc=ai_engine_0.{}:{}.{}_{}", plio,
+                                    merged_mover_name, kernel.user_name,
+                                    stream_name(port, r));
+                    }
+                }
+            }
+            bundles += count_memory_args(mover);
+        }
+    }
+    gen.println();
+    gen.println("slr={}:SLR0", merged_mover_name);
+    gen.println();
+    for (unsigned bundle = 0; bundle < bundles; ++bundle) {
+        gen.println("sp={}.m_axi_gmem{}:MC_NOC{}", merged_mover_name, bundle,
+                    bundle % gen.get_data().movers.noc_ports);
+    }
+}
+
+// Number the host arguments of mover like mover_params, adding those of
+// target to args.
+static void number_pl_kernel_args(const kernel &target, const kernel &owner,
+                                  const pl_mover &mover,
+                                  const std::string &pl_kernel,
+                                  const std::string &prefix, unsigned &index,
+                                  std::unordered_set<std::string> *declared,
+                                  std::vector<pl_kernel_arg> &args) {
+    for (const pl_arg &arg : mover_args(mover)) {
+        if (declared != nullptr &&
+            !declared->insert(arg_name(mover, arg, prefix)).second) {
+            continue;
+        }
+        if (&owner == &target) {
+            const bool implicit = std::none_of(mover.args.begin(),
+                mover.args.end(),
+                [&arg](const pl_arg &other) { return other.name == arg.name; });
+            args.emplace_back(pl_kernel, mover.name, arg, index, implicit);
+        }
+        index++;
+    }
+    for (const pl_port &port : mover.ports) {
+        index += port.replicas;
+    }
+}
+
+std::vector<pl_kernel_arg> get_pl_kernel_args(generator &gen,
+                                              const kernel &kernel) {
+    std::vector<pl_kernel_arg> args;
+    if (!gen.get_data().movers.merge) {
+        for (const pl_mover &mover :
+                get_kernel_generator(kernel)->get_pl_movers()) {
+            unsigned index = 0;
+            number_pl_kernel_args(kernel, kernel, mover,
+                                  std::format("{}_{}", kernel.user_name,
+                                              mover.name),
+                                  "", index, nullptr, args);
+        }
+        return args;
+    }
+
+    // All movers share the signature of the merged mover
+    unsigned index = 0;
+    std::unordered_set<std::string> declared;
+    for (const codegen::kernel &owner : gen.get_data().kernels) {
+        for (const pl_mover &mover :
+                get_kernel_generator(owner)->get_pl_movers()) {
+            number_pl_kernel_args(kernel, owner, mover, merged_mover_name,
+                                  owner.user_name + "_", index, &declared,
+                                  args);
+        }
+    }
+    return args;
+}
+
+std::vector<pl_kernel_generator> kernel_generator::get_pl_generators() {
+    std::vector<pl_kernel_generator> generators;
+    for (pl_mover &mover : get_pl_movers()) {
+        std::string name = mover.name;
+        generators.emplace_back(std::move(name),
+            [this, mover = std::move(mover)](generator &gen) {
+                gen_pl_mover(gen, this->k, mover, true);
+            });
+    }
+
+    return generators;
+}
+
+void kernel_generator::gen_link(generator &gen) {
+    gen_pl_link(gen, k, get_pl_movers());
+}
+
+} // codegen
+} // aieblas
@@ -0,0 +1,572 @@
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include "aieblas/detail/util.hpp"
+#include "aieblas/detail/codegen/generator.hpp"
+#include "aieblas/detail/codegen/kernels.hpp"
+
+namespace aieblas {
+namespace codegen {
+
+static inline std::string plio_name(const kernel &kernel, const pl_port &port,
+                                    unsigned replica) {
+    return replica_name(std::format("{}_{}", kernel.user_name, port.arg),
+                        port.replicas, replica);
+}
+
+static inline kernel_arg find_kernel_arg(const kernel &kernel,
+                                         const std::string &name) {
+    for (const kernel_arg &arg : get_kernel_args(kernel.operation)) {
+        if (arg.name == name) {
+            return arg;
+        }
+    }
+    throw std::runtime_error(std::format("Internal error: kernel {} has no "
+                                         "argument {}", kernel.user_name,
+                                         name));
+}
+
+static inline const pl_port *find_port(const std::vector<pl_mover> &movers,
+                                       const pl_kernel_arg &arg) {
+    for (const pl_mover &mover : movers) {
+        if (mover.name != arg.mover) {
+            continue;
+        }
+        for (const pl_port &port : mover.ports) {
+            if (port.host_arg == arg.arg.name) {
+                return &port;
+            }
+        }
+    }
+    return nullptr;
+}
+
+static inline const pl_kernel_arg &
+find_pl_arg(const std::vector<pl_kernel_arg> &args, const pl_mover &mover,
+            const pl_port &port) {
+    for (const pl_kernel_arg &arg : args) {
+        if (arg.mover == mover.name && arg.arg.name == port.host_arg) {
+            return arg;
+        }
+    }
+    throw std::runtime_error(std::format("Internal error: no PL argument for "
+                                         "{} of mover {}", port.arg,
+                                         mover.name));
+}
+
+// Values per line of the PLIO file of port, one per beat of its PLIO.
+static inline unsigned values_per_line(const kernel &kernel,
+                                       const pl_port &port) {
+    const kernel_arg arg = find_kernel_arg(kernel, port.arg);
+    if (arg.type == karg_type::input_index) {
+        return 1;
+    }
+    return std::max(1u, plio_bits(kernel, arg) /
+                        datatype_to_bits(kernel.type));
+}
+
+// Names used by an expression, e.g. m and n of "m * n".
+static inline std::set<std::string> expression_names(const std::string &expr) {
+    std::set<std::string> names;
+    std::string name;
+    for (char c : expr + " ") {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+            name += c;
+        } else if (!name.empty()) {
+            if (!std::isdigit(static_cast<unsigned char>(name[0]))) {
+                names.insert(name);
+            }
+            name.clear();
+        }
+    }
+    return names;
+}
+
+/*
+ * Sizes used by the ports of kernel, or only by its output ports, and by
+ * expression: size arguments of the movers are the problem size, defines of
+ * the movers keep their value. Tokens use the size as well.
+ */
+static void gen_sim_sizes(generator &gen, const std::vector<pl_mover> &movers,
+                          bool outputs, const std::string &expression = "") {
+    std::set<std::string> used = expression_names(expression);
+    for (const pl_mover &mover : movers) {
+        for (const pl_port &port : mover.ports) {
+            if (outputs && pl_port_is_input(port.type)) {
+                continue;
+            }
+            used.merge(expression_names(port.length));
+            if (port.type == pl_port_type::size_to_stream) {
+                used.insert(port.host_arg);
+            } else if (port.type == pl_port_type::scalar_to_stream &&
+                       gen.get_data().persistent) {
+                used.insert("size");
+            }
+        }
+    }
+
+    std::set<std::string> declared;
+    for (const pl_mover &mover : movers) {
+        for (const pl_arg &arg : mover.args) {
+            if (arg.type == pl_arg_type::size && used.contains(arg.name) &&
+                declared.insert(arg.name).second) {
+                gen.println("const std::uint64_t {} = problem_size;",
+                            arg.name);
+            }
+        }
+        for (const std::string &define : mover.defines) {
+            const std::size_t split = define.find(' ');
+            const std::string name = define.substr(0, split);
+            if (split != std::string::npos && used.contains(name) &&
+                declared.insert(name).second) {
+                gen.println("const std::uint64_t {} = {};", name,
+                            define.substr(split + 1));
+            }
+        }
+    }
+}
+
+// Iterations of the graph in a run of kernel, empty for persistent graphs.
+static inline std::string graph_iterations(generator &gen,
+                                           const kernel &kernel) {
+    if (gen.get_data().persistent) {
+        return "";
+    }
+    return get_kernel_generator(kernel)->get_graph_iterations();
+}
+
+/*
+ * Set the arguments of the runs of the PL kernels of kernel to random data
+ * and write the stimulus of its input PLIOs. Scalars sent as tokens are
+ * followed by the number of invocations of the job in persistent graphs.
+ * Otherwise the iterations of the graph of kernel are checked against the
+ * other kernels in iterations.
+ */
+static void gen_sim_inputs(generator &gen, const kernel &kernel) {
+    const char *type = datatype_to_host_type(kernel.type);
+    const std::vector<pl_mover> movers =
+        get_kernel_generator(kernel)->get_pl_movers();
+    const std::vector<pl_kernel_arg> args = get_pl_kernel_args(gen, kernel);
+    const std::string iterations = graph_iterations(gen, kernel);
+
+    gen.println("// {}", kernel.user_name);
+    gen.println<generator::INCREASE_AFTER>("{{");
+    gen_sim_sizes(gen, movers, false, iterations);
+    if (!iterations.empty()) {
+        gen.println<generator::INCREASE_AFTER>(
+            "if (!set_iterations(iterations, {}, \"{}\")) {{", iterations,
+            kernel.user_name);
+        gen.println("return 1;");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+    }
+    for (const kernel_arg &arg : get_kernel_args(kernel.operation)) {
+        if (kernel.connections.at(arg.name).type == connection_type::rtp) {
+            // The graph starts with all runtime parameters at 1
+            for (unsigned r = 0; r < kernel.replicas; ++r) {
+                gen.println("set_parameter<{}>(\"{}\", 1);", type,
+                            rtp_port_name(kernel, arg.name, r));
+            }
+        }
+    }
+    for (const pl_kernel_arg &arg : args) {
+        const pl_port *port = find_port(movers, arg);
+        if (arg.implicit) {
+            continue;
+        } else if (arg.arg.type == pl_arg_type::size) {
+            gen.println("set_scalar<std::uint64_t>(runs, \"{}\", {}, "
+                        "problem_size);", arg.pl_kernel, arg.index);
+        } else if (port == nullptr) {
+            continue;
+        } else if (arg.arg.type == pl_arg_type::scalar) {
+            gen.println("const {} {}_{} = random_value<{}>(rng);", type,
+                        kernel.user_name, port->arg, type);
+            gen.println("set_scalar<{}>(runs, \"{}\", {}, {}_{});", type,
+                        arg.pl_kernel, arg.index, kernel.user_name,
+                        port->arg);
+        } else if (arg.arg.type == pl_arg_type::memory) {
+            if (pl_port_is_input(port->type)) {
+                gen.println("set_buffer<{0}>(runs, \"{1}\", {2}, "
+                            "random_vector<{0}>(rng, {3}));", type,
+                            arg.pl_kernel, arg.index, port->length);
+            } else {
+                gen.println("set_buffer<{0}>(runs, \"{1}\", {2}, "
+                            "std::vector<{0}>({3}));", type, arg.pl_kernel,
+                            arg.index, port->length);
+            }
+        }
+    }
+
+    for (const pl_mover &mover : movers) {
+        for (const pl_port &port : mover.ports) {
+            if (port.type == pl_port_type::stream_to_mem) {
+                continue;
+            }
+            if (port.type == pl_port_type::size_to_stream) {
+                gen.println("const std::vector<std::uint64_t> {}_{}{{{}}};",
+                            kernel.user_name, port.arg, port.host_arg);
+            } else if (port.type == pl_port_type::scalar_to_stream) {
+                if (gen.get_data().persistent) {
+                    // Matches the count sent by the mover, see pl_movers.cpp
+                    const unsigned block = std::max(1u,
+                        kernel.wsize * 8 / datatype_to_bits(kernel.type) *
+                        kernel.replicas);
+                    gen.println("const std::vector<{0}> {1}_{2}_tokens{{"
+                                "{1}_{2}, bits_of<{0}>((size + {3}) / {4})}};",
+                                type, kernel.user_name, port.arg, block - 1,
+                                block);
+                } else {
+                    gen.println("const std::vector<{0}> {1}_{2}_tokens{{"
+                                "{1}_{2}}};", type, kernel.user_name,
+                                port.arg);
+                }
+            }
+
+            for (unsigned r = 0; r < port.replicas; ++r) {
+                const std::string name = plio_name(kernel, port, r);
+                if (port.type == pl_port_type::size_to_stream) {
+                    gen.println("write_plio(\"data/{}.txt\", {}_{}, 1);",
+                                name, kernel.user_name, port.arg);
+                } else if (port.type == pl_port_type::scalar_to_stream) {
+                    gen.println("write_plio(\"data/{}.txt\", {}_{}_tokens, "
+                                "1);", name, kernel.user_name, port.arg);
+                } else {
+                    const pl_kernel_arg &arg = find_pl_arg(args, mover, port);
+                    gen.println("write_plio(\"data/{}.txt\", split(buffer<{}>("
+                                "runs, \"{}\", {}), {}, {}, {}, {}, {}), {});",
+                                name, type, arg.pl_kernel, arg.index,
+                                port.length, padded_length(port),
+                                elements_per_beat(kernel, port),
+                                port.replicas, r,
+                                values_per_line(kernel, port));
+                }
+            }
+        }
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+// Write the golden output of the output PLIOs of kernel, padding is zero.
+static void gen_sim_outputs(generator &gen, const kernel &kernel) {
+    const char *type = datatype_to_host_type(kernel.type);
+    const std::vector<pl_mover> movers =
+        get_kernel_generator(kernel)->get_pl_movers();
+    const std::vector<pl_kernel_arg> args = get_pl_kernel_args(gen, kernel);
+
+    bool outputs = false;
+    for (const pl_mover &mover : movers) {
+        for (const pl_port &port : mover.ports) {
+            outputs = outputs || port.type == pl_port_type::stream_to_mem;
+        }
+    }
+    if (!outputs) {
+        return;
+    }
+
+    gen.println("// {}", kernel.user_name);
+    gen.println<generator::INCREASE_AFTER>("{{");
+    gen_sim_sizes(gen, movers, true);
+    for (const pl_mover &mover : movers) {
+        for (const pl_port &port : mover.ports) {
+            if (port.type != pl_port_type::stream_to_mem) {
+                continue;
+            }
+            const pl_kernel_arg &arg = find_pl_arg(args, mover, port);
+            for (unsigned r = 0; r < port.replicas; ++r) {
+                gen.println("write_plio(\"data/golden/{}.txt\", split(buffer<"
+                            "{}>(runs, \"{}\", {}), {}, {}, {}, {}, {}), {});",
+                            plio_name(kernel, port, r), type, arg.pl_kernel,
+                            arg.index, port.length, padded_length(port),
+                            elements_per_beat(kernel, port), port.replicas,
+                            r, values_per_line(kernel, port));
+            }
+        }
+    }
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+static void gen_sim_helpers(generator &gen, bool iterations) {
+    gen.println("using runs_t = std::map<std::string, "
+                "std::shared_ptr<xrt::mock::run_state>>;");
+    gen.println();
+    gen.println("// Small integers keep reductions from overflowing");
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("T random_value(std::mt19937_64 "
+                                           "&rng) {{");
+    gen.println<generator::INCREASE_AFTER>("if constexpr (std::is_floating_"
+                                           "point_v<T>) {{");
+    gen.println("return std::uniform_real_distribution<T>(-1, 1)(rng);");
+    gen.println<generator::DECREASE_BEFORE>("}} else if constexpr "
+                                            "(std::is_signed_v<T>) {{");
+    gen.indent_incr();
+    gen.println("return static_cast<T>(std::uniform_int_distribution<"
+                "long long>(-8, 8)(rng));");
+    gen.println<generator::DECREASE_BEFORE>("}} else {{");
+    gen.indent_incr();
+    gen.println("return static_cast<T>(std::uniform_int_distribution<"
+                "unsigned long long>(0, 8)(rng));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("std::vector<T> random_vector("
+                                           "std::mt19937_64 &rng, "
+                                           "std::uint64_t n) {{");
+    gen.println("std::vector<T> values(n);");
+    gen.println<generator::INCREASE_AFTER>("for (T &value : values) {{");
+    gen.println("value = random_value<T>(rng);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return values;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    if (iterations) {
+        gen.println("// All kernels run the iterations of the graph");
+        gen.println("bool set_iterations(std::uint64_t &iterations, "
+                    "std::uint64_t needed,");
+        gen.println<generator::INCREASE_AFTER>("                    const "
+                                               "char *kernel) {{");
+        gen.println<generator::INCREASE_AFTER>("if (iterations != 0 && "
+                                               "iterations != needed) {{");
+        gen.println("std::fprintf(stderr, \"Kernel %s needs %llu iterations "
+                    "of the graph, \"");
+        gen.println("             \"another kernel %llu\\n\", kernel,");
+        gen.println("             static_cast<unsigned long long>(needed),");
+        gen.println("             static_cast<unsigned long long>"
+                    "(iterations));");
+        gen.println("return false;");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println("iterations = needed;");
+        gen.println("return true;");
+        gen.println<generator::DECREASE_BEFORE>("}}");
+        gen.println();
+    }
+    gen.println("// Element holding the bits of an integer token");
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("T bits_of(std::uint64_t value) "
+                                           "{{");
+    gen.println("T element{{}};");
+    gen.println("std::memcpy(&element, &value, std::min(sizeof(T), "
+                "sizeof(value)));");
+    gen.println("return element;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("xrt::mock::run_state &run(runs_t "
+                                           "&runs, const std::string "
+                                           "&kernel) {{");
+    gen.println("std::shared_ptr<xrt::mock::run_state> &state = "
+                "runs[kernel];");
+    gen.println<generator::INCREASE_AFTER>("if (!state) {{");
+    gen.println("state = std::make_shared<xrt::mock::run_state>();");
+    gen.println("state->kernel = kernel;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return *state;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("void set_scalar(runs_t &runs, "
+                                           "const std::string &kernel, "
+                                           "int index, T value) {{");
+    gen.println("xrt::mock::argument arg{{}};");
+    gen.println("arg.bytes.resize(sizeof(T));");
+    gen.println("std::memcpy(arg.bytes.data(), &value, sizeof(T));");
+    gen.println("run(runs, kernel).args[index] = std::move(arg);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("void set_buffer(runs_t &runs, "
+                                           "const std::string &kernel, "
+                                           "int index, "
+                                           "const std::vector<T> &values) {{");
+    gen.println("auto bo = std::make_shared<xrt::mock::buffer>();");
+    gen.println("bo->device.resize(values.size() * sizeof(T));");
+    gen.println("std::memcpy(bo->device.data(), values.data(), "
+                "bo->device.size());");
+    gen.println("run(runs, kernel).args[index] = {{bo, 0, bo->device.size(), "
+                "{{}}}};");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("std::vector<T> buffer(runs_t "
+                                           "&runs, const std::string "
+                                           "&kernel, int index) {{");
+    gen.println("const xrt::mock::argument &arg = "
+                "run(runs, kernel).args.at(index);");
+    gen.println("std::vector<T> values(arg.size / sizeof(T));");
+    gen.println("std::memcpy(values.data(), arg.bo->device.data(), "
+                "values.size() * sizeof(T));");
+    gen.println("return values;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("template <typename T>");
+    gen.println<generator::INCREASE_AFTER>("void set_parameter(const "
+                                           "std::string &port, T value) {{");
+    gen.println("std::vector<std::byte> bytes(sizeof(T));");
+    gen.println("std::memcpy(bytes.data(), &value, sizeof(T));");
+    gen.println("xrt::mock::parameters::set(port, std::move(bytes));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("/*");
+    gen.println(" * Elements sent over stream replica of replicas streams, "
+                "per_beat consecutive");
+    gen.println(" * elements per beat. Elements past length up to padded are "
+                "zero.");
+    gen.println(" */");
+    gen.println("template <typename T>");
+    gen.println("std::vector<T> split(const std::vector<T> &values, "
+                "std::uint64_t length,");
+    gen.println("                     std::uint64_t padded, unsigned "
+                "per_beat,");
+    gen.println<generator::INCREASE_AFTER>("                     unsigned "
+                                           "replicas, unsigned replica) {{");
+    gen.println("std::vector<T> stream;");
+    gen.println("const std::uint64_t beats = padded / (per_beat * replicas);");
+    gen.println<generator::INCREASE_AFTER>("for (std::uint64_t i = 0; "
+                                           "i < beats; i++) {{");
+    gen.println<generator::INCREASE_AFTER>("for (unsigned e = 0; "
+                                           "e < per_beat; e++) {{");
+    gen.println("const std::uint64_t index = (i * replicas + replica) * "
+                "per_beat + e;");
+    gen.println("stream.push_back(index < length ? values[index] : T{{}});");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("return stream;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    gen.println("// Values of a PLIO file, per_line values of a beat per "
+                "line");
+    gen.println("template <typename T>");
+    gen.println("void write_plio(const std::string &file, "
+                "const std::vector<T> &values,");
+    gen.println<generator::INCREASE_AFTER>("                unsigned "
+                                           "per_line) {{");
+    gen.println("std::ofstream out{{file}};");
+    gen.println<generator::INCREASE_AFTER>("for (std::size_t i = 0; "
+                                           "i < values.size(); i++) {{");
+    gen.println<generator::INCREASE_AFTER>("if constexpr (std::is_floating_"
+                                           "point_v<T>) {{");
+    gen.println("char text[32];");
+    gen.println("std::snprintf(text, sizeof(text), \"%.9g\", "
+                "static_cast<double>(values[i]));");
+    gen.println("out << text;");
+    gen.println<generator::DECREASE_BEFORE>("}} else if constexpr "
+                                            "(std::is_signed_v<T>) {{");
+    gen.indent_incr();
+    gen.println("out << static_cast<long long>(values[i]);");
+    gen.println<generator::DECREASE_BEFORE>("}} else {{");
+    gen.indent_incr();
+    gen.println("out << static_cast<unsigned long long>(values[i]);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("out << ((i + 1) % per_line == 0 || i + 1 == values.size() "
+                "? '\\n' : ' ');");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+/*
+ * Generate a program writing the stimulus of the input PLIOs of the graph
+ * to data/ and the expected output to data/golden/, for a problem size and
+ * random seed given on its command line. The expected output is computed by
+ * the CPU implementation of the design for the mock XRT backend
+ * (host/mock.cpp), the program is built against the mock backend as well.
+ */
+static void gen_sim_data(generator &gen) {
+    bool iterations = false;
+    for (const kernel &kernel : gen.get_data().kernels) {
+        iterations = iterations || !graph_iterations(gen, kernel).empty();
+    }
+
+    gen.println("#include <algorithm>");
+    gen.println("#include <cstdint>");
+    gen.println("#include <cstdio>");
+    gen.println("#include <cstring>");
+    gen.println("#include <filesystem>");
+    gen.println("#include <fstream>");
+    gen.println("#include <map>");
+    gen.println("#include <random>");
+    gen.println("#include <string>");
+    gen.println("#include <type_traits>");
+    gen.println("#include <vector>");
+    gen.println("#include <xrt/mock.h>");
+    gen.println();
+    gen.println("// Stimulus and golden output of the PLIOs of the graph for "
+                "aiesimulator");
+    gen.println("namespace {{");
+    gen.println();
+    gen_sim_helpers(gen, iterations);
+    gen.println();
+    gen.println("}} // anonymous namespace");
+    gen.println();
+    gen.println<generator::INCREASE_AFTER>("int main(int argc, char *argv[]) "
+                                           "{{");
+    gen.println<generator::INCREASE_AFTER>("if (argc < 2) {{");
+    gen.println("std::fprintf(stderr, \"Usage: %s <size> [<seed>]\\n\", "
+                "argv[0]);");
+    gen.println("return 1;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("const std::uint64_t problem_size = std::stoull(argv[1]);");
+    gen.println("const std::uint64_t seed = argc > 2 ? std::stoull(argv[2])");
+    gen.println("                                    : std::random_device{{}}"
+                "();");
+    gen.println("std::printf(\"Simulation data of size %llu, seed %llu\\n\",");
+    gen.println("            static_cast<unsigned long long>(problem_size),");
+    gen.println("            static_cast<unsigned long long>(seed));");
+    gen.println();
+    gen.println("std::mt19937_64 rng{{seed}};");
+    gen.println("std::filesystem::create_directories(\"data/golden\");");
+    gen.println("runs_t runs;");
+    if (!gen.get_data().persistent) {
+        gen.println("std::uint64_t iterations = 0;");
+    }
+    gen.println();
+    for (const kernel &kernel : gen.get_data().kernels) {
+        gen_sim_inputs(gen, kernel);
+    }
+    if (!gen.get_data().persistent) {
+        gen.println("// Read by the graph for the number of iterations to run");
+        gen.println("std::ofstream{{\"data/iterations.txt\"}} << "
+                    "std::max<std::uint64_t>(iterations, 1) << '\\n';");
+    }
+    gen.println();
+    gen.println("// Compute the golden output on the CPU");
+    gen.println<generator::INCREASE_AFTER>("for (const xrt::mock::"
+                                           "registered_routine &routine : "
+                                           "xrt::mock::routines()) {{");
+    gen.println("runs_t routine_runs;");
+    gen.println<generator::INCREASE_AFTER>("for (const std::string &kernel : "
+                                           "routine.kernels) {{");
+    gen.println("routine_runs.emplace(kernel, runs.at(kernel));");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println("xrt::mock::routine ctx{{routine_runs}};");
+    gen.println("routine.execute(ctx);");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+    gen.println();
+    for (const kernel &kernel : gen.get_data().kernels) {
+        gen_sim_outputs(gen, kernel);
+    }
+    gen.println();
+    gen.println("return 0;");
+    gen.println<generator::DECREASE_BEFORE>("}}");
+}
+
+std::string kernel_generator::get_graph_iterations() {
+    for (const pl_mover &mover : get_pl_movers()) {
+        for (const pl_port &port : mover.ports) {
+            if (port.type == pl_port_type::mem_to_stream && port.block > 1) {
+                return std::format("(({}) + {}) / {}", port.length,
+                                   port.block - 1, port.block);
+            }
+        }
+    }
+    return "";
+}
+
+void generator::generate_sim_data() {
+    fs::path sim_dir = out_dir / "sim";
+    util::create_dir(sim_dir);
+
+    this->open(sim_dir / "sim_data.cpp");
+    gen_sim_data(*this);
+    this->close();
+}
+
+} // codegen
+} // aieblas
@@ -11,6 +11,7 @@ namespace {
 struct arguments {
     fs::path json;
     fs::path output;
+    bool emit_sim_data;
 };
 
 inline void error(const std::string_view message) {
@@ -36,6 +37,8 @@ struct arguments parse_args(int argc, const char* const* argv) {
             ("output", "Output directory", cxxopts::value<std::string>())
             ("l,log-level", "Set the logging level",
              cxxopts::value<std::string>())
+            ("emit-sim-data", "Also generate sim/sim_data.cpp, writing "
+             "aiesimulator stimulus and golden output")
             ("h,help", "Print usage");
 
         options.positional_help("<json> <output>");
@@ -81,7 +84,8 @@ struct arguments parse_args(int argc, const char* const* argv) {
         }
 
         args = {fs::path(results["json"].as<std::string>()),
-                fs::path(results["output"].as<std::string>())};
+                fs::path(results["output"].as<std::string>()),
+                results.count("emit-sim-data") > 0};
 
         if (!fs::exists(args.json)) {
             error(std::format("File '{}' does not exist", args.json.string()));
@@ -123,9 +127,11 @@ struct arguments parse_args(int argc, const char* const* argv) {
 
 int main(int argc, char *argv[]) {
     struct arguments args = parse_args(argc, argv);
+    // Only log messages are printed from here on
+    aieblas::enable_async_log();
 
     // try {
-    cg::codegen(args.json, args.output);
+    cg::codegen(args.json, args.output, args.emit_sim_data);
     // } catch (const std::exception &e) {
     //     std::println("Codegen error: {}", e.what());
     // }
@@ -1,4 +1,11 @@
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 
 #include "aieblas/detail/util.hpp"
 #include "aieblas/detail/util/logging.hpp"
@@ -9,6 +16,11 @@ static log_level current_log_level = log_level::status;
 
 void set_log_level(log_level level) {
     current_log_level = level;
+    if (level < compiled_log_level) {
+        log(log_level::warning, "Log level {} is below the lowest compiled "
+            "level {}", log_level_to_str(level),
+            log_level_to_str(compiled_log_level));
+    }
 }
 
 log_level get_log_level() {
@@ -16,23 +28,214 @@ log_level get_log_level() {
 }
 
 std::string log_header(log_level level, const std::source_location& loc) {
+    // The time is only converted to local time when the minute changes, and
+    // the name of every source file is only made relative once
+    thread_local std::time_t minute = -1;
+    thread_local std::string time;
+    thread_local std::unordered_map<const char *, std::string> filenames;
+
     const auto now = std::chrono::system_clock::now();
     const std::time_t t_c = std::chrono::system_clock::to_time_t(now);
-    const std::tm &tm = *std::localtime(&t_c);
+    if (t_c / 60 != minute) {
+        std::tm tm;
+        localtime_r(&t_c, &tm);
+        time = std::format("[{:02}:{:02}] ", tm.tm_hour, tm.tm_min);
+        minute = t_c / 60;
+    }
 
-    std::string message = std::format("[{:02}:{:02}] ", tm.tm_hour, tm.tm_min);
+    std::string message = time;
     if (get_log_level() <= log_level::debug) {
-        std::error_code ec;
-        std::string_view filename = loc.file_name();
-        fs::path proximate = fs::proximate(filename, ec);
-        if (!ec) {
-            filename = proximate.native();
+        auto it = filenames.find(loc.file_name());
+        if (it == filenames.end()) {
+            std::error_code ec;
+            fs::path proximate = fs::proximate(loc.file_name(), ec);
+            it = filenames.emplace(loc.file_name(),
+                                   ec ? loc.file_name()
+                                      : proximate.native()).first;
         }
         message.append(std::format("{}:{} in {}: ",
-                                   filename, loc.line(), loc.function_name()));
+                                   it->second, loc.line(),
+                                   loc.function_name()));
     }
 
     return message;
 }
 
+namespace {
+/*
+ * Bounded queue of log lines for many producers and a single consumer,
+ * without locks. The sequence number of a cell tells whose turn it is: a
+ * producer claims the cell at tail when it equals tail, the consumer takes
+ * it when it equals head + 1.
+ */
+class log_queue {
+public:
+    explicit log_queue(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells = std::make_unique<cell[]>(size);
+        mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Position of the line in the queue, false if the queue is full
+    bool push(std::string &line, std::size_t &position) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            cell &c = cells[pos & mask];
+            const std::size_t seq = c.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (tail.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+                    c.line = std::move(line);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    position = pos;
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(std::string &line) {
+        cell &c = cells[head & mask];
+        if (c.seq.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        line = std::move(c.line);
+        c.seq.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+    // Lines claimed by producers so far
+    std::size_t pushed() const {
+        return tail.load(std::memory_order_acquire);
+    }
+
+private:
+    struct cell {
+        std::atomic<std::size_t> seq;
+        std::string line;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> tail = 0;
+    alignas(64) std::size_t head = 0;
+};
+
+class async_sink {
+public:
+    explicit async_sink(std::size_t capacity)
+        : queue(capacity), worker([this] { run(); }) { }
+
+    ~async_sink() {
+        stop.store(true, std::memory_order_release);
+        worker.join();
+    }
+
+    void write(log_level level, std::string &line) {
+        std::size_t position;
+        while (!queue.push(line, position)) {
+            std::this_thread::yield();
+        }
+        if (level >= log_level::warning) {
+            wait_written(position + 1);
+        }
+    }
+
+    void flush() {
+        wait_written(queue.pushed());
+    }
+
+private:
+    void wait_written(std::size_t lines) {
+        std::size_t done = written.load(std::memory_order_acquire);
+        while (done < lines) {
+            written.wait(done, std::memory_order_acquire);
+            done = written.load(std::memory_order_acquire);
+        }
+    }
+
+    // Write all queued lines at once, and sleep while there are none
+    void run() {
+        std::string batch, line;
+        std::size_t popped = 0;
+        while (true) {
+            const bool stopping = stop.load(std::memory_order_acquire);
+            while (queue.pop(line)) {
+                batch.append(line).push_back('\n');
+                popped++;
+            }
+            if (!batch.empty()) {
+                std::fwrite(batch.data(), 1, batch.size(), stdout);
+                std::fflush(stdout);
+                batch.clear();
+                written.store(popped, std::memory_order_release);
+                written.notify_all();
+            } else if (stopping) {
+                return;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    log_queue queue;
+    std::atomic<std::size_t> written = 0;
+    std::atomic<bool> stop = false;
+    std::thread worker;
+};
+
+std::unique_ptr<async_sink> sink;
+std::terminate_handler previous_terminate = nullptr;
+
+// Stops the sink at exit, after which messages are written directly
+struct sink_guard {
+    ~sink_guard() {
+        disable_async_log();
+    }
+} guard;
+} // namespace
+
+void enable_async_log(std::size_t capacity) {
+    if (sink) {
+        return;
+    }
+    sink = std::make_unique<async_sink>(capacity);
+    previous_terminate = std::set_terminate([] {
+        if (sink) {
+            sink->flush();
+        }
+        if (previous_terminate) {
+            previous_terminate();
+        }
+        std::abort();
+    });
+}
+
+void disable_async_log() {
+    if (!sink) {
+        return;
+    }
+    sink.reset();
+    std::set_terminate(previous_terminate);
+}
+
+void log_write(log_level level, std::string line) {
+    if (sink) {
+        sink->write(level, line);
+    } else {
+        std::println("{}", line);
+    }
+}
+
 } // namespace aieblas
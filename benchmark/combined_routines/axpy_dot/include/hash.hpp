@@ -0,0 +1 @@
+../../../../aieblas/include/aieblas/detail/util/hash.hpp
\ No newline at end of file
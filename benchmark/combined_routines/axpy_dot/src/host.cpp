@@ -197,8 +197,11 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    std::string name = "axpydot";
-    util::write_result_axpydot(name, args.size, exec_time);
+    // w, v and u are read, the result is written
+    util::write_result({.routine = "axpydot",
+                        .n = args.size,
+                        .times = {exec_time},
+                        .bytes = (3 * args.size + 1) * sizeof(std::int32_t)});
 
     std::int32_t result_benchmark;
     timer.time_point("start_cpu");
@@ -216,8 +216,12 @@ int main(int argc, char *argv[]) {
                  timer.time<milliseconds>("start", "mid").count(),
                  timer.time<milliseconds>("mid", "end").count());
 
-    std::string name = "axpydot_separate";
-    util::write_result_axpydot(name, args.size, exec_time);
+    // w, v and u are read, z is written and read back, the result is
+    // written
+    util::write_result({.routine = "axpydot_separate",
+                        .n = args.size,
+                        .times = {exec_time},
+                        .bytes = (5 * args.size + 1) * sizeof(std::int32_t)});
 
     std::int32_t result_benchmark;
     timer.time_point("start_cpu");
@@ -202,8 +202,12 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    std::string name = "sum_vectors";
-    util::write_result_sum(name, args.size, exec_time);
+    // every vector is read, the result is written
+    util::write_result({.routine = std::format("sum_vectors_{}", num_vectors),
+                        .n = args.size,
+                        .times = {exec_time},
+                        .bytes = (num_vectors + 1) * args.size *
+                                 sizeof(std::int32_t)});
 
     std::int32_t *result_benchmark = new std::int32_t[args.size];
     timer.time_point("start_cpu");
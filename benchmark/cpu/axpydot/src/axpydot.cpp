@@ -92,8 +92,12 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    std::string name = std::format("cpu_axpydot");
-    util::write_result_axpydot(name, args.size, exec_time);
+    // axpy reads w and v and writes v, dot reads w and u
+    util::write_result({.routine = "cpu_axpydot",
+                        .dtype = "float",
+                        .n = args.size,
+                        .times = {exec_time},
+                        .bytes = 5 * args.size * sizeof(float)});
 
     unsigned errors = 0;
 
@@ -0,0 +1 @@
+../../../../aieblas/include/aieblas/detail/util/cxx_compat.hpp
\ No newline at end of file
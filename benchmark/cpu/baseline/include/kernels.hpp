@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+namespace baseline {
+
+/*
+ * CPU kernels of every BLAS operation of aieblas, with the semantics of the
+ * mock backend: results are written out of place. A kernel works on a part
+ * of the data, the threads of a call each run it on their own part. The
+ * reductions return the result of their part, which the caller combines.
+ */
+template <typename T>
+struct kernels {
+    // sum of |x[i]|
+    T (*asum)(std::uint64_t n, const T *x);
+    // out = alpha * x + y
+    void (*axpy)(std::uint64_t n, T alpha, const T *x, const T *y, T *out);
+    // sum of x[i] * y[i]
+    T (*dot)(std::uint64_t n, const T *x, const T *y);
+    // out = alpha * A * x + beta * y, for rows of A with cols columns
+    void (*gemv)(std::uint64_t rows, std::uint64_t cols, T alpha, const T *A,
+                 const T *x, T beta, const T *y, T *out);
+    // index of the first largest |x[i]|
+    std::uint64_t (*iamax)(std::uint64_t n, const T *x);
+    // sum of x[i] * x[i], nrm2 is the square root of the combined sums
+    T (*sumsq)(std::uint64_t n, const T *x);
+    // out_x = c * x + s * y, out_y = c * y - s * x
+    void (*rot)(std::uint64_t n, T c, T s, const T *x, const T *y, T *out_x,
+                T *out_y);
+    // out = alpha * x
+    void (*scal)(std::uint64_t n, T alpha, const T *x, T *out);
+};
+
+// Plain loops, vectorized as far as the compiler does by itself
+template <typename T>
+kernels<T> loop_kernels();
+
+// Hand-vectorized kernels, only available if the CPU supports them
+template <typename T>
+kernels<T> avx2_kernels();
+template <typename T>
+kernels<T> avx512_kernels();
+
+bool has_avx2();
+bool has_avx512();
+
+} // namespace baseline
@@ -0,0 +1,196 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+#include "kernels.hpp"
+
+/*
+ * Kernels on the vector registers of an instruction set, described by a
+ * traits class V with the element type V::type, a register V::reg of
+ * V::lanes elements, a register V::ireg of as many 32-bit indices, and the
+ * operations used below. Elements after the last full register are handled
+ * by a scalar loop. Included by the translation unit of each instruction
+ * set, which is compiled with the flags enabling it.
+ */
+namespace baseline {
+namespace simd {
+
+template <class V>
+typename V::type scalar_abs(typename V::type a) {
+    return a < 0 ? -a : a;
+}
+
+template <class V>
+typename V::type asum(std::uint64_t n, const typename V::type *x) {
+    constexpr std::uint64_t lanes = V::lanes;
+    // Independent accumulators hide the latency of the additions
+    typename V::reg acc0 = V::zero(), acc1 = V::zero();
+    typename V::reg acc2 = V::zero(), acc3 = V::zero();
+    std::uint64_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes) {
+        acc0 = V::add(acc0, V::abs(V::load(x + i)));
+        acc1 = V::add(acc1, V::abs(V::load(x + i + lanes)));
+        acc2 = V::add(acc2, V::abs(V::load(x + i + 2 * lanes)));
+        acc3 = V::add(acc3, V::abs(V::load(x + i + 3 * lanes)));
+    }
+    for (; i + lanes <= n; i += lanes) {
+        acc0 = V::add(acc0, V::abs(V::load(x + i)));
+    }
+    typename V::type result = V::hsum(V::add(V::add(acc0, acc1),
+                                             V::add(acc2, acc3)));
+    for (; i < n; ++i) {
+        result += scalar_abs<V>(x[i]);
+    }
+    return result;
+}
+
+template <class V>
+void axpy(std::uint64_t n, typename V::type alpha,
+          const typename V::type *x, const typename V::type *y,
+          typename V::type *out) {
+    const typename V::reg a = V::set1(alpha);
+    std::uint64_t i = 0;
+    for (; i + V::lanes <= n; i += V::lanes) {
+        V::store(out + i, V::fmadd(a, V::load(x + i), V::load(y + i)));
+    }
+    for (; i < n; ++i) {
+        out[i] = alpha * x[i] + y[i];
+    }
+}
+
+template <class V>
+typename V::type dot(std::uint64_t n, const typename V::type *x,
+                     const typename V::type *y) {
+    constexpr std::uint64_t lanes = V::lanes;
+    typename V::reg acc0 = V::zero(), acc1 = V::zero();
+    typename V::reg acc2 = V::zero(), acc3 = V::zero();
+    std::uint64_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes) {
+        acc0 = V::fmadd(V::load(x + i), V::load(y + i), acc0);
+        acc1 = V::fmadd(V::load(x + i + lanes), V::load(y + i + lanes), acc1);
+        acc2 = V::fmadd(V::load(x + i + 2 * lanes),
+                        V::load(y + i + 2 * lanes), acc2);
+        acc3 = V::fmadd(V::load(x + i + 3 * lanes),
+                        V::load(y + i + 3 * lanes), acc3);
+    }
+    for (; i + lanes <= n; i += lanes) {
+        acc0 = V::fmadd(V::load(x + i), V::load(y + i), acc0);
+    }
+    typename V::type result = V::hsum(V::add(V::add(acc0, acc1),
+                                             V::add(acc2, acc3)));
+    for (; i < n; ++i) {
+        result += x[i] * y[i];
+    }
+    return result;
+}
+
+template <class V>
+void gemv(std::uint64_t rows, std::uint64_t cols, typename V::type alpha,
+          const typename V::type *A, const typename V::type *x,
+          typename V::type beta, const typename V::type *y,
+          typename V::type *out) {
+    for (std::uint64_t i = 0; i < rows; ++i) {
+        out[i] = alpha * dot<V>(cols, A + i * cols, x) + beta * y[i];
+    }
+}
+
+template <class V>
+std::uint64_t iamax(std::uint64_t n, const typename V::type *x) {
+    using T = typename V::type;
+    constexpr std::uint64_t lanes = V::lanes;
+    std::uint64_t index = 0;
+    T max = 0;
+    bool found = false;
+
+    // The indices in the registers are 32-bit, so blocks of at most 2^31
+    // elements are searched at a time
+    constexpr std::uint64_t block_size = std::uint64_t(1) << 31;
+    for (std::uint64_t block = 0; block < n; block += block_size) {
+        const T *xb = x + block;
+        const std::uint64_t nb = std::min(block_size, n - block);
+        std::uint64_t i = 0;
+        if (nb >= lanes) {
+            // Per lane the first largest value and its index
+            typename V::reg best = V::abs(V::load(xb));
+            typename V::ireg best_index = V::iota();
+            typename V::ireg cur_index = best_index;
+            const typename V::ireg step = V::iset1(lanes);
+            for (i = lanes; i + lanes <= nb; i += lanes) {
+                cur_index = V::iadd(cur_index, step);
+                const typename V::reg v = V::abs(V::load(xb + i));
+                const typename V::mask gt = V::gt(v, best);
+                best = V::select(gt, v, best);
+                best_index = V::iselect(gt, cur_index, best_index);
+            }
+
+            T values[lanes];
+            std::int32_t indices[lanes];
+            V::store(values, best);
+            V::istore(indices, best_index);
+            for (std::uint64_t lane = 0; lane < lanes; ++lane) {
+                const std::uint64_t idx = block + indices[lane];
+                if (!found || values[lane] > max ||
+                    (values[lane] == max && idx < index)) {
+                    max = values[lane];
+                    index = idx;
+                    found = true;
+                }
+            }
+        }
+        for (; i < nb; ++i) {
+            const T abs = scalar_abs<V>(xb[i]);
+            if (!found || abs > max) {
+                max = abs;
+                index = block + i;
+                found = true;
+            }
+        }
+    }
+    return index;
+}
+
+template <class V>
+typename V::type sumsq(std::uint64_t n, const typename V::type *x) {
+    return dot<V>(n, x, x);
+}
+
+template <class V>
+void rot(std::uint64_t n, typename V::type c, typename V::type s,
+         const typename V::type *x, const typename V::type *y,
+         typename V::type *out_x, typename V::type *out_y) {
+    const typename V::reg vc = V::set1(c);
+    const typename V::reg vs = V::set1(s);
+    std::uint64_t i = 0;
+    for (; i + V::lanes <= n; i += V::lanes) {
+        const typename V::reg vx = V::load(x + i);
+        const typename V::reg vy = V::load(y + i);
+        V::store(out_x + i, V::fmadd(vc, vx, V::mul(vs, vy)));
+        V::store(out_y + i, V::sub(V::mul(vc, vy), V::mul(vs, vx)));
+    }
+    for (; i < n; ++i) {
+        out_x[i] = c * x[i] + s * y[i];
+        out_y[i] = c * y[i] - s * x[i];
+    }
+}
+
+template <class V>
+void scal(std::uint64_t n, typename V::type alpha,
+          const typename V::type *x, typename V::type *out) {
+    const typename V::reg a = V::set1(alpha);
+    std::uint64_t i = 0;
+    for (; i + V::lanes <= n; i += V::lanes) {
+        V::store(out + i, V::mul(a, V::load(x + i)));
+    }
+    for (; i < n; ++i) {
+        out[i] = alpha * x[i];
+    }
+}
+
+template <class V>
+kernels<typename V::type> make_kernels() {
+    return {asum<V>, axpy<V>, dot<V>, gemv<V>, iamax<V>, sumsq<V>, rot<V>,
+            scal<V>};
+}
+
+} // namespace simd
+} // namespace baseline
@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <barrier>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace baseline {
+
+/*
+ * Threads that stay alive between calls, so a call only pays for waking
+ * them. The calling thread is thread 0 of a call.
+ */
+class thread_pool {
+public:
+    explicit thread_pool(unsigned threads)
+        : threads(threads), start(threads), done(threads) {
+        for (unsigned id = 1; id < threads; ++id) {
+            workers.emplace_back([this, id] {
+                while (true) {
+                    start.arrive_and_wait();
+                    if (stop) {
+                        return;
+                    }
+                    (*job)(id);
+                    done.arrive_and_wait();
+                }
+            });
+        }
+    }
+
+    ~thread_pool() {
+        stop = true;
+        start.arrive_and_wait();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    unsigned size() const {
+        return threads;
+    }
+
+    // Run fn(thread) on every thread and wait for all of them
+    void run(const std::function<void(unsigned)> &fn) {
+        job = &fn;
+        start.arrive_and_wait();
+        fn(0);
+        done.arrive_and_wait();
+    }
+
+private:
+    const unsigned threads;
+    std::barrier<> start;
+    std::barrier<> done;
+    std::vector<std::thread> workers;
+    const std::function<void(unsigned)> *job = nullptr;
+    bool stop = false;
+};
+
+/*
+ * Part [begin, end) of n elements of a thread. Parts start at a multiple of
+ * 16 elements, so threads do not write to the same cache line.
+ */
+inline std::pair<std::uint64_t, std::uint64_t>
+split(std::uint64_t n, unsigned thread, unsigned threads) {
+    constexpr std::uint64_t align = 16;
+    const std::uint64_t blocks = (n + align - 1) / align;
+    const std::uint64_t begin = blocks * thread / threads * align;
+    const std::uint64_t end = blocks * (thread + 1) / threads * align;
+    return {std::min(begin, n), std::min(end, n)};
+}
+
+} // namespace baseline
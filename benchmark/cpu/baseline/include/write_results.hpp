@@ -0,0 +1 @@
+../../../util/include/write_results.hpp
\ No newline at end of file
@@ -0,0 +1,517 @@
+#include <algorithm>
+#include <cblas.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cxxopts.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "cxx_compat.hpp"
+#include "kernels.hpp"
+#include "thread_pool.hpp"
+#include "write_results.hpp"
+
+using milliseconds = std::chrono::duration<double, std::milli>;
+
+namespace {
+
+enum class op { asum, axpy, dot, gemv, iamax, nrm2, rot, scal };
+enum class impl { loop, avx2, avx512, blas };
+
+constexpr op all_ops[] = {op::asum, op::axpy, op::dot, op::gemv, op::iamax,
+                          op::nrm2, op::rot, op::scal};
+constexpr impl all_impls[] = {impl::loop, impl::avx2, impl::avx512,
+                              impl::blas};
+
+// Columns of A, as in the gemv kernel of aieblas; the size is the rows
+constexpr std::uint64_t gemv_cols = 64;
+
+const char *op_name(op o) {
+    switch (o) {
+    case op::asum: return "asum";
+    case op::axpy: return "axpy";
+    case op::dot: return "dot";
+    case op::gemv: return "gemv";
+    case op::iamax: return "iamax";
+    case op::nrm2: return "nrm2";
+    case op::rot: return "rot";
+    case op::scal: return "scal";
+    }
+    return "unknown";
+}
+
+const char *impl_name(impl i) {
+    switch (i) {
+    case impl::loop: return "loop";
+    case impl::avx2: return "avx2";
+    case impl::avx512: return "avx512";
+    case impl::blas: return "blas";
+    }
+    return "unknown";
+}
+
+// Elements read and written per element (per row for gemv)
+double elements_moved(op o) {
+    switch (o) {
+    case op::asum:
+    case op::iamax:
+    case op::nrm2: return 1;
+    case op::dot:
+    case op::scal: return 2;
+    case op::axpy: return 3;
+    case op::rot: return 4;
+    case op::gemv: return gemv_cols + 2;
+    }
+    return 0;
+}
+
+// Arithmetic operations per element (per row for gemv)
+double ops_per_element(op o) {
+    switch (o) {
+    case op::asum:
+    case op::iamax:
+    case op::scal: return 1;
+    case op::axpy:
+    case op::dot:
+    case op::nrm2: return 2;
+    case op::rot: return 6;
+    case op::gemv: return 2 * gemv_cols + 3;
+    }
+    return 0;
+}
+
+struct arguments {
+    std::vector<op> ops;
+    std::vector<std::string> types;
+    std::vector<impl> impls;
+    std::vector<unsigned> threads;
+    std::uint64_t min;
+    std::uint64_t max;
+    // sizes grow by step, or are multiplied by it
+    std::uint64_t step;
+    bool multiply;
+    unsigned warmup;
+    unsigned repeat;
+};
+
+inline void error(const std::string_view message) {
+    std::println("Argument error: {}", message);
+    std::fflush(stdout);
+    exit(1);
+}
+
+struct arguments parse_args(int argc, const char* const* argv) {
+    struct arguments args;
+    try {
+        cxxopts::Options options("bench",
+                                 "CPU baselines of the aieblas routines");
+
+        options.add_options()
+            ("r,routine", "Routines to run (asum, axpy, dot, gemv, iamax, "
+             "nrm2, rot, scal), default all",
+             cxxopts::value<std::vector<std::string>>())
+            ("t,type", "Types to run (float, int32)",
+             cxxopts::value<std::vector<std::string>>()->default_value(
+                "float,int32"))
+            ("i,impl", "Implementations to run (loop, avx2, avx512, blas), "
+             "default all the CPU supports",
+             cxxopts::value<std::vector<std::string>>())
+            ("j,threads", "Thread counts, default powers of two up to the "
+             "number of hardware threads",
+             cxxopts::value<std::vector<unsigned>>())
+            ("min", "Smallest size", cxxopts::value<std::uint64_t>()
+             ->default_value("1024"))
+            ("max", "Largest size", cxxopts::value<std::uint64_t>()
+             ->default_value("1048576"))
+            ("step", "Size step, n to add n or xn to multiply by n",
+             cxxopts::value<std::string>()->default_value("x2"))
+            ("warmup", "Untimed calls per size",
+             cxxopts::value<unsigned>()->default_value("2"))
+            ("repeat", "Timed calls per size",
+             cxxopts::value<unsigned>()->default_value("20"))
+            ("h,help", "Print usage");
+
+        auto results = options.parse(argc, argv);
+
+        if (results.count("help")) {
+            std::println("{}", options.help());
+            std::fflush(stdout);
+            exit(0);
+        }
+
+        if (results.count("routine")) {
+            for (const std::string &name :
+                 results["routine"].as<std::vector<std::string>>()) {
+                const auto it = std::find_if(
+                    std::begin(all_ops), std::end(all_ops),
+                    [&](op o) { return name == op_name(o); });
+                if (it == std::end(all_ops)) {
+                    error(std::format("unknown routine '{}'", name));
+                }
+                args.ops.push_back(*it);
+            }
+        } else {
+            args.ops.assign(std::begin(all_ops), std::end(all_ops));
+        }
+
+        args.types = results["type"].as<std::vector<std::string>>();
+        for (const std::string &type : args.types) {
+            if (type != "float" && type != "int32") {
+                error(std::format("unsupported type '{}'", type));
+            }
+        }
+
+        if (results.count("impl")) {
+            for (const std::string &name :
+                 results["impl"].as<std::vector<std::string>>()) {
+                const auto it = std::find_if(
+                    std::begin(all_impls), std::end(all_impls),
+                    [&](impl i) { return name == impl_name(i); });
+                if (it == std::end(all_impls)) {
+                    error(std::format("unknown implementation '{}'", name));
+                }
+                args.impls.push_back(*it);
+            }
+        } else {
+            args.impls.assign(std::begin(all_impls), std::end(all_impls));
+        }
+
+        if (results.count("threads")) {
+            args.threads = results["threads"].as<std::vector<unsigned>>();
+        } else {
+            const unsigned hw = std::max(1u,
+                                         std::thread::hardware_concurrency());
+            for (unsigned t = 1; t < hw; t *= 2) {
+                args.threads.push_back(t);
+            }
+            args.threads.push_back(hw);
+        }
+        for (unsigned t : args.threads) {
+            if (t == 0) {
+                error("thread counts must be positive");
+            }
+        }
+
+        args.min = results["min"].as<std::uint64_t>();
+        args.max = results["max"].as<std::uint64_t>();
+        std::string step = results["step"].as<std::string>();
+        args.multiply = step.starts_with("x");
+        if (args.multiply) {
+            step = step.substr(1);
+        }
+        args.step = std::stoull(step);
+        if (args.min == 0 || args.min > args.max) {
+            error("expected 0 < min <= max");
+        } else if (args.step == 0 || (args.multiply && args.step == 1)) {
+            error(std::format("invalid step '{}'",
+                              results["step"].as<std::string>()));
+        }
+
+        args.warmup = results["warmup"].as<unsigned>();
+        args.repeat = results["repeat"].as<unsigned>();
+        if (args.repeat == 0) {
+            error("repeat must be at least 1");
+        }
+    } catch (const std::exception &e) {
+        error(std::format("Unexpected exception: {}", e.what()));
+    }
+
+    return args;
+}
+
+/*
+ * Inputs and outputs of a routine. The values are small integers, so
+ * floating point sums are exact and all implementations agree. x has a
+ * single largest |x[i]| for iamax.
+ */
+template <typename T>
+struct problem {
+    std::uint64_t size;
+    std::vector<T> x, y, A, out_x, out_y;
+    T alpha = 2;
+    T beta = 1;
+    T c;
+    T s;
+
+    explicit problem(std::uint64_t size)
+        : size(size), x(std::max(size, gemv_cols)), y(size),
+          A(size * gemv_cols), out_x(size), out_y(size) {
+        for (std::uint64_t i = 0; i < x.size(); ++i) {
+            x[i] = static_cast<T>(static_cast<int>(i % 7) - 3);
+        }
+        x[size * 2 / 3] = 100;
+        for (std::uint64_t i = 0; i < size; ++i) {
+            y[i] = static_cast<T>(static_cast<int>(i % 5) - 2);
+        }
+        for (std::uint64_t i = 0; i < A.size(); ++i) {
+            A[i] = static_cast<T>(static_cast<int>(i % 3) - 1);
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            // A rotation, so repeated calls of BLAS in place stay bounded
+            c = 0.6f;
+            s = 0.8f;
+        } else {
+            c = 3;
+            s = 1;
+        }
+    }
+};
+
+/*
+ * Run a routine on the threads of a pool, each on its part of the data.
+ * Returns the result of a reduction, the index for iamax.
+ */
+template <typename T>
+double run(op o, const baseline::kernels<T> &k, baseline::thread_pool &pool,
+           problem<T> &p) {
+    const unsigned threads = pool.size();
+    std::vector<T> partial(threads, 0);
+    std::vector<std::uint64_t> index(threads, p.size);
+    pool.run([&](unsigned t) {
+        const auto [begin, end] = baseline::split(p.size, t, threads);
+        const std::uint64_t n = end - begin;
+        if (n == 0) {
+            return;
+        }
+        const T *x = p.x.data() + begin;
+        const T *y = p.y.data() + begin;
+        T *out_x = p.out_x.data() + begin;
+        T *out_y = p.out_y.data() + begin;
+        switch (o) {
+        case op::asum: partial[t] = k.asum(n, x); break;
+        case op::axpy: k.axpy(n, p.alpha, x, y, out_x); break;
+        case op::dot: partial[t] = k.dot(n, x, y); break;
+        case op::gemv:
+            k.gemv(n, gemv_cols, p.alpha, p.A.data() + begin * gemv_cols,
+                   p.x.data(), p.beta, y, out_x);
+            break;
+        case op::iamax: index[t] = begin + k.iamax(n, x); break;
+        case op::nrm2: partial[t] = k.sumsq(n, x); break;
+        case op::rot: k.rot(n, p.c, p.s, x, y, out_x, out_y); break;
+        case op::scal: k.scal(n, p.alpha, x, out_x); break;
+        }
+    });
+
+    T sum = 0;
+    for (T part : partial) {
+        sum += part;
+    }
+    if (o == op::nrm2) {
+        return std::sqrt(static_cast<double>(sum));
+    } else if (o == op::iamax) {
+        // The first part with the largest value has the first index
+        std::uint64_t best = index[0];
+        for (std::uint64_t i : index) {
+            if (i < p.size && std::abs(p.x[i]) > std::abs(p.x[best])) {
+                best = i;
+            }
+        }
+        return static_cast<double>(best);
+    }
+    return static_cast<double>(sum);
+}
+
+/*
+ * BLAS works in place, so the outputs hold the operands that are updated
+ * before the first call. Later calls update them again.
+ */
+void prepare_blas(op o, problem<float> &p) {
+    if (o == op::axpy || o == op::gemv) {
+        std::copy(p.y.begin(), p.y.end(), p.out_x.begin());
+    } else if (o == op::rot || o == op::scal) {
+        std::copy(p.x.begin(), p.x.begin() + p.size, p.out_x.begin());
+        std::copy(p.y.begin(), p.y.end(), p.out_y.begin());
+    }
+}
+
+double run_blas(op o, problem<float> &p) {
+    const blasint n = static_cast<blasint>(p.size);
+    switch (o) {
+    case op::asum: return cblas_sasum(n, p.x.data(), 1);
+    case op::axpy:
+        cblas_saxpy(n, p.alpha, p.x.data(), 1, p.out_x.data(), 1);
+        break;
+    case op::dot: return cblas_sdot(n, p.x.data(), 1, p.y.data(), 1);
+    case op::gemv:
+        cblas_sgemv(CblasRowMajor, CblasNoTrans, n, gemv_cols, p.alpha,
+                    p.A.data(), gemv_cols, p.x.data(), 1, p.beta,
+                    p.out_x.data(), 1);
+        break;
+    case op::iamax: return static_cast<double>(cblas_isamax(n, p.x.data(), 1));
+    case op::nrm2: return cblas_snrm2(n, p.x.data(), 1);
+    case op::rot:
+        cblas_srot(n, p.out_x.data(), 1, p.out_y.data(), 1, p.c, p.s);
+        break;
+    case op::scal: cblas_sscal(n, p.alpha, p.out_x.data(), 1); break;
+    }
+    return 0;
+}
+
+template <typename T>
+bool available(impl i) {
+    switch (i) {
+    case impl::loop: return true;
+#ifdef BASELINE_X86
+    case impl::avx2: return baseline::has_avx2();
+    case impl::avx512: return baseline::has_avx512();
+#else
+    case impl::avx2:
+    case impl::avx512: return false;
+#endif
+    case impl::blas: return std::is_same_v<T, float>;
+    }
+    return false;
+}
+
+template <typename T>
+baseline::kernels<T> get_kernels(impl i) {
+#ifdef BASELINE_X86
+    if (i == impl::avx2) {
+        return baseline::avx2_kernels<T>();
+    } else if (i == impl::avx512) {
+        return baseline::avx512_kernels<T>();
+    }
+#endif
+    return baseline::loop_kernels<T>();
+}
+
+// Compare the outputs of an implementation with those of the plain loops
+template <typename T>
+bool check(op o, const problem<T> &p, double value, const problem<T> &ref,
+           double ref_value) {
+    const auto close = [](double a, double b) {
+        return std::abs(a - b) <= 1e-4 * std::max(1.0, std::abs(b));
+    };
+    switch (o) {
+    case op::asum:
+    case op::dot:
+    case op::iamax:
+    case op::nrm2: return close(value, ref_value);
+    case op::rot:
+        for (std::uint64_t i = 0; i < p.size; ++i) {
+            if (!close(p.out_y[i], ref.out_y[i])) {
+                return false;
+            }
+        }
+        [[fallthrough]];
+    case op::axpy:
+    case op::gemv:
+    case op::scal:
+        for (std::uint64_t i = 0; i < p.size; ++i) {
+            if (!close(p.out_x[i], ref.out_x[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T>
+unsigned run_impl(const arguments &args, const std::string &type, impl i,
+                  std::vector<std::unique_ptr<baseline::thread_pool>> &pools) {
+    baseline::thread_pool single(1);
+    const baseline::kernels<T> k = get_kernels<T>(i);
+    unsigned errors = 0;
+    for (op o : args.ops) {
+        for (std::uint64_t size = args.min; size <= args.max;
+             size = args.multiply ? size * args.step : size + args.step) {
+            problem<T> ref(size);
+            const double ref_value = run(o, baseline::loop_kernels<T>(),
+                                         single, ref);
+            problem<T> p(size);
+
+            for (const std::unique_ptr<baseline::thread_pool> &pool : pools) {
+                std::function<double()> call = [&] {
+                    return run(o, k, *pool, p);
+                };
+                if constexpr (std::is_same_v<T, float>) {
+                    if (i == impl::blas) {
+                        // OpenBLAS uses its own threads
+                        openblas_set_num_threads(pool->size());
+                        prepare_blas(o, p);
+                        call = [&] { return run_blas(o, p); };
+                    }
+                }
+
+                const bool ok = check(o, p, call(), ref, ref_value);
+                for (unsigned w = 0; w < args.warmup; ++w) {
+                    call();
+                }
+                std::vector<double> times;
+                for (unsigned r = 0; r < args.repeat; ++r) {
+                    const auto start = std::chrono::steady_clock::now();
+                    call();
+                    const auto end = std::chrono::steady_clock::now();
+                    times.push_back(milliseconds(end - start).count());
+                }
+
+                const std::uint64_t bytes = static_cast<std::uint64_t>(
+                    elements_moved(o) * size * sizeof(T));
+                const util::time_stats stats = util::get_stats(times);
+                std::println("{:<6} {:<6} {:<7} {:>7} {:>10} "
+                             "{:>12.2f} {:>9.2f} {:>9.2f} {}",
+                             op_name(o), type, impl_name(i), pool->size(),
+                             size, stats.median * 1000,
+                             bytes / (stats.median * 1e6),
+                             ops_per_element(o) * size /
+                             (stats.median * 1e6),
+                             ok ? "ok" : "WRONG");
+                errors += !ok;
+
+                util::result result{
+                    .routine = std::format("cpu_{}_{}_t{}", op_name(o),
+                                           impl_name(i), pool->size()),
+                    .dtype = type,
+                    .n = o == op::gemv ? gemv_cols : size,
+                    .m = o == op::gemv ? size : 0,
+                    .times = times,
+                    .bytes = bytes};
+                util::write_result(result);
+            }
+            if (args.multiply && size > args.max / args.step) {
+                break;
+            }
+        }
+    }
+    return errors;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    struct arguments args = parse_args(argc, argv);
+
+    std::vector<std::unique_ptr<baseline::thread_pool>> pools;
+    for (unsigned t : args.threads) {
+        pools.push_back(std::make_unique<baseline::thread_pool>(t));
+    }
+
+    std::println("{:<6} {:<6} {:<7} {:>7} {:>10} {:>12} {:>9} {:>9} {}",
+                 "op", "type", "impl", "threads", "size", "median(us)",
+                 "GB/s", "Gop/s", "check");
+    // Idle OpenBLAS threads keep spinning for a while after a call, taking
+    // cores from the other implementations, so BLAS runs last
+    std::vector<impl> impls = args.impls;
+    std::stable_partition(impls.begin(), impls.end(),
+                          [](impl i) { return i != impl::blas; });
+
+    unsigned errors = 0;
+    for (impl i : impls) {
+        for (const std::string &type : args.types) {
+            if (type == "float" && available<float>(i)) {
+                errors += run_impl<float>(args, type, i, pools);
+            } else if (type == "int32" && available<std::int32_t>(i)) {
+                errors += run_impl<std::int32_t>(args, type, i, pools);
+            }
+        }
+    }
+
+    if (errors != 0) {
+        std::println("{} results differ from the plain loops!", errors);
+    }
+    return errors == 0 ? 0 : 1;
+}
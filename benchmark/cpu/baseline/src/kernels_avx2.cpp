@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <immintrin.h>
+
+#include "kernels.hpp"
+#include "simd_kernels.hpp"
+
+// Compiled with -mavx2 -mfma, only called if the CPU supports both
+
+namespace baseline {
+namespace {
+
+struct avx2_f32 {
+    using type = float;
+    using reg = __m256;
+    using ireg = __m256i;
+    using mask = __m256;
+    static constexpr unsigned lanes = 8;
+
+    static reg load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, reg a) { _mm256_storeu_ps(p, a); }
+    static reg set1(float a) { return _mm256_set1_ps(a); }
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+    static reg abs(reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+    static float hsum(reg a) {
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(a),
+                                _mm256_extractf128_ps(a, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+        return _mm_cvtss_f32(sum);
+    }
+
+    static mask gt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static reg select(mask m, reg a, reg b) {
+        return _mm256_blendv_ps(b, a, m);
+    }
+    static ireg iselect(mask m, ireg a, ireg b) {
+        return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m));
+    }
+    static ireg iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static ireg iset1(std::int32_t a) { return _mm256_set1_epi32(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm256_add_epi32(a, b); }
+    static void istore(std::int32_t *p, ireg a) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+    }
+};
+
+struct avx2_i32 {
+    using type = std::int32_t;
+    using reg = __m256i;
+    using ireg = __m256i;
+    using mask = __m256i;
+    static constexpr unsigned lanes = 8;
+
+    static reg load(const std::int32_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static void store(std::int32_t *p, reg a) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+    }
+    static reg set1(std::int32_t a) { return _mm256_set1_epi32(a); }
+    static reg zero() { return _mm256_setzero_si256(); }
+    static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_epi32(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mullo_epi32(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return add(mul(a, b), c); }
+    static reg abs(reg a) { return _mm256_abs_epi32(a); }
+
+    static std::int32_t hsum(reg a) {
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(a),
+                                    _mm256_extracti128_si256(a, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+        return _mm_cvtsi128_si32(sum);
+    }
+
+    static mask gt(reg a, reg b) { return _mm256_cmpgt_epi32(a, b); }
+    static reg select(mask m, reg a, reg b) {
+        return _mm256_blendv_epi8(b, a, m);
+    }
+    static ireg iselect(mask m, ireg a, ireg b) { return select(m, a, b); }
+    static ireg iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static ireg iset1(std::int32_t a) { return _mm256_set1_epi32(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm256_add_epi32(a, b); }
+    static void istore(std::int32_t *p, ireg a) { store(p, a); }
+};
+
+} // namespace
+
+bool has_avx2() {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+template <>
+kernels<float> avx2_kernels<float>() {
+    return simd::make_kernels<avx2_f32>();
+}
+
+template <>
+kernels<std::int32_t> avx2_kernels<std::int32_t>() {
+    return simd::make_kernels<avx2_i32>();
+}
+
+} // namespace baseline
@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <immintrin.h>
+
+#include "kernels.hpp"
+#include "simd_kernels.hpp"
+
+/*
+ * Compiled with -mavx512f, only called if the CPU supports it. Horizontal
+ * sums go through memory and abs is masked, as _mm512_reduce_add_* and
+ * _mm512_abs_epi32 warn about undefined registers with GCC 12.
+ */
+
+namespace baseline {
+namespace {
+
+struct avx512_f32 {
+    using type = float;
+    using reg = __m512;
+    using ireg = __m512i;
+    using mask = __mmask16;
+    static constexpr unsigned lanes = 16;
+
+    static reg load(const float *p) { return _mm512_loadu_ps(p); }
+    static void store(float *p, reg a) { _mm512_storeu_ps(p, a); }
+    static reg set1(float a) { return _mm512_set1_ps(a); }
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+    static reg abs(reg a) { return _mm512_abs_ps(a); }
+    static float hsum(reg a) {
+        float v[lanes];
+        store(v, a);
+        float sum = 0;
+        for (float x : v) {
+            sum += x;
+        }
+        return sum;
+    }
+
+    static mask gt(reg a, reg b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);
+    }
+    static reg select(mask m, reg a, reg b) {
+        return _mm512_mask_blend_ps(m, b, a);
+    }
+    static ireg iselect(mask m, ireg a, ireg b) {
+        return _mm512_mask_blend_epi32(m, b, a);
+    }
+    static ireg iota() {
+        return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                 13, 14, 15);
+    }
+    static ireg iset1(std::int32_t a) { return _mm512_set1_epi32(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm512_add_epi32(a, b); }
+    static void istore(std::int32_t *p, ireg a) {
+        _mm512_storeu_si512(p, a);
+    }
+};
+
+struct avx512_i32 {
+    using type = std::int32_t;
+    using reg = __m512i;
+    using ireg = __m512i;
+    using mask = __mmask16;
+    static constexpr unsigned lanes = 16;
+
+    static reg load(const std::int32_t *p) { return _mm512_loadu_si512(p); }
+    static void store(std::int32_t *p, reg a) { _mm512_storeu_si512(p, a); }
+    static reg set1(std::int32_t a) { return _mm512_set1_epi32(a); }
+    static reg zero() { return _mm512_setzero_si512(); }
+    static reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_epi32(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mullo_epi32(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return add(mul(a, b), c); }
+    static reg abs(reg a) { return _mm512_maskz_abs_epi32(0xffff, a); }
+
+    static std::int32_t hsum(reg a) {
+        std::int32_t v[lanes];
+        store(v, a);
+        std::int32_t sum = 0;
+        for (std::int32_t x : v) {
+            sum += x;
+        }
+        return sum;
+    }
+
+    static mask gt(reg a, reg b) { return _mm512_cmpgt_epi32_mask(a, b); }
+    static reg select(mask m, reg a, reg b) {
+        return _mm512_mask_blend_epi32(m, b, a);
+    }
+    static ireg iselect(mask m, ireg a, ireg b) { return select(m, a, b); }
+    static ireg iota() { return avx512_f32::iota(); }
+    static ireg iset1(std::int32_t a) { return _mm512_set1_epi32(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm512_add_epi32(a, b); }
+    static void istore(std::int32_t *p, ireg a) { store(p, a); }
+};
+
+} // namespace
+
+bool has_avx512() {
+    return __builtin_cpu_supports("avx512f");
+}
+
+template <>
+kernels<float> avx512_kernels<float>() {
+    return simd::make_kernels<avx512_f32>();
+}
+
+template <>
+kernels<std::int32_t> avx512_kernels<std::int32_t>() {
+    return simd::make_kernels<avx512_i32>();
+}
+
+} // namespace baseline
@@ -0,0 +1,95 @@
+#include <cstdint>
+
+#include "kernels.hpp"
+
+namespace baseline {
+namespace {
+
+template <typename T>
+T abs(T a) {
+    return a < 0 ? -a : a;
+}
+
+template <typename T>
+T asum(std::uint64_t n, const T *x) {
+    T result = 0;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        result += abs(x[i]);
+    }
+    return result;
+}
+
+template <typename T>
+void axpy(std::uint64_t n, T alpha, const T *x, const T *y, T *out) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        out[i] = alpha * x[i] + y[i];
+    }
+}
+
+template <typename T>
+T dot(std::uint64_t n, const T *x, const T *y) {
+    T result = 0;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        result += x[i] * y[i];
+    }
+    return result;
+}
+
+template <typename T>
+void gemv(std::uint64_t rows, std::uint64_t cols, T alpha, const T *A,
+          const T *x, T beta, const T *y, T *out) {
+    for (std::uint64_t i = 0; i < rows; ++i) {
+        T row = 0;
+        for (std::uint64_t j = 0; j < cols; ++j) {
+            row += A[i * cols + j] * x[j];
+        }
+        out[i] = alpha * row + beta * y[i];
+    }
+}
+
+template <typename T>
+std::uint64_t iamax(std::uint64_t n, const T *x) {
+    std::uint64_t index = 0;
+    T max = 0;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        if (i == 0 || abs(x[i]) > max) {
+            max = abs(x[i]);
+            index = i;
+        }
+    }
+    return index;
+}
+
+template <typename T>
+T sumsq(std::uint64_t n, const T *x) {
+    return dot(n, x, x);
+}
+
+template <typename T>
+void rot(std::uint64_t n, T c, T s, const T *x, const T *y, T *out_x,
+         T *out_y) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        out_x[i] = c * x[i] + s * y[i];
+        out_y[i] = c * y[i] - s * x[i];
+    }
+}
+
+template <typename T>
+void scal(std::uint64_t n, T alpha, const T *x, T *out) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+        out[i] = alpha * x[i];
+    }
+}
+
+} // namespace
+
+template <typename T>
+kernels<T> loop_kernels() {
+    return {asum<T>, axpy<T>, dot<T>, gemv<T>, iamax<T>, sumsq<T>, rot<T>,
+            scal<T>};
+}
+
+template kernels<float> loop_kernels<float>();
+template kernels<std::int32_t> loop_kernels<std::int32_t>();
+
+} // namespace baseline
@@ -107,8 +107,14 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    std::string name = std::format("cpu_gemv");
-    util::write_result_gemv(name, args.size, exec_time);
+    // A, x and y are read, y is written
+    util::write_result({.routine = "cpu_gemv",
+                        .dtype = "float",
+                        .n = n,
+                        .m = args.size,
+                        .times = {exec_time},
+                        .bytes = (args.size * n + n + 2 * args.size) *
+                                 sizeof(float)});
 
     unsigned errors = 0;
 
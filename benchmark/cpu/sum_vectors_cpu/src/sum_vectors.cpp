@@ -109,13 +109,15 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    if (args.axpy) {
-        std::string name = "cpu_axpy";
-        util::write_result_axpy(name, args.size, exec_time);
-    } else {
-        std::string name = std::format("cpu_sum_vectors_{}", args.num_vectors);
-        util::write_result_sum(name, args.size, exec_time);
-    }
+    // every axpy reads two vectors and writes one
+    util::write_result({.routine = args.axpy ? std::string("cpu_axpy")
+                                             : std::format("cpu_sum_vectors_{}",
+                                                           args.num_vectors),
+                        .dtype = "float",
+                        .n = args.size,
+                        .times = {exec_time},
+                        .bytes = 3 * (args.num_vectors - 1) * args.size *
+                                 sizeof(float)});
 
     unsigned errors = 0;
 
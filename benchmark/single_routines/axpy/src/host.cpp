@@ -190,12 +190,11 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    std::string name = "axpy";
-    if (args.axpy) {
-        util::write_result_axpy(name, args.size, exec_time);
-    } else {
-        util::write_result_sum(name, args.size, exec_time);
-    }
+    // x and y are read, the result is written
+    util::write_result({.routine = args.axpy ? "axpy" : "sum_vectors_2",
+                        .n = args.size,
+                        .times = {exec_time},
+                        .bytes = 3 * args.size * sizeof(std::int32_t)});
 
     std::int32_t *result_benchmark = new std::int32_t[args.size];
     timer.time_point("start_cpu");
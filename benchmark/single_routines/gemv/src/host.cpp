@@ -217,8 +217,13 @@ int main(int argc, char *argv[]) {
 
     std::println("Execution finished in {:.2f} ms!", exec_time);
 
-    std::string name = "gemv";
-    util::write_result_gemv(name, args.size, exec_time);
+    // A, x and y are read, the result is written
+    util::write_result({.routine = "gemv",
+                        .n = n,
+                        .m = args.size,
+                        .times = {exec_time},
+                        .bytes = (args.size * n + n + 2 * args.size) *
+                                 sizeof(std::int32_t)});
 
     if (state_mm2s_A == ERT_CMD_STATE_TIMEOUT) {
         std::println("Warning: mm2s_A timed out!");
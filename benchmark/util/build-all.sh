@@ -23,6 +23,11 @@ cd axpydot && \
 cmake -DCMAKE_BUILD_TYPE=Release -Bbuild && \
 cd build && \
 make && \
+cd ../.. && \
+cd baseline && \
+cmake -DCMAKE_BUILD_TYPE=Release -Bbuild && \
+cd build && \
+make && \
 cd ../../.. && \
 cd single_routines && \
 cd axpy && \
@@ -0,0 +1,32 @@
+# Pass the design JSON of a benchmark to write_results.hpp, together with the
+# type, vector size and window size of its first kernel.
+function(aieblas_design_info target design)
+    if (NOT EXISTS ${design})
+        message(WARNING "Design ${design} not found, results will not record it")
+        return()
+    endif ()
+    # Rerun CMake when the design changes, so its hash stays current
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${design})
+
+    file(READ ${design} design_json)
+    string(JSON type ERROR_VARIABLE error
+           GET ${design_json} kernels 0 type)
+    string(JSON vsize ERROR_VARIABLE error
+           GET ${design_json} kernels 0 vector_size)
+    if (error)
+        set(vsize 0)
+    endif ()
+    string(JSON wsize ERROR_VARIABLE error
+           GET ${design_json} kernels 0 window_size)
+    if (error)
+        # Default window size of the code generator
+        set(wsize 128)
+    endif ()
+
+    target_compile_definitions(${target} PRIVATE
+        AIEBLAS_DESIGN_JSON="${design}"
+        AIEBLAS_DESIGN_TYPE="${type}"
+        AIEBLAS_DESIGN_VSIZE=${vsize}
+        AIEBLAS_DESIGN_WSIZE=${wsize}
+    )
+endfunction()
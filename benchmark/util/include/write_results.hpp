@@ -1,11 +1,40 @@
 #pragma once
 
 #include "cxx_compat.hpp"
+#include "hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
+/*
+ * Benchmark results are appended to results/results.jsonl, one JSON object
+ * per line. The design of a benchmark is identified by a hash of its JSON
+ * file, which util/cmake/design_info.cmake passes in AIEBLAS_DESIGN_JSON,
+ * together with the type, vector size and window size of its first kernel.
+ */
+#ifndef AIEBLAS_DESIGN_JSON
+#define AIEBLAS_DESIGN_JSON ""
+#endif
+#ifndef AIEBLAS_DESIGN_TYPE
+#define AIEBLAS_DESIGN_TYPE ""
+#endif
+#ifndef AIEBLAS_DESIGN_VSIZE
+#define AIEBLAS_DESIGN_VSIZE 0
+#endif
+#ifndef AIEBLAS_DESIGN_WSIZE
+#define AIEBLAS_DESIGN_WSIZE 0
+#endif
+
 namespace util {
 
 static inline fs::path get_bench_dir() {
@@ -17,42 +46,195 @@ static inline fs::path get_bench_dir() {
     return dir;
 }
 
-static inline void write_results(fs::path &result_file, std::string &name,
-                                 std::uint64_t size, double time) {
-    std::ofstream result_stream;
-    if (!fs::exists(result_file)) {
-        result_stream = std::ofstream(result_file.c_str());
-        std::println(result_stream, "name;size;time (ms)");
-    } else {
-        result_stream = std::ofstream(result_file.c_str(), std::ios::app);
+static inline const char *get_backend() {
+#if __has_include(<xrt/mock.h>)
+    return "mock";
+#elif __has_include(<xrt/xrt_bo.h>)
+    return "xrt";
+#else
+    return "cpu";
+#endif
+}
+
+struct phase_times {
+    double alloc = 0;
+    double sync_in = 0;
+    double run = 0;
+    double sync_out = 0;
+};
+
+struct result {
+    std::string routine;
+    std::string dtype = AIEBLAS_DESIGN_TYPE;
+    unsigned vsize = AIEBLAS_DESIGN_VSIZE;
+    unsigned wsize = AIEBLAS_DESIGN_WSIZE;
+    // vector length, or columns and rows of a matrix; m is 0 for vectors
+    std::uint64_t n = 0;
+    std::uint64_t m = 0;
+    // time of every repetition in ms
+    std::vector<double> times;
+    // bytes read and written by the routine
+    std::uint64_t bytes = 0;
+    // median time in ms of the host-side phases of a repetition, if measured
+    std::optional<phase_times> phases;
+};
+
+struct time_stats {
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double max = 0;
+    double stddev = 0;
+    // nearest-rank percentiles
+    double p90 = 0;
+    double p99 = 0;
+};
+
+static inline time_stats get_stats(std::vector<double> times) {
+    time_stats stats;
+    if (times.empty()) {
+        return stats;
     }
 
-    std::println("writing results to {}", result_file.c_str());
-    std::println(result_stream, "{};{};{}", name, size, time);
-    result_stream.close();
+    std::sort(times.begin(), times.end());
+    const std::size_t mid = times.size() / 2;
+    stats.min = times.front();
+    stats.max = times.back();
+    stats.median = times.size() % 2 ? times[mid]
+                                    : (times[mid - 1] + times[mid]) / 2;
+    const auto percentile = [&times](double p) {
+        const auto rank = static_cast<std::size_t>(
+            std::ceil(p / 100 * times.size()));
+        return times[std::max<std::size_t>(rank, 1) - 1];
+    };
+    stats.p90 = percentile(90);
+    stats.p99 = percentile(99);
+    for (double time : times) {
+        stats.mean += time;
+    }
+    stats.mean /= times.size();
+    for (double time : times) {
+        stats.stddev += (time - stats.mean) * (time - stats.mean);
+    }
+    stats.stddev = std::sqrt(stats.stddev / times.size());
+    return stats;
 }
 
-static inline void write_result_sum(std::string &name, std::uint64_t size,
-                                    double time) {
-    fs::path result_file = get_bench_dir() / "results/sum.csv";
-    write_results(result_file, name, size, time);
+// First line of the output of a command, empty if it fails
+static inline std::string run_command(const std::string &command) {
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        return "";
+    }
+
+    std::string output;
+    char buffer[256];
+    while (std::fgets(buffer, sizeof(buffer), pipe)) {
+        output += buffer;
+    }
+    if (pclose(pipe) != 0) {
+        return "";
+    }
+    return output.substr(0, output.find('\n'));
 }
 
-static inline void write_result_axpy(std::string &name, std::uint64_t size,
-                                     double time) {
-    fs::path result_file = get_bench_dir() / "results/single.csv";
-    write_results(result_file, name, size, time);
+static inline std::string json_string(const std::string &value) {
+    std::string escaped = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += std::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped + "\"";
 }
 
-static inline void write_result_gemv(std::string &name, std::uint64_t size,
-                                     double time) {
-    fs::path result_file = get_bench_dir() / "results/single.csv";
-    write_results(result_file, name, size, time);
+static inline std::string json_number(double value) {
+    return std::isfinite(value) ? std::format("{}", value) : "null";
 }
 
-static inline void write_result_axpydot(std::string &name, std::uint64_t size,
-                                        double time) {
-    fs::path result_file = get_bench_dir() / "results/axpydot.csv";
-    write_results(result_file, name, size, time);
+static inline void write_result(const result &r,
+                                const fs::path &result_file =
+                                    get_bench_dir() / "results/results.jsonl") {
+    const time_stats stats = get_stats(r.times);
+    // bytes per ns is GB/s
+    const double gbps = stats.median > 0 ? r.bytes / (stats.median * 1e6) : 0;
+
+    const fs::path design = AIEBLAS_DESIGN_JSON;
+    const std::optional<std::uint64_t> hash =
+        design.empty() ? std::nullopt : fnv1a_file(design);
+    const std::string design_hash = hash ? fnv1a_hex(*hash) : "";
+
+    // The host and checkout do not change while a benchmark runs
+    static const std::string hostname = [] {
+        char name[256] = "";
+        gethostname(name, sizeof(name) - 1);
+        return std::string(name);
+    }();
+#if defined(__GNUC__) && !defined(__clang__)
+    static const std::string compiler = "GCC " __VERSION__;
+#elif defined(__VERSION__)
+    static const std::string compiler = __VERSION__;
+#else
+    static const std::string compiler = "";
+#endif
+
+    static const std::string git_dir = "git -C '" +
+                                       get_bench_dir().string() + "' ";
+    static const std::string commit = run_command(git_dir + "rev-parse HEAD "
+                                                  "2>/dev/null");
+    static const bool dirty = !run_command(git_dir + "status --porcelain "
+                                           "--untracked-files=no "
+                                           "2>/dev/null").empty();
+
+    char timestamp[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ",
+                  std::gmtime(&now));
+
+    std::string times = "[";
+    for (std::size_t i = 0; i < r.times.size(); ++i) {
+        times += (i ? "," : "") + json_number(r.times[i]);
+    }
+    times += "]";
+
+    std::string phases;
+    if (r.phases) {
+        phases = std::format(",\"breakdown_ms\":{{\"alloc\":{},"
+                             "\"sync_in\":{},\"run\":{},\"sync_out\":{}}}",
+                             json_number(r.phases->alloc),
+                             json_number(r.phases->sync_in),
+                             json_number(r.phases->run),
+                             json_number(r.phases->sync_out));
+    }
+
+    std::ofstream result_stream(result_file.c_str(), std::ios::app);
+    std::println("writing results to {}", result_file.c_str());
+    std::println(result_stream,
+                 "{{\"timestamp\":{},\"routine\":{},"
+                 "\"design\":{{\"file\":{},\"hash\":{}}},"
+                 "\"dtype\":{},\"vsize\":{},\"wsize\":{},\"n\":{},\"m\":{},"
+                 "\"repetitions\":{},\"times_ms\":{},"
+                 "\"stats_ms\":{{\"min\":{},\"median\":{},\"mean\":{},"
+                 "\"max\":{},\"stddev\":{},\"p90\":{},\"p99\":{}}}{},"
+                 "\"bytes\":{},\"bandwidth_gbps\":{},"
+                 "\"host\":{{\"name\":{},\"compiler\":{},\"backend\":{}}},"
+                 "\"git\":{{\"commit\":{},\"dirty\":{}}}}}",
+                 json_string(timestamp), json_string(r.routine),
+                 json_string(design.string()), json_string(design_hash),
+                 json_string(r.dtype), r.vsize, r.wsize, r.n, r.m,
+                 r.times.size(), times, json_number(stats.min),
+                 json_number(stats.median), json_number(stats.mean),
+                 json_number(stats.max), json_number(stats.stddev),
+                 json_number(stats.p90), json_number(stats.p99), phases,
+                 r.bytes,
+                 json_number(gbps), json_string(hostname),
+                 json_string(compiler), json_string(get_backend()),
+                 json_string(commit), dirty);
+    result_stream.close();
 }
 }; // namespace util
@@ -1,3 +1,4 @@
+#include <array>
 #include <cblas.h>
 #include <chrono>
 #include <cstdint>
@@ -5,10 +6,12 @@
 #include <filesystem>
 #include <random>
 #include <thread>
+#include <vector>
 #include <xrt/xrt_bo.h>
 #include <xrt/xrt_kernel.h>
 #include <xrt/xrt_uuid.h>
 
+#include "chunked.hpp"
 #include "cxx_compat.hpp"
 #include "timer.hpp"
 
@@ -19,9 +22,15 @@ using milliseconds = std::chrono::duration<double, std::milli>;
 using microseconds = std::chrono::duration<double, std::micro>;
 
 namespace {
+// Elements in a window of the kernel, window_size * 8 / 32 of aieblas.json.
+// The movers pad every run to whole windows, so only the last chunk of a
+// vector may hold a partial window.
+constexpr std::uint64_t window_elements = 64;
+
 struct arguments {
     fs::path xclbin;
     std::uint64_t size;
+    std::uint64_t chunk;
 };
 
 inline void error(const std::string_view message) {
@@ -46,6 +55,8 @@ struct arguments parse_args(int argc, const char* const* argv) {
              cxxopts::value<std::string>())
             ("s,size", "Size of m",
              cxxopts::value<std::uint64_t>())
+            ("c,chunk", "Move the vectors in chunks of this many elements, "
+             "a multiple of 64", cxxopts::value<std::uint64_t>())
             ("h,help", "Print usage");
 
         options.positional_help("<xclbin>");
@@ -68,7 +79,22 @@ struct arguments parse_args(int argc, const char* const* argv) {
             size = results["size"].as<std::uint64_t>();
         }
 
-        args = {fs::path(results["xclbin"].as<std::string>()), size};
+        std::uint64_t chunk = 0;
+        if (results.count("chunk")) {
+            chunk = results["chunk"].as<std::uint64_t>();
+        }
+        if (chunk % window_elements != 0) {
+            error(std::format("chunk size {} is not a multiple of the window "
+                              "of {} elements", chunk, window_elements));
+        }
+#ifdef AIEBLAS_MOCK
+        // The mock executes every run of the movers as a whole vector
+        if (chunk != 0) {
+            error("chunked runs are not supported by the mock XRT backend");
+        }
+#endif
+
+        args = {fs::path(results["xclbin"].as<std::string>()), size, chunk};
 
         if (!fs::exists(args.xclbin)) {
             error(std::format("File '{}' does not exist",
@@ -99,6 +125,95 @@ constexpr void initialize_data(Number *x, std::uint64_t size) {
         x[i] = dis(gen);
     }
 }
+
+/*
+ * Compute the sum of absolute values of vectors larger than device memory. The
+ * vectors are moved in chunks through two sets of fixed size buffers, while
+ * the AIE kernel accumulates the result of all chunks.
+ */
+int run_chunked(xrt::device &device, xrt::kernel &mm2s, xrt::kernel &s2mm,
+                const struct arguments &args) {
+    Timer timer;
+
+    std::println("Allocating memory...");
+    ChunkBuffers<float> buffers_x{device, mm2s.group_id(0), args.chunk};
+    xrt::bo bo_result{device, sizeof(float), s2mm.group_id(0)};
+    std::vector<float> x(args.size);
+    std::println("Memory allocated!");
+
+    std::println("Initializing memory...");
+    initialize_data(x.data(), args.size);
+    std::println("Memory initialized!");
+
+    std::println("Creating runners...");
+    std::array<xrt::run, 2> runs_mm2s{xrt::run(mm2s), xrt::run(mm2s)};
+    xrt::run run_s2mm(s2mm);
+    run_s2mm.set_arg(0, bo_result);
+    std::println("Runners created!");
+
+    std::println("Starting PL kernels...");
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    const std::uint64_t chunks = buffers_x.chunks(args.size);
+    timer.time_point("start");
+    run_s2mm.start();
+    for (std::uint64_t chunk = 0; chunk < chunks; ++chunk) {
+        xrt::run &run = runs_mm2s[chunk % runs_mm2s.size()];
+        // The run and its buffers were last used two chunks ago
+        if (chunk >= runs_mm2s.size()) {
+            run.wait();
+        }
+
+        // Only the first chunk sends the size of the whole vector
+        run.set_arg(0, buffers_x.upload(x.data(), args.size, chunk));
+        run.set_arg(1, buffers_x.length(args.size, chunk));
+        run.set_arg(2, args.size);
+        run.set_arg(3, chunk != 0);
+        run.start();
+    }
+
+    for (std::uint64_t chunk = 0; chunk < std::min<std::uint64_t>(chunks, 2);
+         ++chunk) {
+        runs_mm2s[chunk].wait();
+    }
+    const auto state_s2mm = run_s2mm.wait(std::chrono::seconds(5));
+    timer.time_point("end");
+
+    if (state_s2mm == ERT_CMD_STATE_TIMEOUT) {
+        std::println("Warning: s2mm timed out!");
+    }
+
+    double exec_time = timer.time<milliseconds>("start", "end").count();
+
+    std::println("Execution finished in {:.2f} ms ({} chunks)!", exec_time,
+                 chunks);
+
+    float result = 0;
+    for (std::uint64_t chunk = 0; chunk < chunks; ++chunk) {
+        const std::uint64_t offset = chunk * args.chunk;
+        result += cblas_sasum(buffers_x.length(args.size, chunk),
+                              x.data() + offset, 1);
+    }
+
+    std::println("Checking result...");
+    bo_result.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    float *result_device = bo_result.map<float *>();
+
+    unsigned errors = 0;
+    if (std::fabs(*result_device - result) >= std::fabs(result) * 1e-6) {
+        std::println("FAIL! ({} != {})", *result_device, result);
+        errors += 1;
+    }
+
+    if (errors == 0) {
+        std::println("OK!");
+    } else {
+        std::println("{} failures!", errors);
+    }
+
+    return errors == 0 ? 0 : 1;
+}
 } // namespace
 
 int main(int argc, char *argv[]) {
@@ -115,6 +230,10 @@ int main(int argc, char *argv[]) {
     xrt::kernel s2mm = xrt::kernel(device, uuid, "asum_s2mm");
     std::println("Kernels loaded!");
 
+    if (args.chunk != 0) {
+        return run_chunked(device, mm2s, s2mm, args);
+    }
+
     std::println("Allocating memory...");
     // get memory bank groups for device buffers
     xrtMemoryGroup bank_x = mm2s.group_id(0);
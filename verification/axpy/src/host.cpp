@@ -9,6 +9,7 @@
 #include <xrt/xrt_kernel.h>
 #include <xrt/xrt_uuid.h>
 
+#include "aieblas.hpp"
 #include "cxx_compat.hpp"
 #include "timer.hpp"
 
@@ -114,20 +115,13 @@ int main(int argc, char *argv[]) {
     std::println("XCLBIN loaded!");
 
     std::println("Loading kernels...");
-    xrt::kernel mm2s = xrt::kernel(device, uuid, "axpy_mm2s");
-    xrt::kernel s2mm = xrt::kernel(device, uuid, "axpy_s2mm");
+    aieblas::design design{device, uuid};
     std::println("Kernels loaded!");
 
     std::println("Allocating memory...");
-    // get memory bank groups for device buffers
-    xrtMemoryGroup bank_x = mm2s.group_id(1);
-    xrtMemoryGroup bank_y = mm2s.group_id(2);
-    xrtMemoryGroup bank_result = s2mm.group_id(0);
-
-    // Create device buffers
-    xrt::bo bo_x{device, args.size * sizeof(float), bank_x};
-    xrt::bo bo_y{device, args.size * sizeof(float), bank_y};
-    xrt::bo bo_result{device, args.size * sizeof(float), bank_result};
+    xrt::bo bo_x = design.alloc_axpy_x(args.size);
+    xrt::bo bo_y = design.alloc_axpy_y(args.size);
+    xrt::bo bo_result = design.alloc_axpy_out(args.size);
     std::println("Memory allocated!");
 
     std::println("Initializing memory...");
@@ -142,35 +136,17 @@ int main(int argc, char *argv[]) {
     bo_y.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     std::println("Memory initialized!");
 
-    std::println("Creating runners...");
-    xrt::run run_mm2s(mm2s);
-    run_mm2s.set_arg(0, args.size);
-    run_mm2s.set_arg(1, bo_x);
-    run_mm2s.set_arg(2, bo_y);
-    run_mm2s.set_arg(3, alpha);
-
-    xrt::run run_s2mm(s2mm);
-    run_s2mm.set_arg(0, bo_result);
-    run_s2mm.set_arg(1, args.size);
-    std::println("Runners created!");
-
     std::println("Starting PL kernels...");
 
     std::this_thread::sleep_for(std::chrono::seconds(1));
 
     timer.time_point("start");
-    run_mm2s.start();
-    run_s2mm.start();
-
-    const auto state_mm2s = run_mm2s.wait(std::chrono::seconds(5));
-    const auto state_s2mm = run_s2mm.wait(std::chrono::seconds(5));
+    design.start_axpy(alpha, bo_x, bo_y, bo_result, args.size);
+    const bool finished = design.wait(std::chrono::seconds(5));
     timer.time_point("end");
 
-    if (state_mm2s == ERT_CMD_STATE_TIMEOUT) {
-        std::println("Warning: mm2s timed out!");
-    }
-    if (state_s2mm == ERT_CMD_STATE_TIMEOUT) {
-        std::println("Warning: s2mm timed out!");
+    if (!finished) {
+        std::println("Warning: axpy timed out!");
     }
 
     double exec_time = timer.time<milliseconds>("start", "end").count();
@@ -0,0 +1 @@
+../../../aieblas/include/aieblas/detail/util/chunked.hpp
\ No newline at end of file